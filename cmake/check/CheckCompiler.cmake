@@ -38,8 +38,34 @@ CHECK_CXX_COMPILER_FLAG("-std=c++0x" CXX_COMPILER_SUPPORTS_CXX0X)
 CHECK_CXX_COMPILER_FLAG("-std=c++11" CXX_COMPILER_SUPPORTS_CXX11)
 CHECK_CXX_COMPILER_FLAG("-std=c++14" CXX_COMPILER_SUPPORTS_CXX14)
 CHECK_CXX_COMPILER_FLAG("-std=c++17" CXX_COMPILER_SUPPORTS_CXX17)
+CHECK_CXX_COMPILER_FLAG("-std=c++20" CXX_COMPILER_SUPPORTS_CXX20)
+CHECK_CXX_COMPILER_FLAG("-fcoroutines" CXX_COMPILER_SUPPORTS_COROUTINES)
 
-IF(CXX_COMPILER_SUPPORTS_CXX17)
+
+#
+# 协程支持需要C++20, 默认关闭
+#
+OPTION(TINY_CORE_COROUTINE "Build with C++20 coroutine support" OFF)
+
+IF(TINY_CORE_COROUTINE AND NOT CXX_COMPILER_SUPPORTS_CXX20)
+
+	MESSAGE(WARNING "The CXX compiler ${CMAKE_CXX_COMPILER} does not support C++20, coroutine support is disabled.")
+
+ENDIF()
+
+IF(TINY_CORE_COROUTINE AND CXX_COMPILER_SUPPORTS_CXX20)
+
+	SET(CMAKE_CXX_FLAGS "-std=c++20")
+
+	IF(CXX_COMPILER_SUPPORTS_COROUTINES)
+
+		SET(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -fcoroutines")
+
+	ENDIF()
+
+	ADD_DEFINITIONS(-DTINY_CORE_COROUTINE)
+
+ELSEIF(CXX_COMPILER_SUPPORTS_CXX17)
 
 	SET(CMAKE_CXX_FLAGS "-std=c++17")
 
@@ -0,0 +1,1594 @@
+#ifndef __EXAMPLE__CONTAINER__EXAMPLE__H__
+#define __EXAMPLE__CONTAINER__EXAMPLE__H__
+
+
+#include <tinyCore/tinyCore.h>
+
+
+using namespace tinyCore::container;
+
+
+class Example
+{
+public:
+	static void Test(const std::size_t count = 1000000, const std::size_t threadCount = 4)
+	{
+		Deque(count, threadCount);
+		Chain(count);
+		Shared(count, threadCount);
+		Map(count, threadCount);
+		Cache(count, threadCount);
+		Timer(count, threadCount);
+		Ring(count);
+		SkipList(count, threadCount);
+		Filter(count);
+		Spill(count);
+	}
+
+	static void Deque(const std::size_t count = 1000000, const std::size_t threadCount = 4)
+	{
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Work stealing deque, 1 owner " << threadCount << " thieves, " << count << " iterations" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		// 初始容量很小, 迫使压测过程中反复扩容
+		WorkStealingDeque<std::size_t> deque(2);
+
+		std::vector<std::thread> threads;
+
+		std::atomic<bool> isStop{ false };
+
+		std::atomic<std::size_t> popCount{ 0 };
+		std::atomic<std::size_t> stealCount{ 0 };
+
+		std::unique_ptr<std::atomic<uint8_t>[]> seen(new std::atomic<uint8_t>[count]);
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			seen[i].store(0, std::memory_order_relaxed);
+		}
+
+		////////////////////////////////////////////////////////////////////////////////////////////////////
+
+		auto start = TINY_TIME_POINT();
+
+		for (std::size_t i = 0; i < threadCount; ++i)
+		{
+			threads.emplace_back
+			(
+				[&]()
+				{
+					std::size_t value;
+
+					while (!isStop.load(std::memory_order_acquire) || !deque.Empty())
+					{
+						if (deque.Steal(value))
+						{
+							seen[value].fetch_add(1, std::memory_order_relaxed);
+
+							stealCount.fetch_add(1, std::memory_order_relaxed);
+						}
+					}
+				}
+			);
+		}
+
+		std::size_t value;
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			deque.Push(i);
+
+			// 拥有者每压入三个弹出一个, 同时覆盖底部竞争
+			if (i % 3 == 0 && deque.Pop(value))
+			{
+				seen[value].fetch_add(1, std::memory_order_relaxed);
+
+				popCount.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		while (deque.Pop(value))
+		{
+			seen[value].fetch_add(1, std::memory_order_relaxed);
+
+			popCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		isStop.store(true, std::memory_order_release);
+
+		for (auto &t : threads)
+		{
+			t.join();
+		}
+
+		auto stop = TINY_TIME_POINT();
+
+		////////////////////////////////////////////////////////////////////////////////////////////////////
+
+		std::size_t lost = 0;
+		std::size_t duplicate = 0;
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			auto times = seen[i].load(std::memory_order_relaxed);
+
+			if (times == 0)
+			{
+				++lost;
+			}
+			else if (times > 1)
+			{
+				++duplicate;
+			}
+		}
+
+		std::cout << "pop       : " << TINY_STR_TO_LOCAL(popCount.load()) << std::endl;
+		std::cout << "steal     : " << TINY_STR_TO_LOCAL(stealCount.load()) << std::endl;
+		std::cout << "lost      : " << TINY_STR_TO_LOCAL(lost) << std::endl;
+		std::cout << "duplicate : " << TINY_STR_TO_LOCAL(duplicate) << std::endl;
+		std::cout << "capacity  : " << TINY_STR_TO_LOCAL(deque.Capacity()) << std::endl;
+		std::cout << "result    : " << ((lost == 0 && duplicate == 0) ? "ok" : "failed") << std::endl;
+		std::cout << "rate      : " << TINY_STR_TO_LOCAL(count / TINY_TIME_DOUBLE(stop - start)) << "/sec" << std::endl << std::endl;
+	}
+
+	static void Chain(const std::size_t count = 1000000)
+	{
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Chain buffer against string and message, " << count << " random operations" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		// 内存块很小, 几乎每次操作都跨越块边界
+		ChainBlockPool pool(64, 256);
+
+		ChainBuffer chain(pool);
+
+		std::string expect;
+
+		std::mt19937_64 engine(count);
+
+		std::size_t error = 0;
+		std::size_t maxBlock = 0;
+
+		auto random = [&engine](std::size_t size)
+		{
+			std::string data(size, '\0');
+
+			for (auto &iter : data)
+			{
+				iter = static_cast<char>(engine());
+			}
+
+			return data;
+		};
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			switch (engine() % 6)
+			{
+				case 0:
+				{
+					auto data = random(engine() % 300);
+
+					chain.Write(data);
+
+					expect += data;
+
+					break;
+				}
+
+				case 1:
+				{
+					auto data = random(engine() % 150);
+
+					chain.Prepend(data);
+
+					expect.insert(0, data);
+
+					break;
+				}
+
+				case 2:
+				{
+					// 偶尔拼接自身
+					if (i % 7 == 0)
+					{
+						chain.Append(chain);
+
+						expect += expect;
+
+						break;
+					}
+
+					auto data = random(engine() % 300);
+
+					ChainBuffer other(pool);
+
+					other.Write(data);
+
+					if (i % 2 == 0)
+					{
+						chain.Append(other);
+					}
+					else
+					{
+						chain.Append(std::move(other));
+					}
+
+					expect += data;
+
+					break;
+				}
+
+				case 3:
+				{
+					std::size_t offset = engine() % (expect.size() + 1);
+					std::size_t length = engine() % (expect.size() - offset + 1);
+
+					auto slice = chain.Slice(offset, length);
+
+					error += slice.ToString() == expect.substr(offset, length) ? 0 : 1;
+
+					break;
+				}
+
+				case 4:
+				{
+					std::size_t size = engine() % (expect.size() / 2 + 1);
+
+					auto head = chain.Split(size);
+
+					error += head.ToString() == expect.substr(0, size) ? 0 : 1;
+
+					expect.erase(0, size);
+
+					break;
+				}
+
+				default:
+				{
+					std::string joined;
+
+					for (auto &iter : chain.ToIovec())
+					{
+						joined.append(static_cast<const char *>(iter.iov_base), iter.iov_len);
+					}
+
+					// 目标消息已有数据, 且剩余空间小于链的大小
+					Message message(16);
+
+					message.Write("head");
+
+					chain.CopyTo(message);
+
+					error += joined == expect ? 0 : 1;
+					error += std::string(reinterpret_cast<const char *>(message.ReadPointer()), message.UnReadSize()) == "head" + expect ? 0 : 1;
+
+					break;
+				}
+			}
+
+			error += chain.Size() == expect.size() ? 0 : 1;
+
+			maxBlock = std::max(maxBlock, chain.BlockCount());
+
+			// 控制总大小, 按读取消费
+			if (expect.size() > 16 * TINY_KB)
+			{
+				std::string data(expect.size() / 2, '\0');
+
+				chain.Read(reinterpret_cast<Byte *>(&data[0]), data.size());
+
+				error += expect.compare(0, data.size(), data) == 0 ? 0 : 1;
+
+				expect.erase(0, data.size());
+			}
+		}
+
+		error += chain.ToString() == expect ? 0 : 1;
+
+		std::cout << "size      : " << TINY_STR_TO_LOCAL(chain.Size()) << std::endl;
+		std::cout << "max block : " << TINY_STR_TO_LOCAL(maxBlock) << std::endl;
+		std::cout << "free      : " << TINY_STR_TO_LOCAL(pool.FreeCount()) << std::endl;
+		std::cout << "error     : " << TINY_STR_TO_LOCAL(error) << std::endl;
+		std::cout << "result    : " << (error == 0 ? "ok" : "failed") << std::endl << std::endl;
+	}
+
+	static void Shared(const std::size_t count = 1000000, const std::size_t threadCount = 4)
+	{
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Shared message fan-out vs copy, " << threadCount << " threads, " << count << " iterations" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		std::size_t error = 0;
+
+		error += CheckShared<SharedMessageSync>();
+		error += CheckShared<SharedMessageAsync>();
+
+		// 多线程同时拷贝, 切片, 释放同一份存储
+		SharedMessageAsync origin(std::string(4 * TINY_KB, 's'));
+
+		std::vector<std::thread> threads;
+
+		std::atomic<std::size_t> mismatch{ 0 };
+
+		for (std::size_t i = 0; i < threadCount; ++i)
+		{
+			threads.emplace_back
+			(
+				[&, i]()
+				{
+					for (std::size_t j = 0; j < count / threadCount; ++j)
+					{
+						SharedMessageAsync copy(origin);
+
+						auto slice = copy.Slice(j % 1024, 1024 + i);
+
+						if (slice.Size() != 1024 + i || slice.Data() != origin.Data() + j % 1024)
+						{
+							mismatch.fetch_add(1, std::memory_order_relaxed);
+						}
+					}
+				}
+			);
+		}
+
+		for (auto &t : threads)
+		{
+			t.join();
+		}
+
+		error += mismatch.load();
+		error += origin.UseCount() == 1 ? 0 : 1;
+
+		std::cout << "refcount  : " << (mismatch.load() == 0 && origin.UseCount() == 1 ? "ok" : "failed") << std::endl;
+
+		// 一份数据分发给多个订阅者, 拷贝每次都要分配并复制整份数据
+		const std::size_t fanout = 8;
+
+		for (std::size_t size : { 64, 1024, 16 * 1024 })
+		{
+			// 数据越大条数越少, 每轮复制的总字节数相同
+			const std::size_t messages = std::max<std::size_t>(count * 64 / size / 10, 1);
+
+			std::vector<ByteVector> copyInbox(fanout);
+			std::vector<SharedMessageAsync> sharedInbox(fanout);
+
+			auto copyStart = TINY_TIME_STEADY_POINT();
+
+			for (std::size_t i = 0; i < messages; ++i)
+			{
+				Message message(size);
+
+				message.WriteCompleted(size);
+
+				for (auto &iter : copyInbox)
+				{
+					iter = ByteVector(message.ReadPointer(), message.ReadPointer() + message.UnReadSize());
+				}
+			}
+
+			auto sharedStart = TINY_TIME_STEADY_POINT();
+
+			for (std::size_t i = 0; i < messages; ++i)
+			{
+				Message message(size);
+
+				message.WriteCompleted(size);
+
+				SharedMessageAsync shared(std::move(message));
+
+				for (auto &iter : sharedInbox)
+				{
+					iter = shared;
+				}
+			}
+
+			auto stop = TINY_TIME_STEADY_POINT();
+
+			error += sharedInbox.front().UseCount() == fanout ? 0 : 1;
+
+			std::cout << "fan-out " << fanout << " x " << size << " bytes"
+					  << " : copy " << TINY_STR_TO_LOCAL(messages / TINY_TIME_DOUBLE(sharedStart - copyStart)) << "/sec"
+					  << ", shared " << TINY_STR_TO_LOCAL(messages / TINY_TIME_DOUBLE(stop - sharedStart)) << "/sec" << std::endl;
+		}
+
+		std::cout << "result    : " << (error == 0 ? "ok" : "failed") << std::endl << std::endl;
+	}
+
+	static void Map(const std::size_t count = 1000000, const std::size_t threadCount = 4)
+	{
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Concurrent hash map vs mutex unordered_map, up to " << threadCount << " threads, " << count << " iterations" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		const std::size_t keyCount = 100000;
+
+		for (std::size_t readPercent : { 100, 90, 50, 10 })
+		{
+			for (std::size_t threads = 1; threads <= threadCount; threads *= 2)
+			{
+				ConcurrentHashMap<std::size_t, std::size_t> concurrent;
+
+				std::mutex lock;
+				std::unordered_map<std::size_t, std::size_t, HashFunc<std::size_t>, CompareFunc<std::size_t>> locked;
+
+				for (std::size_t i = 0; i < keyCount; i += 2)
+				{
+					concurrent.Insert(i, i);
+					locked.emplace(i, i);
+				}
+
+				auto concurrentRate = TestMap
+				(
+					count, threads, keyCount, readPercent,
+
+					[&](std::size_t key, std::size_t & value)
+					{
+						return concurrent.Find(key, value);
+					},
+
+					[&](std::size_t key)
+					{
+						if (!concurrent.Erase(key))
+						{
+							concurrent.Upsert(key, key);
+						}
+					}
+				);
+
+				auto lockedRate = TestMap
+				(
+					count, threads, keyCount, readPercent,
+
+					[&](std::size_t key, std::size_t & value)
+					{
+						std::lock_guard<std::mutex> guard(lock);
+
+						auto iter = locked.find(key);
+
+						if (iter == locked.end())
+						{
+							return false;
+						}
+
+						value = iter->second;
+
+						return true;
+					},
+
+					[&](std::size_t key)
+					{
+						std::lock_guard<std::mutex> guard(lock);
+
+						if (locked.erase(key) == 0)
+						{
+							locked[key] = key;
+						}
+					}
+				);
+
+				std::cout << "read " << readPercent << "% threads " << threads
+						  << " : concurrent " << TINY_STR_TO_LOCAL(concurrentRate) << "/sec"
+						  << ", mutex " << TINY_STR_TO_LOCAL(lockedRate) << "/sec" << std::endl;
+			}
+		}
+
+		std::cout << std::endl;
+	}
+
+	static void Cache(const std::size_t count = 1000000, const std::size_t threadCount = 4)
+	{
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "W-TinyLFU cache vs LRU, zipf keys, " << threadCount << " threads, " << count << " iterations" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		// 容量小于默认分片数, 分片数自动减少, 刚写入的数据总能读到, 总量不超过容量
+		{
+			std::size_t error = 0;
+
+			for (std::size_t capacity : { 1, 2, 3, 5, 8, 15 })
+			{
+				ConcurrentCache<std::size_t, std::size_t> small(capacity);
+
+				for (std::size_t i = 0; i < 1000; ++i)
+				{
+					std::size_t value = 0;
+
+					small.Put(i, i);
+
+					error += (small.Get(i, value) && value == i && small.Size() <= capacity) ? 0 : 1;
+				}
+			}
+
+			std::cout << "small capacity : " << (error == 0 ? "ok" : "failed") << std::endl << std::endl;
+		}
+
+		const std::size_t keyCount = 1000000;
+
+		for (double skew : { 0.8, 0.99, 1.2 })
+		{
+			auto keys = ZipfKeys(count, keyCount, skew);
+
+			for (std::size_t capacity : { keyCount / 1000, keyCount / 100, keyCount / 10 })
+			{
+				ConcurrentCache<std::size_t, std::size_t> cache(capacity);
+
+				LRUCache lru(capacity);
+
+				for (auto &key : keys)
+				{
+					std::size_t value;
+
+					if (!cache.Get(key, value))
+					{
+						cache.Put(key, key);
+					}
+
+					if (!lru.Get(key))
+					{
+						lru.Put(key);
+					}
+				}
+
+				std::cout << "zipf " << skew << " capacity " << TINY_STR_TO_LOCAL(capacity)
+						  << " : tinylfu hit " << cache.Statistics().HitRatio() * 100 << "%"
+						  << ", lru hit " << lru.HitRatio() * 100 << "%" << std::endl;
+			}
+		}
+
+		std::cout << std::endl;
+
+		auto keys = ZipfKeys(count, keyCount, 0.99);
+
+		ConcurrentCache<std::size_t, std::size_t> cache(keyCount / 100);
+
+		cache.SetRecordLatency(true);
+
+		std::vector<std::thread> threads;
+
+		auto start = TINY_TIME_POINT();
+
+		for (std::size_t i = 0; i < threadCount; ++i)
+		{
+			threads.emplace_back
+			(
+				[&, i]()
+				{
+					std::size_t value;
+
+					for (std::size_t j = i; j < keys.size(); j += threadCount)
+					{
+						if (!cache.Get(keys[j], value))
+						{
+							cache.Put(keys[j], keys[j]);
+						}
+					}
+				}
+			);
+		}
+
+		for (auto &t : threads)
+		{
+			t.join();
+		}
+
+		auto stop = TINY_TIME_POINT();
+
+		auto statistics = cache.Statistics();
+
+		std::cout << "hit      : " << statistics.HitRatio() * 100 << "%" << std::endl;
+		std::cout << "evict    : " << TINY_STR_TO_LOCAL(statistics.evict) << std::endl;
+		std::cout << "avg get  : " << statistics.AvgGetNanoseconds() << " ns" << std::endl;
+		std::cout << "rate     : " << TINY_STR_TO_LOCAL(keys.size() / TINY_TIME_DOUBLE(stop - start)) << "/sec" << std::endl << std::endl;
+	}
+
+	static void Timer(const std::size_t count = 1000000, const std::size_t threadCount = 4)
+	{
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Timer wheel vs priority queue, " << count << " live timers" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		// 延迟均匀分布在1ms到10分钟之间
+		const uint64_t maxDelay = 10 * 60 * 1000;
+
+		std::vector<uint64_t> delays(count);
+
+		std::mt19937_64 engine(count);
+
+		for (auto &delay : delays)
+		{
+			delay = 1 + engine() % maxDelay;
+		}
+
+		std::size_t fired = 0;
+
+		{
+			TimerWheel<tinyCore::lock::NullMutex, TimerTask> wheel(std::chrono::milliseconds(1), count);
+
+			std::vector<TimerWheel<tinyCore::lock::NullMutex, TimerTask>::TimerID> ids(count);
+
+			auto start = TINY_TIME_POINT();
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				ids[i] = wheel.Add(std::chrono::milliseconds(delays[i]), TimerTask{ &fired });
+			}
+
+			auto added = TINY_TIME_POINT();
+
+			// 取消十分之一, 模拟请求提前完成
+			for (std::size_t i = 0; i < count; i += 10)
+			{
+				wheel.Cancel(ids[i]);
+			}
+
+			auto cancelled = TINY_TIME_POINT();
+
+			std::vector<TimerTask> expired;
+
+			for (uint64_t tick = 0; tick < maxDelay; tick += 10)
+			{
+				wheel.AdvanceTicks(10, expired);
+
+				for (auto &iter : expired)
+				{
+					iter();
+				}
+
+				expired.clear();
+			}
+
+			auto stop = TINY_TIME_POINT();
+
+			std::cout << "wheel add    : " << TINY_STR_TO_LOCAL(count / TINY_TIME_DOUBLE(added - start)) << "/sec" << std::endl;
+			std::cout << "wheel cancel : " << TINY_STR_TO_LOCAL((count / 10) / TINY_TIME_DOUBLE(cancelled - added)) << "/sec" << std::endl;
+			std::cout << "wheel expire : " << TINY_STR_TO_LOCAL(fired / TINY_TIME_DOUBLE(stop - cancelled)) << "/sec, fired " << TINY_STR_TO_LOCAL(fired) << std::endl;
+		}
+
+		fired = 0;
+
+		{
+			// 堆不支持取消, 使用标记惰性删除
+			using Entry = std::pair<uint64_t, std::size_t>;
+
+			std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+
+			std::vector<uint8_t> isCancelled(count, 0);
+
+			auto start = TINY_TIME_POINT();
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				heap.emplace(delays[i], i);
+			}
+
+			auto added = TINY_TIME_POINT();
+
+			for (std::size_t i = 0; i < count; i += 10)
+			{
+				isCancelled[i] = 1;
+			}
+
+			for (uint64_t tick = 0; tick < maxDelay; tick += 10)
+			{
+				while (!heap.empty() && heap.top().first <= tick + 10)
+				{
+					if (!isCancelled[heap.top().second])
+					{
+						++fired;
+					}
+
+					heap.pop();
+				}
+			}
+
+			auto stop = TINY_TIME_POINT();
+
+			std::cout << "heap add     : " << TINY_STR_TO_LOCAL(count / TINY_TIME_DOUBLE(added - start)) << "/sec" << std::endl;
+			std::cout << "heap expire  : " << TINY_STR_TO_LOCAL(fired / TINY_TIME_DOUBLE(stop - added)) << "/sec, fired " << TINY_STR_TO_LOCAL(fired)
+					  << " (cancelled entries stay in the heap until popped)" << std::endl;
+		}
+
+		{
+			// 实时推进, 到期回调分批交给线程池
+			tinyCore::pool::ThreadPool pool;
+
+			pool.Launch(threadCount);
+
+			TimerWheelAsync wheel(std::chrono::milliseconds(1));
+
+			std::atomic<std::size_t> executed{ 0 };
+
+			std::size_t dispatchCount = std::min<std::size_t>(count, 1000000);
+
+			for (std::size_t i = 0; i < dispatchCount; ++i)
+			{
+				wheel.Add(std::chrono::milliseconds(1 + i % 100), [&executed]() { executed.fetch_add(1, std::memory_order_relaxed); });
+			}
+
+			std::size_t dispatched = 0;
+
+			auto start = TINY_TIME_POINT();
+
+			while (dispatched < dispatchCount)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+				dispatched += wheel.Dispatch(pool);
+			}
+
+			while (pool.IsWork())
+			{
+				std::this_thread::yield();
+			}
+
+			auto stop = TINY_TIME_POINT();
+
+			std::cout << "pool dispatch: " << TINY_STR_TO_LOCAL(executed.load()) << " executed in "
+					  << TINY_TIME_DOUBLE(stop - start) * 1000 << " ms" << std::endl << std::endl;
+		}
+	}
+
+	static void Ring(const std::size_t count = 1000000)
+	{
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Mirrored ring buffer vs split copy ring, " << count << " records" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		const std::size_t capacity = 64 * TINY_KB;
+
+		// 变长记录, 头部4字节长度, 大小不整除容量, 经常跨越末尾
+		std::vector<uint32_t> sizes(count);
+
+		std::mt19937_64 engine(count);
+
+		for (auto &size : sizes)
+		{
+			size = static_cast<uint32_t>(16 + engine() % 1000);
+		}
+
+		std::vector<Byte> record(2048, 0x5A);
+
+		std::size_t bytes = 0;
+
+		for (auto &size : sizes)
+		{
+			bytes += size + sizeof(uint32_t);
+		}
+
+		{
+			RingBufferSync ring(capacity);
+
+			uint64_t checksum = 0;
+
+			auto start = TINY_TIME_POINT();
+
+			for (auto &size : sizes)
+			{
+				// 可写区间总是连续, 直接就地构造记录
+				if (ring.UnWriteSize() < size + sizeof(uint32_t))
+				{
+					ConsumeRing(ring, checksum);
+				}
+
+				Byte * pointer = ring.WritePointer();
+
+				memcpy(pointer, &size, sizeof(uint32_t));
+				memcpy(pointer + sizeof(uint32_t), record.data(), size);
+
+				ring.WriteCompleted(size + sizeof(uint32_t));
+			}
+
+			ConsumeRing(ring, checksum);
+
+			auto stop = TINY_TIME_POINT();
+
+			std::cout << "mirror : " << TINY_STR_TO_LOCAL(count / TINY_TIME_DOUBLE(stop - start)) << " records/sec, "
+					  << bytes / TINY_TIME_DOUBLE(stop - start) / TINY_MB << " MB/sec, checksum " << checksum << std::endl;
+		}
+
+		{
+			SplitRing ring(capacity);
+
+			uint64_t checksum = 0;
+
+			std::vector<Byte> temp(2048);
+
+			auto start = TINY_TIME_POINT();
+
+			for (auto &size : sizes)
+			{
+				// 写入需要分两段拷贝, 读取需要先拷出再解析
+				if (ring.Free() < size + sizeof(uint32_t))
+				{
+					ConsumeSplit(ring, temp, checksum);
+				}
+
+				ring.Write(reinterpret_cast<const Byte *>(&size), sizeof(uint32_t));
+				ring.Write(record.data(), size);
+			}
+
+			ConsumeSplit(ring, temp, checksum);
+
+			auto stop = TINY_TIME_POINT();
+
+			std::cout << "split  : " << TINY_STR_TO_LOCAL(count / TINY_TIME_DOUBLE(stop - start)) << " records/sec, "
+					  << bytes / TINY_TIME_DOUBLE(stop - start) / TINY_MB << " MB/sec, checksum " << checksum << std::endl;
+		}
+
+		{
+			// 单生产者单消费者
+			RingBufferAsync ring(capacity);
+
+			uint64_t produced = 0;
+			uint64_t consumed = 0;
+
+			auto start = TINY_TIME_POINT();
+
+			std::thread consumer
+			(
+				[&]()
+				{
+					std::size_t remain = sizes.size();
+
+					while (remain > 0)
+					{
+						uint32_t size = 0;
+
+						if (!ring.Peek(&size, sizeof(uint32_t)) || ring.UnReadSize() < size + sizeof(uint32_t))
+						{
+							std::this_thread::yield();
+
+							continue;
+						}
+
+						consumed += Checksum(ring.ReadPointer() + sizeof(uint32_t), size);
+
+						ring.ReadCompleted(size + sizeof(uint32_t));
+
+						--remain;
+					}
+				}
+			);
+
+			for (auto &size : sizes)
+			{
+				while (ring.UnWriteSize() < size + sizeof(uint32_t))
+				{
+					std::this_thread::yield();
+				}
+
+				Byte * pointer = ring.WritePointer();
+
+				memcpy(pointer, &size, sizeof(uint32_t));
+				memcpy(pointer + sizeof(uint32_t), record.data(), size);
+
+				produced += Checksum(pointer + sizeof(uint32_t), size);
+
+				ring.WriteCompleted(size + sizeof(uint32_t));
+			}
+
+			consumer.join();
+
+			auto stop = TINY_TIME_POINT();
+
+			std::cout << "spsc   : " << TINY_STR_TO_LOCAL(count / TINY_TIME_DOUBLE(stop - start)) << " records/sec, "
+					  << bytes / TINY_TIME_DOUBLE(stop - start) / TINY_MB << " MB/sec, result " << (produced == consumed ? "ok" : "failed") << std::endl << std::endl;
+		}
+	}
+
+	static void SkipList(const std::size_t count = 1000000, const std::size_t threadCount = 4)
+	{
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Concurrent skip list vs mutex map, up to " << threadCount << " threads, " << count << " iterations" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		const std::size_t keyCount = 100000;
+
+		for (std::size_t readPercent : { 100, 90, 50, 10 })
+		{
+			for (std::size_t threads = 1; threads <= threadCount; threads *= 2)
+			{
+				ConcurrentSkipList<std::size_t, std::size_t> skipList;
+
+				std::mutex lock;
+				std::map<std::size_t, std::size_t> locked;
+
+				for (std::size_t i = 0; i < keyCount; i += 2)
+				{
+					skipList.Insert(i, i);
+					locked.emplace(i, i);
+				}
+
+				auto skipListRate = TestMap
+				(
+					count, threads, keyCount, readPercent,
+
+					[&](std::size_t key, std::size_t & value)
+					{
+						return skipList.Find(key, value);
+					},
+
+					[&](std::size_t key)
+					{
+						if (!skipList.Erase(key))
+						{
+							skipList.Insert(key, key);
+						}
+					}
+				);
+
+				auto lockedRate = TestMap
+				(
+					count, threads, keyCount, readPercent,
+
+					[&](std::size_t key, std::size_t & value)
+					{
+						std::lock_guard<std::mutex> guard(lock);
+
+						auto iter = locked.find(key);
+
+						if (iter == locked.end())
+						{
+							return false;
+						}
+
+						value = iter->second;
+
+						return true;
+					},
+
+					[&](std::size_t key)
+					{
+						std::lock_guard<std::mutex> guard(lock);
+
+						if (locked.erase(key) == 0)
+						{
+							locked.emplace(key, key);
+						}
+					}
+				);
+
+				std::cout << "read " << readPercent << "% threads " << threads
+						  << " : skip list " << TINY_STR_TO_LOCAL(skipListRate) << "/sec"
+						  << ", mutex " << TINY_STR_TO_LOCAL(lockedRate) << "/sec" << std::endl;
+			}
+		}
+
+		std::cout << std::endl;
+
+		// 写线程不断增删奇数键, 扫描线程检查有序性以及偶数键是否完整
+		ConcurrentSkipList<std::size_t, std::size_t> skipList;
+
+		for (std::size_t i = 0; i < keyCount; i += 2)
+		{
+			skipList.Insert(i, i);
+		}
+
+		std::vector<std::thread> threads;
+
+		std::atomic<bool> isStop{ false };
+
+		std::atomic<std::size_t> scanCount{ 0 };
+		std::atomic<std::size_t> errorCount{ 0 };
+
+		auto start = TINY_TIME_POINT();
+
+		for (std::size_t i = 0; i < threadCount; ++i)
+		{
+			threads.emplace_back
+			(
+				[&, i]()
+				{
+					std::mt19937_64 engine(i);
+
+					for (std::size_t j = i; j < count; j += threadCount)
+					{
+						std::size_t key = (engine() % (keyCount / 2)) * 2 + 1;
+
+						if (!skipList.Erase(key))
+						{
+							skipList.Insert(key, key);
+						}
+					}
+				}
+			);
+		}
+
+		std::thread scanner
+		(
+			[&]()
+			{
+				while (!isStop.load(std::memory_order_acquire))
+				{
+					std::size_t even = 0;
+					std::size_t previous = 0;
+
+					skipList.Range
+					(
+						0, keyCount,
+
+						[&](const std::size_t & key, const std::size_t & value)
+						{
+							if ((even > 0 && key <= previous) || key != value)
+							{
+								errorCount.fetch_add(1, std::memory_order_relaxed);
+							}
+
+							even += key % 2 == 0 ? 1 : 0;
+
+							previous = key;
+
+							return true;
+						}
+					);
+
+					if (even != keyCount / 2)
+					{
+						errorCount.fetch_add(1, std::memory_order_relaxed);
+					}
+
+					scanCount.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		);
+
+		for (auto &t : threads)
+		{
+			t.join();
+		}
+
+		auto stop = TINY_TIME_POINT();
+
+		isStop.store(true, std::memory_order_release);
+
+		scanner.join();
+
+		std::cout << "writes   : " << TINY_STR_TO_LOCAL(count / TINY_TIME_DOUBLE(stop - start)) << "/sec" << std::endl;
+		std::cout << "scans    : " << TINY_STR_TO_LOCAL(scanCount.load()) << std::endl;
+		std::cout << "size     : " << TINY_STR_TO_LOCAL(skipList.Size()) << std::endl;
+		std::cout << "result   : " << (errorCount.load() == 0 ? "ok" : "failed") << std::endl << std::endl;
+	}
+
+	static void Filter(const std::size_t count = 1000000)
+	{
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Blocked bloom filter and cuckoo filter, " << count << " keys" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		// 插入[0, count), 用[2^40, 2^40 + count)统计误判
+		const uint64_t absent = uint64_t(1) << 40;
+
+		{
+			BloomFilter<uint64_t> filter(count);
+
+			TestFilter
+			(
+				"bloom ", count, filter.SizeInBytes(),
+
+				[&](uint64_t key)
+				{
+					filter.Insert(key);
+
+					return true;
+				},
+
+				[&](uint64_t key)
+				{
+					return filter.Contains(key);
+				}
+			);
+
+			auto start = TINY_TIME_POINT();
+
+			filter.Save("bloom.filter");
+
+			auto saved = TINY_TIME_POINT();
+
+			auto loaded = BloomFilter<uint64_t>::Load("bloom.filter");
+
+			auto stop = TINY_TIME_POINT();
+
+			std::size_t mismatch = 0;
+
+			for (uint64_t i = 0; i < count; i += 97)
+			{
+				mismatch += loaded.Contains(i) && loaded.Contains(absent + i) == filter.Contains(absent + i) ? 0 : 1;
+			}
+
+			std::cout << "bloom  save " << TINY_TIME_DOUBLE(saved - start) * 1000 << " ms, load "
+					  << TINY_TIME_DOUBLE(stop - saved) * 1000 << " ms, result " << (mismatch == 0 ? "ok" : "failed") << std::endl << std::endl;
+
+			remove("bloom.filter");
+		}
+
+		{
+			CuckooFilter<uint64_t> filter(count);
+
+			TestFilter
+			(
+				"cuckoo", count, filter.SizeInBytes(),
+
+				[&](uint64_t key)
+				{
+					return filter.Insert(key);
+				},
+
+				[&](uint64_t key)
+				{
+					return filter.Contains(key);
+				}
+			);
+
+			auto start = TINY_TIME_POINT();
+
+			filter.Save("cuckoo.filter");
+
+			auto saved = TINY_TIME_POINT();
+
+			auto loaded = CuckooFilter<uint64_t>::Load("cuckoo.filter");
+
+			auto stop = TINY_TIME_POINT();
+
+			std::size_t mismatch = 0;
+
+			for (uint64_t i = 0; i < count; i += 97)
+			{
+				mismatch += loaded.Contains(i) && loaded.Contains(absent + i) == filter.Contains(absent + i) ? 0 : 1;
+			}
+
+			std::cout << "cuckoo save " << TINY_TIME_DOUBLE(saved - start) * 1000 << " ms, load "
+					  << TINY_TIME_DOUBLE(stop - saved) * 1000 << " ms, result " << (mismatch == 0 ? "ok" : "failed") << std::endl;
+
+			remove("cuckoo.filter");
+
+			// 删除一半后另一半必须仍然存在
+			std::size_t lost = 0;
+
+			auto erase = TINY_TIME_POINT();
+
+			for (uint64_t i = 0; i < count; i += 2)
+			{
+				filter.Erase(i);
+			}
+
+			auto erased = TINY_TIME_POINT();
+
+			for (uint64_t i = 1; i < count; i += 2)
+			{
+				lost += filter.Contains(i) ? 0 : 1;
+			}
+
+			std::cout << "cuckoo erase " << TINY_STR_TO_LOCAL((count / 2) / TINY_TIME_DOUBLE(erased - erase)) << "/sec, lost "
+					  << TINY_STR_TO_LOCAL(lost) << ", load " << filter.LoadFactor() * 100 << "%" << std::endl << std::endl;
+		}
+	}
+
+	static void Spill(const std::size_t count = 1000000)
+	{
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Spill queue, consumer outage then replay, " << count << " records" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		const std::size_t memorySize = 4096;
+
+		std::string payload(120, 'x');
+
+		// 消费者停顿期间, 普通有界队列只能丢弃
+		{
+			BoundedQueue<std::string> queue(memorySize);
+
+			std::size_t discard = 0;
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				discard += queue.Write(payload) ? 0 : 1;
+			}
+
+			std::cout << "bounded discard : " << TINY_STR_TO_LOCAL(discard) << std::endl;
+		}
+
+		SpillQueue<std::string> queue("spill.queue", memorySize, 16 * TINY_MB);
+
+		auto start = TINY_TIME_POINT();
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			payload.replace(0, 8, reinterpret_cast<const char *>(&i), 8);
+
+			queue.Write(payload);
+		}
+
+		auto written = TINY_TIME_POINT();
+
+		std::size_t spillCount   = queue.SpillCount();
+		std::size_t segmentCount = queue.SegmentCount();
+
+		// 消费者恢复, 按写入顺序回放
+		std::size_t error = 0;
+
+		std::string data;
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			if (!queue.Read(data) || data.compare(0, 8, reinterpret_cast<const char *>(&i), 8) != 0)
+			{
+				++error;
+			}
+		}
+
+		auto stop = TINY_TIME_POINT();
+
+		std::cout << "spill write     : " << TINY_STR_TO_LOCAL(count / TINY_TIME_DOUBLE(written - start)) << "/sec, spilled "
+				  << TINY_STR_TO_LOCAL(spillCount) << " into " << segmentCount << " segments" << std::endl;
+		std::cout << "spill replay    : " << TINY_STR_TO_LOCAL(count / TINY_TIME_DOUBLE(stop - written)) << "/sec" << std::endl;
+		std::cout << "segments left   : " << queue.SegmentCount() << std::endl;
+		std::cout << "result          : " << (error == 0 && queue.Empty() ? "ok" : "failed") << std::endl << std::endl;
+
+		rmdir("spill.queue");
+	}
+
+protected:
+	struct TimerTask
+	{
+		std::size_t * counter{ nullptr };
+
+		void operator()() const
+		{
+			++*counter;
+		}
+	};
+
+	// 普通环形缓冲区, 跨越末尾时拆成两次拷贝
+	class SplitRing
+	{
+	public:
+		explicit SplitRing(std::size_t capacity) : _storage(capacity)
+		{
+
+		}
+
+		std::size_t Free() const
+		{
+			return _storage.size() - (_writePos - _readPos);
+		}
+
+		std::size_t Size() const
+		{
+			return _writePos - _readPos;
+		}
+
+		void Write(const Byte * data, std::size_t size)
+		{
+			std::size_t offset = _writePos % _storage.size();
+			std::size_t first  = std::min(size, _storage.size() - offset);
+
+			memcpy(_storage.data() + offset, data, first);
+			memcpy(_storage.data(), data + first, size - first);
+
+			_writePos += size;
+		}
+
+		void Read(Byte * data, std::size_t size)
+		{
+			std::size_t offset = _readPos % _storage.size();
+			std::size_t first  = std::min(size, _storage.size() - offset);
+
+			memcpy(data, _storage.data() + offset, first);
+			memcpy(data + first, _storage.data(), size - first);
+
+			_readPos += size;
+		}
+
+	protected:
+		std::size_t _readPos{ 0 };
+		std::size_t _writePos{ 0 };
+
+		std::vector<Byte> _storage{ };
+	};
+
+	// 引用计数, 切片, 唯一持有时移交存储, 共享时拷贝, 返回错误个数
+	template <typename MessageT>
+	static std::size_t CheckShared()
+	{
+		std::size_t error = 0;
+
+		Message source;
+
+		source.Write("head");
+		source.Write("0123456789");
+		source.ReadCompleted(4);
+
+		MessageT message(std::move(source));
+
+		error += message.ToString() == "0123456789" && message.UseCount() == 1 ? 0 : 1;
+
+		{
+			MessageT copy(message);
+
+			auto slice = message.Slice(2, 5);
+			auto inner = slice.Slice(1, 2);
+
+			error += message.UseCount() == 4 ? 0 : 1;
+			error += slice.ToString() == "23456" && inner.ToString() == "34" ? 0 : 1;
+			error += inner.Data() == message.Data() + 3 ? 0 : 1;
+
+			try
+			{
+				slice.Slice(3, 3);
+
+				++error;
+			}
+			catch (tinyCore::debug::IndexError &)
+			{
+
+			}
+
+			// 存储被共享, 只能拷贝当前视图
+			const Byte * data = copy.Data();
+
+			auto copied = std::move(copy).ToMessage();
+
+			error += copied.ReadPointer() != data && copy.Empty() ? 0 : 1;
+			error += std::string(reinterpret_cast<const char *>(copied.ReadPointer()), copied.UnReadSize()) == "0123456789" ? 0 : 1;
+			error += message.UseCount() == 3 ? 0 : 1;
+		}
+
+		error += message.UseCount() == 1 ? 0 : 1;
+
+		// 常量引用总是拷贝, 不影响引用计数
+		auto constCopy = message.ToMessage();
+
+		error += constCopy.UnReadSize() == 10 && message.UseCount() == 1 ? 0 : 1;
+
+		// 唯一持有, 直接移交存储
+		const Byte * data = message.Data();
+
+		auto moved = std::move(message).ToMessage();
+
+		error += moved.ReadPointer() == data && moved.UnReadSize() == 10 ? 0 : 1;
+		error += message.Empty() && message.UseCount() == 0 ? 0 : 1;
+
+		return error;
+	}
+
+	static uint64_t Checksum(const Byte * data, std::size_t size)
+	{
+		uint64_t sum = size;
+
+		for (std::size_t i = 0; i < size; i += 64)
+		{
+			sum += data[i];
+		}
+
+		return sum;
+	}
+
+	// 记录直接在缓冲区内解析, 不需要拷出
+	static void ConsumeRing(RingBufferSync & ring, uint64_t & checksum)
+	{
+		while (!ring.Empty())
+		{
+			uint32_t size = 0;
+
+			ring.Peek(&size, sizeof(uint32_t));
+
+			checksum += Checksum(ring.ReadPointer() + sizeof(uint32_t), size);
+
+			ring.ReadCompleted(size + sizeof(uint32_t));
+		}
+	}
+
+	static void ConsumeSplit(SplitRing & ring, std::vector<Byte> & temp, uint64_t & checksum)
+	{
+		while (ring.Size() > 0)
+		{
+			uint32_t size = 0;
+
+			ring.Read(reinterpret_cast<Byte *>(&size), sizeof(uint32_t));
+			ring.Read(temp.data(), size);
+
+			checksum += Checksum(temp.data(), size);
+		}
+	}
+
+	class LRUCache
+	{
+	public:
+		explicit LRUCache(std::size_t capacity) : _capacity(capacity)
+		{
+
+		}
+
+		bool Get(std::size_t key)
+		{
+			auto iter = _map.find(key);
+
+			if (iter == _map.end())
+			{
+				++_miss;
+
+				return false;
+			}
+
+			_list.splice(_list.begin(), _list, iter->second);
+
+			++_hit;
+
+			return true;
+		}
+
+		void Put(std::size_t key)
+		{
+			_list.push_front(key);
+
+			_map[key] = _list.begin();
+
+			if (_list.size() > _capacity)
+			{
+				_map.erase(_list.back());
+
+				_list.pop_back();
+			}
+		}
+
+		double HitRatio() const
+		{
+			return static_cast<double>(_hit) / static_cast<double>(_hit + _miss);
+		}
+
+	protected:
+		std::size_t _hit{ 0 };
+		std::size_t _miss{ 0 };
+		std::size_t _capacity{ 0 };
+
+		std::list<std::size_t> _list{ };
+
+		std::unordered_map<std::size_t, std::list<std::size_t>::iterator> _map{ };
+	};
+
+	static std::vector<std::size_t> ZipfKeys(const std::size_t count, const std::size_t keyCount, const double skew)
+	{
+		std::vector<double> cdf(keyCount);
+
+		double sum = 0.0;
+
+		for (std::size_t i = 0; i < keyCount; ++i)
+		{
+			sum += 1.0 / std::pow(static_cast<double>(i + 1), skew);
+
+			cdf[i] = sum;
+		}
+
+		std::mt19937_64 engine(keyCount);
+
+		std::uniform_real_distribution<double> distribution(0.0, sum);
+
+		std::vector<std::size_t> keys(count);
+
+		for (auto &key : keys)
+		{
+			auto rank = static_cast<std::size_t>(std::lower_bound(cdf.begin(), cdf.end(), distribution(engine)) - cdf.begin());
+
+			// 打散排名与键值的对应关系
+			key = (rank * 0x9E3779B97F4A7C15ull) % (keyCount * 16);
+		}
+
+		return keys;
+	}
+
+	template <typename InsertT, typename ContainsT>
+	static void TestFilter(const char * name, const std::size_t count, const std::size_t bytes, InsertT && insert, ContainsT && contains)
+	{
+		const uint64_t absent = uint64_t(1) << 40;
+
+		std::size_t failed = 0;
+
+		auto start = TINY_TIME_POINT();
+
+		for (uint64_t i = 0; i < count; ++i)
+		{
+			failed += insert(i) ? 0 : 1;
+		}
+
+		auto inserted = TINY_TIME_POINT();
+
+		std::size_t hit = 0;
+
+		for (uint64_t i = 0; i < count; ++i)
+		{
+			hit += contains(i) ? 1 : 0;
+		}
+
+		auto positive = TINY_TIME_POINT();
+
+		std::size_t falsePositive = 0;
+
+		for (uint64_t i = 0; i < count; ++i)
+		{
+			falsePositive += contains(absent + i) ? 1 : 0;
+		}
+
+		auto negative = TINY_TIME_POINT();
+
+		std::cout << name << " size     : " << TINY_STR_TO_LOCAL(bytes) << " bytes, " << bytes * 8.0 / count << " bits/key" << std::endl;
+		std::cout << name << " insert   : " << TINY_STR_TO_LOCAL(count / TINY_TIME_DOUBLE(inserted - start)) << "/sec, failed " << TINY_STR_TO_LOCAL(failed) << std::endl;
+		std::cout << name << " positive : " << TINY_STR_TO_LOCAL(count / TINY_TIME_DOUBLE(positive - inserted)) << "/sec, missed " << TINY_STR_TO_LOCAL(count - hit) << std::endl;
+		std::cout << name << " negative : " << TINY_STR_TO_LOCAL(count / TINY_TIME_DOUBLE(negative - positive)) << "/sec" << std::endl;
+		std::cout << name << " fpr      : " << static_cast<double>(falsePositive) / count * 100 << "%" << std::endl;
+	}
+
+	template <typename FindT, typename WriteT>
+	static double TestMap(const std::size_t count, const std::size_t threadCount, const std::size_t keyCount,
+						  const std::size_t readPercent, FindT && find, WriteT && write)
+	{
+		std::vector<std::thread> threads;
+
+		std::atomic<std::size_t> hit{ 0 };
+
+		auto start = TINY_TIME_POINT();
+
+		for (std::size_t i = 0; i < threadCount; ++i)
+		{
+			threads.emplace_back
+			(
+				[&, i]()
+				{
+					std::size_t value = 0;
+					std::size_t found = 0;
+
+					std::mt19937_64 engine(i);
+
+					for (std::size_t j = i; j < count; j += threadCount)
+					{
+						std::size_t key = engine() % keyCount;
+
+						if (engine() % 100 < readPercent)
+						{
+							found += find(key, value) ? 1 : 0;
+						}
+						else
+						{
+							write(key);
+						}
+					}
+
+					hit.fetch_add(found, std::memory_order_relaxed);
+				}
+			);
+		}
+
+		for (auto &t : threads)
+		{
+			t.join();
+		}
+
+		auto stop = TINY_TIME_POINT();
+
+		return count / TINY_TIME_DOUBLE(stop - start);
+	}
+};
+
+
+#endif // __EXAMPLE__CONTAINER__EXAMPLE__H__
@@ -0,0 +1,92 @@
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 主函数
+ *
+ */
+
+
+#include "main.h"
+
+
+void ParseOption(int argc, char const * argv[])
+{
+	TINY_OPTION_DEFINE("deque", "work stealing deque stress test", "Deque options")
+	TINY_OPTION_DEFINE("chain", "chain buffer consistency test", "Chain options")
+	TINY_OPTION_DEFINE("shared", "shared message fan-out test", "Shared options")
+	TINY_OPTION_DEFINE("map", "concurrent hash map benchmark", "Map options")
+	TINY_OPTION_DEFINE("cache", "concurrent cache benchmark", "Cache options")
+	TINY_OPTION_DEFINE("timer", "timer wheel benchmark", "Timer options")
+	TINY_OPTION_DEFINE("ring", "mirrored ring buffer benchmark", "Ring options")
+	TINY_OPTION_DEFINE("skiplist", "concurrent skip list benchmark", "SkipList options")
+	TINY_OPTION_DEFINE("filter", "bloom and cuckoo filter benchmark, e.g. --count=100000000", "Filter options")
+	TINY_OPTION_DEFINE("spill", "disk spill queue benchmark", "Spill options")
+
+	TINY_OPTION_DEFINE_ARG("count",  "item count", "1000000")
+	TINY_OPTION_DEFINE_ARG("thread", "max thread count", "4")
+
+	TINY_OPTION_DEFINE_VERSION("2018-05-08")
+
+	TINY_OPTION_PARSE(argc, argv);
+}
+
+void StartApp()
+{
+	auto count  = TINY_STR_TO_DIGITAL(std::size_t, TINY_OPTION_GET("count"));
+	auto thread = TINY_STR_TO_DIGITAL(std::size_t, TINY_OPTION_GET("thread"));
+
+	if (TINY_OPTION_HAS("deque"))
+	{
+		Example::Deque(count, thread);
+	}
+	else if (TINY_OPTION_HAS("chain"))
+	{
+		Example::Chain(count);
+	}
+	else if (TINY_OPTION_HAS("shared"))
+	{
+		Example::Shared(count, thread);
+	}
+	else if (TINY_OPTION_HAS("map"))
+	{
+		Example::Map(count, thread);
+	}
+	else if (TINY_OPTION_HAS("cache"))
+	{
+		Example::Cache(count, thread);
+	}
+	else if (TINY_OPTION_HAS("timer"))
+	{
+		Example::Timer(count, thread);
+	}
+	else if (TINY_OPTION_HAS("ring"))
+	{
+		Example::Ring(count);
+	}
+	else if (TINY_OPTION_HAS("skiplist"))
+	{
+		Example::SkipList(count, thread);
+	}
+	else if (TINY_OPTION_HAS("filter"))
+	{
+		Example::Filter(count);
+	}
+	else if (TINY_OPTION_HAS("spill"))
+	{
+		Example::Spill(count);
+	}
+	else
+	{
+		Example::Test(count, thread);
+	}
+}
+
+int main(int argc, char const * argv[])
+{
+	ParseOption(argc, argv);
+
+	StartApp();
+
+	return 0;
+}
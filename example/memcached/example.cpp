@@ -0,0 +1,10 @@
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 测试
+ *
+ */
+
+
+#include "example.h"
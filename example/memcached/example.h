@@ -0,0 +1,956 @@
+#ifndef __EXAMPLE__MEMCACHED__EXAMPLE__H__
+#define __EXAMPLE__MEMCACHED__EXAMPLE__H__
+
+
+#include <tinyCore/tinyCore.h>
+
+
+using namespace tinyCore::container;
+
+
+class Example
+{
+public:
+	static void Test(const std::string & host, const uint16_t port, const std::size_t count = 1000)
+	{
+		Batch(host, port, count);
+		Pool(host, port, count);
+		Near(host, port, count);
+		Value(host, port);
+		Server(host, port, count);
+	}
+
+	static void Batch(const std::string & host, const uint16_t port, const std::size_t count = 1000)
+	{
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Memcached single vs batch, " << host << ":" << port << ", " << count << " iterations" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		Memcached memcached;
+
+		if (!memcached.Initialize(host.c_str(), port))
+		{
+			std::cout << "initialize failed : " << memcached.LastError() << std::endl;
+
+			return;
+		}
+
+		for (std::size_t batch : { 1, 10, 50, 100, 200 })
+		{
+			StringVector keys;
+
+			std::unordered_map<std::string, std::string> values;
+
+			for (std::size_t i = 0; i < batch; ++i)
+			{
+				keys.push_back("tinyCore_batch_" + std::to_string(i));
+
+				values[keys.back()] = std::string(100, static_cast<char>('a' + i % 26));
+			}
+
+			auto singleSet = Measure
+			(
+				count,
+
+				[&]()
+				{
+					for (auto &iter : values)
+					{
+						memcached.SetValue(iter.first.c_str(), iter.second);
+					}
+				}
+			);
+
+			auto multiSet = Measure
+			(
+				count,
+
+				[&]()
+				{
+					memcached.SetMulti(values);
+				}
+			);
+
+			auto singleGet = Measure
+			(
+				count,
+
+				[&]()
+				{
+					std::string value;
+
+					for (auto &iter : keys)
+					{
+						memcached.GetValue(iter.c_str(), value);
+					}
+				}
+			);
+
+			std::size_t found = 0;
+
+			auto multiGet = Measure
+			(
+				count,
+
+				[&]()
+				{
+					std::unordered_map<std::string, std::string> result;
+
+					memcached.GetMulti(keys, result);
+
+					found = result.size();
+				}
+			);
+
+			std::cout << "batch " << batch
+					  << " : set " << singleSet << " us -> " << multiSet << " us"
+					  << ", get " << singleGet << " us -> " << multiGet << " us"
+					  << " (found " << found << ")" << std::endl;
+
+			memcached.DeleteMulti(keys);
+		}
+
+		memcached.Release();
+
+		std::cout << std::endl;
+	}
+
+	static void Pool(const std::string & host, const uint16_t port, const std::size_t count = 1000, const std::size_t threadCount = 4)
+	{
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Memcached pool, " << host << ":" << port << ", " << threadCount << " threads, " << count << " iterations" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		std::size_t error = 0;
+
+		// 句柄用尽后按超时返回空句柄, 归还后等待者立即拿到
+		{
+			MemcachedPool pool;
+
+			if (!pool.Initialize(host.c_str(), port, 2))
+			{
+				std::cout << "initialize failed : " << pool.LastError() << std::endl;
+
+				return;
+			}
+
+			auto first  = pool.Checkout();
+			auto second = pool.Checkout();
+
+			auto start = std::chrono::steady_clock::now();
+
+			auto third = pool.Checkout(std::chrono::milliseconds(50));
+
+			auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+			error += (!third && waited >= 50 && pool.LastError() == "checkout timeout") ? 0 : 1;
+
+			std::atomic<bool> isGot{ false };
+
+			std::thread waiter
+			(
+				[&]()
+				{
+					auto handle = pool.Checkout(std::chrono::milliseconds(5000));
+
+					isGot.store(static_cast<bool>(handle));
+				}
+			);
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+			first.Reset();
+
+			waiter.join();
+
+			second.Reset();
+
+			error += (isGot.load() && pool.Size() == 2 && pool.IdleCount() == 2) ? 0 : 1;
+
+			std::cout << "timeout  : waited " << waited << " ms, waiter " << (isGot.load() ? "woken" : "starved") << std::endl;
+		}
+
+		// 每个线程再次取出时拿回自己上次用过的句柄
+		{
+			MemcachedPool pool;
+
+			pool.Initialize(host.c_str(), port, threadCount);
+
+			std::atomic<std::size_t> same{ 0 };
+			std::atomic<std::size_t> arrived{ 0 };
+
+			std::vector<std::thread> threads;
+
+			for (std::size_t i = 0; i < threadCount; ++i)
+			{
+				threads.emplace_back
+				(
+					[&]()
+					{
+						const Memcached * last = nullptr;
+
+						for (std::size_t round = 0; round < 3; ++round)
+						{
+							auto handle = pool.Checkout();
+
+							if (!handle)
+							{
+								return;
+							}
+
+							if (last == &*handle)
+							{
+								same.fetch_add(1, std::memory_order_relaxed);
+							}
+
+							last = &*handle;
+
+							std::string value;
+
+							handle->GetValue("tinyCore_pool_affinity", value);
+
+							// 所有线程同时持有句柄, 再同时归还
+							arrived.fetch_add(1);
+
+							while (arrived.load() < (round + 1) * threadCount)
+							{
+								std::this_thread::yield();
+							}
+						}
+					}
+				);
+			}
+
+			for (auto &t : threads)
+			{
+				t.join();
+			}
+
+			error += same.load() == threadCount * 2 ? 0 : 1;
+
+			std::cout << "affinity : " << same.load() << "/" << threadCount * 2 << " checkouts got the same handle" << std::endl;
+		}
+
+		// 服务端断开后, 出现连接错误的句柄在归还时被销毁, 服务恢复后重新克隆
+		{
+			MemcachedServer server;
+
+			if (!server.Start(host.c_str(), 0, 1))
+			{
+				std::cout << "embedded server start failed : " << server.LastError() << std::endl;
+
+				return;
+			}
+
+			uint16_t serverPort = server.Port();
+
+			MemcachedPool pool;
+
+			pool.Initialize(host.c_str(), serverPort, 1);
+
+			std::string value;
+
+			{
+				auto handle = pool.Checkout();
+
+				error += handle->SetValue("tinyCore_pool_evict", "value") ? 0 : 1;
+			}
+
+			server.Stop();
+
+			{
+				auto handle = pool.Checkout();
+
+				error += (!handle->GetValue("tinyCore_pool_evict", value) && handle->IsConnectionError()) ? 0 : 1;
+			}
+
+			error += (pool.EvictCount() == 1 && pool.Size() == 0) ? 0 : 1;
+
+			std::size_t evicted = pool.EvictCount();
+
+			server.Start(host.c_str(), serverPort, 1);
+
+			{
+				auto handle = pool.Checkout();
+
+				error += (handle && handle->SetValue("tinyCore_pool_evict", "again") && handle->GetValue("tinyCore_pool_evict", value) && value == "again") ? 0 : 1;
+			}
+
+			error += pool.Size() == 1 ? 0 : 1;
+
+			std::cout << "evict    : " << evicted << " broken handle, recovered " << (value == "again" ? "ok" : "failed") << std::endl;
+
+			pool.Release();
+
+			server.Stop();
+		}
+
+		// 线程数多于句柄数, 读写结果正确且句柄全部归还
+		{
+			MemcachedPool pool;
+
+			pool.Initialize(host.c_str(), port, threadCount / 2 + 1);
+
+			std::vector<std::thread> threads;
+
+			std::atomic<std::size_t> failed{ 0 };
+
+			auto start = std::chrono::steady_clock::now();
+
+			for (std::size_t i = 0; i < threadCount * 2; ++i)
+			{
+				threads.emplace_back
+				(
+					[&, i]()
+					{
+						std::string value;
+
+						for (std::size_t j = 0; j < count; ++j)
+						{
+							std::string key = "tinyCore_pool_" + std::to_string(i) + "_" + std::to_string(j % 100);
+
+							auto handle = pool.Checkout();
+
+							if (!handle || !handle->SetValue(key.c_str(), key) || !handle->GetValue(key.c_str(), value) || value != key)
+							{
+								failed.fetch_add(1, std::memory_order_relaxed);
+							}
+						}
+					}
+				);
+			}
+
+			for (auto &t : threads)
+			{
+				t.join();
+			}
+
+			auto stop = std::chrono::steady_clock::now();
+
+			error += failed.load();
+			error += (pool.Size() <= threadCount / 2 + 1 && pool.IdleCount() == pool.Size()) ? 0 : 1;
+
+			std::cout << "contend  : " << threadCount * 2 << " threads on " << pool.Size() << " handles, failed " << failed.load()
+					  << ", " << TINY_STR_TO_LOCAL(threadCount * 2 * count / std::chrono::duration<double>(stop - start).count()) << "/sec" << std::endl;
+		}
+
+		std::cout << "result   : " << (error == 0 ? "ok" : "failed") << std::endl << std::endl;
+	}
+
+	static void Near(const std::string & host, const uint16_t port, const std::size_t count = 1000)
+	{
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Memcached near cache, " << host << ":" << port << ", " << count << " iterations" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		auto consistency = CheckNear();
+
+		std::cout << "consistency : " << (consistency == 0 ? "ok" : "failed") << std::endl << std::endl;
+
+		const std::size_t keyCount = 1000;
+		const std::size_t threadCount = 8;
+
+		MemcachedPool pool;
+
+		if (!pool.Initialize(host.c_str(), port, threadCount))
+		{
+			std::cout << "initialize failed : " << pool.LastError() << std::endl;
+
+			return;
+		}
+
+		{
+			auto handle = pool.Checkout();
+
+			for (std::size_t i = 0; i < keyCount; i += 2)
+			{
+				handle->SetValue(("tinyCore_near_" + std::to_string(i)).c_str(), std::string(100, 'n'));
+			}
+		}
+
+		// 热点键集中访问, 奇数键不存在用于覆盖负缓存
+		std::vector<std::string> keys(count * threadCount);
+
+		std::mt19937_64 engine(keyCount);
+
+		std::geometric_distribution<std::size_t> distribution(0.05);
+
+		for (auto &key : keys)
+		{
+			key = "tinyCore_near_" + std::to_string(distribution(engine) % keyCount);
+		}
+
+		std::atomic<std::size_t> directFound{ 0 };
+
+		auto direct = Measure
+		(
+			1,
+
+			[&]()
+			{
+				RunThreads
+				(
+					threadCount, keys,
+
+					[&](const std::string & key, std::string & value)
+					{
+						auto handle = pool.Checkout();
+
+						if (handle && handle->GetValue(key.c_str(), value))
+						{
+							directFound.fetch_add(1, std::memory_order_relaxed);
+						}
+					}
+				);
+			}
+		);
+
+		MemcachedNearCache near(pool, keyCount / 10, std::chrono::milliseconds(500), std::chrono::milliseconds(100));
+
+		std::atomic<std::size_t> nearFound{ 0 };
+
+		auto cached = Measure
+		(
+			1,
+
+			[&]()
+			{
+				RunThreads
+				(
+					threadCount, keys,
+
+					[&](const std::string & key, std::string & value)
+					{
+						if (near.GetValue(key, value))
+						{
+							nearFound.fetch_add(1, std::memory_order_relaxed);
+						}
+					}
+				);
+			}
+		);
+
+		auto statistics = near.Statistics();
+
+		std::cout << "direct   : " << direct / 1000 << " ms, backend gets " << TINY_STR_TO_LOCAL(keys.size())
+				  << ", found " << TINY_STR_TO_LOCAL(directFound.load()) << std::endl;
+		std::cout << "near     : " << cached / 1000 << " ms, backend gets " << TINY_STR_TO_LOCAL(statistics.miss)
+				  << ", found " << TINY_STR_TO_LOCAL(nearFound.load()) << std::endl;
+		std::cout << "hit      : " << TINY_STR_TO_LOCAL(statistics.hit) << std::endl;
+		std::cout << "negative : " << TINY_STR_TO_LOCAL(statistics.negativeHit) << std::endl;
+		std::cout << "coalesce : " << TINY_STR_TO_LOCAL(statistics.coalesce) << std::endl;
+		std::cout << "error    : " << TINY_STR_TO_LOCAL(statistics.backendError) << std::endl;
+		std::cout << "local    : " << statistics.LocalRatio() * 100 << "%" << std::endl;
+
+		{
+			auto handle = pool.Checkout();
+
+			for (std::size_t i = 0; i < keyCount; i += 2)
+			{
+				handle->DeleteValue("tinyCore_near_" + std::to_string(i));
+			}
+		}
+
+		pool.Release();
+
+		std::cout << std::endl;
+	}
+
+	static void Value(const std::string & host, const uint16_t port)
+	{
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Memcached binary values and compression, " << host << ":" << port << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		const std::size_t threshold = 1024;
+
+		RawMemcached memcached;
+
+		if (!memcached.Initialize(host.c_str(), port))
+		{
+			std::cout << "initialize failed : " << memcached.LastError() << std::endl;
+
+			return;
+		}
+
+		memcached.SetCompression(threshold);
+
+		std::size_t error = 0;
+
+		std::mt19937_64 engine(threshold);
+
+		// 小值含'\0', 低于阈值原样存储
+		std::string small("a\0b\0\0c", 6);
+
+		// 大值可压缩且含'\0', 超过阈值压缩存储
+		std::string large;
+
+		for (std::size_t i = 0; large.size() < 64 * TINY_KB; ++i)
+		{
+			large += "tinyCore" + std::string(i % 7, '\0') + std::to_string(i % 100);
+		}
+
+		// 随机数据压缩后不会变小, 超过阈值也原样存储
+		std::string noise(4 * TINY_KB, '\0');
+
+		for (auto &iter : noise)
+		{
+			iter = static_cast<char>(engine());
+		}
+
+		std::unordered_map<std::string, std::string> values
+		{
+			{ "tinyCore_value_small", small },
+			{ "tinyCore_value_large", large },
+			{ "tinyCore_value_noise", noise },
+		};
+
+		for (auto &iter : values)
+		{
+			error += memcached.SetValue(iter.first.c_str(), iter.first.size(), iter.second.data(), iter.second.size(), 0x1234) ? 0 : 1;
+		}
+
+		uint32_t flags = 0;
+
+		auto smallStored = memcached.StoredSize("tinyCore_value_small", flags);
+
+		error += (smallStored == small.size() && flags == 0x1234) ? 0 : 1;
+
+		auto largeStored = memcached.StoredSize("tinyCore_value_large", flags);
+
+		error += (largeStored < large.size() && flags == (0x1234 | Memcached::FLAG_COMPRESSED)) ? 0 : 1;
+
+		auto noiseStored = memcached.StoredSize("tinyCore_value_noise", flags);
+
+		error += (noiseStored == noise.size() && flags == 0x1234) ? 0 : 1;
+
+		for (auto &iter : values)
+		{
+			std::string value;
+
+			error += (memcached.GetValue(iter.first.c_str(), iter.first.size(), value) && value == iter.second) ? 0 : 1;
+
+			// 未压缩的值直接接管libmemcached的缓冲区, 压缩的值解压到句柄自己的存储
+			MemcachedValue handle;
+
+			error += (memcached.GetValue(iter.first.c_str(), iter.first.size(), handle) && handle.ToString() == iter.second && handle.Flags() == 0x1234) ? 0 : 1;
+
+			MemcachedValue moved(std::move(handle));
+
+			error += (handle.Empty() && moved.Size() == iter.second.size() && memcmp(moved.Data(), iter.second.data(), moved.Size()) == 0) ? 0 : 1;
+
+			// 追加到已有数据之后
+			Message message(16);
+
+			message.Write("head");
+
+			error += memcached.GetValue(iter.first.c_str(), iter.first.size(), message) ? 0 : 1;
+
+			error += std::string(reinterpret_cast<const char *>(message.ReadPointer()), message.UnReadSize()) == "head" + iter.second ? 0 : 1;
+		}
+
+		// 批量读取同样解压, 不存在的键不出现在结果中
+		StringVector keys{ "tinyCore_value_small", "tinyCore_value_large", "tinyCore_value_noise", "tinyCore_value_missing" };
+
+		std::unordered_map<std::string, std::string> result;
+
+		error += memcached.GetMulti(keys, result) ? 0 : 1;
+		error += result == values ? 0 : 1;
+
+		// 批量写入同样压缩
+		memcached.DeleteMulti(keys);
+
+		error += memcached.SetMulti(values) ? 0 : 1;
+
+		result.clear();
+
+		error += (memcached.GetMulti(keys, result) && result == values) ? 0 : 1;
+		error += (memcached.StoredSize("tinyCore_value_large", flags) == largeStored && (flags & Memcached::FLAG_COMPRESSED)) ? 0 : 1;
+
+		// 无法解压的值按失败处理, 批量读取仍返回其余键, 但整体返回false
+		error += memcached.SetCorrupt("tinyCore_value_corrupt", "not compressed") ? 0 : 1;
+
+		std::string corrupt;
+
+		error += memcached.GetValue("tinyCore_value_corrupt", corrupt) ? 1 : 0;
+
+		keys.push_back("tinyCore_value_corrupt");
+
+		result.clear();
+
+		error += memcached.GetMulti(keys, result) ? 1 : 0;
+		error += (result == values && !memcached.LastError().empty()) ? 0 : 1;
+
+		memcached.DeleteMulti(keys);
+
+		std::cout << "small    : " << small.size() << " bytes, stored " << smallStored << std::endl;
+		std::cout << "large    : " << large.size() << " bytes, stored " << largeStored << std::endl;
+		std::cout << "noise    : " << noise.size() << " bytes, stored " << noiseStored << std::endl;
+		std::cout << "result   : " << (error == 0 ? "ok" : "failed") << std::endl << std::endl;
+
+		memcached.Release();
+	}
+
+	static void Server(const std::string & host, const uint16_t port, const std::size_t count = 1000, const std::size_t threadCount = 4)
+	{
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Memcached throughput and latency, " << host << ":" << port << ", " << threadCount << " threads, " << count << " iterations" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		std::vector<std::thread> threads;
+
+		std::vector<std::vector<double>> latencies(threadCount);
+
+		std::atomic<std::size_t> failed{ 0 };
+
+		auto start = std::chrono::steady_clock::now();
+
+		for (std::size_t i = 0; i < threadCount; ++i)
+		{
+			threads.emplace_back
+			(
+				[&, i]()
+				{
+					Memcached memcached;
+
+					if (!memcached.Initialize(host.c_str(), port))
+					{
+						failed.fetch_add(count * 2, std::memory_order_relaxed);
+
+						return;
+					}
+
+					std::string value;
+
+					std::string payload(100, static_cast<char>('a' + i % 26));
+
+					latencies[i].reserve(count * 2);
+
+					for (std::size_t j = 0; j < count; ++j)
+					{
+						std::string key = "tinyCore_server_" + std::to_string(i) + "_" + std::to_string(j % 1000);
+
+						bool isSet = false;
+						bool isGet = false;
+
+						latencies[i].push_back(Measure(1, [&]() { isSet = memcached.SetValue(key.c_str(), payload); }));
+						latencies[i].push_back(Measure(1, [&]() { isGet = memcached.GetValue(key.c_str(), value); }));
+
+						if (!isSet || !isGet)
+						{
+							failed.fetch_add(1, std::memory_order_relaxed);
+						}
+					}
+
+					memcached.Release();
+				}
+			);
+		}
+
+		for (auto &t : threads)
+		{
+			t.join();
+		}
+
+		auto stop = std::chrono::steady_clock::now();
+
+		std::vector<double> all;
+
+		for (auto &iter : latencies)
+		{
+			all.insert(all.end(), iter.begin(), iter.end());
+		}
+
+		if (all.empty())
+		{
+			std::cout << "no request completed" << std::endl << std::endl;
+
+			return;
+		}
+
+		std::sort(all.begin(), all.end());
+
+		double seconds = std::chrono::duration<double>(stop - start).count();
+
+		std::cout << "ops      : " << TINY_STR_TO_LOCAL(all.size()) << std::endl;
+		std::cout << "failed   : " << TINY_STR_TO_LOCAL(failed.load()) << std::endl;
+		std::cout << "rate     : " << TINY_STR_TO_LOCAL(all.size() / seconds) << "/sec" << std::endl;
+		std::cout << "avg      : " << std::accumulate(all.begin(), all.end(), 0.0) / all.size() << " us" << std::endl;
+		std::cout << "p50      : " << all[all.size() / 2] << " us" << std::endl;
+		std::cout << "p99      : " << all[all.size() * 99 / 100] << " us" << std::endl;
+		std::cout << "max      : " << all.back() << " us" << std::endl << std::endl;
+	}
+
+protected:
+	// 读取服务端保存的原始数据, 用于确认是否经过压缩
+	class RawMemcached : public Memcached
+	{
+	public:
+		std::size_t StoredSize(const char * key, uint32_t & flags)
+		{
+			std::size_t len = 0;
+
+			memcached_return_t ret;
+
+			char * value = memcached_get(_memcached, key, strlen(key), &len, &flags, &ret);
+
+			if (value)
+			{
+				free(value);
+			}
+
+			return ret == MEMCACHED_SUCCESS ? len : 0;
+		}
+
+		// 绕过压缩直接写入带压缩标记的数据, 用于构造无法解压的值
+		bool SetCorrupt(const char * key, const std::string & value)
+		{
+			return memcached_set(_memcached, key, strlen(key), value.data(), value.size(), 0, FLAG_COMPRESSED) == MEMCACHED_SUCCESS;
+		}
+	};
+
+	// 使用测试桩后端, 返回错误个数
+	static std::size_t CheckNear()
+	{
+		std::size_t error = 0;
+
+		std::mutex lock;
+		std::condition_variable condition;
+
+		bool isOpen = false;
+		bool isThrow = true;
+
+		std::unordered_map<std::string, std::string> store;
+
+		MemcachedNearCache::Backend backend;
+
+		// 先读出当前值, 再阻塞到放行为止, 模拟读取在途时其他操作改写了后端
+		backend.get = [&](const std::string & key, std::string & value)
+		{
+			std::unique_lock<std::mutex> guard(lock);
+
+			auto iter = store.find(key);
+
+			bool isFound = iter != store.end();
+
+			if (isFound)
+			{
+				value = iter->second;
+			}
+
+			condition.wait(guard, [&isOpen]() { return isOpen; });
+
+			if (isThrow)
+			{
+				throw std::runtime_error("backend failure");
+			}
+
+			return isFound ? MemcachedNearCache::FETCH_RESULT::FOUND : MemcachedNearCache::FETCH_RESULT::NOT_FOUND;
+		};
+
+		backend.set = [&](const std::string & key, const std::string & value)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			store[key] = value;
+
+			return true;
+		};
+
+		backend.del = [&](const std::string & key)
+		{
+			std::lock_guard<std::mutex> guard(lock);
+
+			return store.erase(key) > 0;
+		};
+
+		auto open = [&](bool value)
+		{
+			{
+				std::lock_guard<std::mutex> guard(lock);
+
+				isOpen = value;
+			}
+
+			condition.notify_all();
+		};
+
+		MemcachedNearCache near(backend, 16);
+
+		store["throw"] = "throw";
+
+		// 领头请求抛出异常, 等待者得到失败结果而不是永久阻塞
+		{
+			const std::size_t waiterCount = 4;
+
+			std::atomic<std::size_t> thrown{ 0 };
+			std::atomic<std::size_t> failed{ 0 };
+
+			std::vector<std::thread> threads;
+
+			for (std::size_t i = 0; i <= waiterCount; ++i)
+			{
+				threads.emplace_back
+				(
+					[&]()
+					{
+						std::string value;
+
+						try
+						{
+							if (!near.GetValue("throw", value))
+							{
+								failed.fetch_add(1);
+							}
+						}
+						catch (std::runtime_error &)
+						{
+							thrown.fetch_add(1);
+						}
+					}
+				);
+			}
+
+			while (near.Statistics().coalesce < waiterCount)
+			{
+				std::this_thread::yield();
+			}
+
+			open(true);
+
+			for (auto &t : threads)
+			{
+				t.join();
+			}
+
+			error += (thrown.load() == 1 && failed.load() == waiterCount) ? 0 : 1;
+
+			isThrow = false;
+
+			std::string value;
+
+			error += (near.GetValue("throw", value) && value == "throw") ? 0 : 1;
+		}
+
+		// 读取在途时写入或删除, 读到的旧值不能回填到本地缓存
+		for (bool isDelete : { false, true })
+		{
+			open(false);
+
+			store["stale"] = "old";
+
+			near.Invalidate("stale");
+
+			auto misses = near.Statistics().miss;
+
+			std::string inflight;
+
+			std::thread reader([&]() { near.GetValue("stale", inflight); });
+
+			while (near.Statistics().miss == misses)
+			{
+				std::this_thread::yield();
+			}
+
+			if (isDelete)
+			{
+				near.DeleteValue("stale");
+			}
+			else
+			{
+				near.SetValue("stale", "new");
+			}
+
+			open(true);
+
+			reader.join();
+
+			std::string value;
+
+			bool isFound = near.GetValue("stale", value);
+
+			error += (isDelete ? !isFound : (isFound && value == "new")) ? 0 : 1;
+		}
+
+		// 热点键缓存容量很小时也能构造, 刚读到的值再次读取命中本地
+		for (std::size_t capacity : { 1, 2, 10 })
+		{
+			MemcachedNearCache small(backend, capacity);
+
+			for (std::size_t i = 0; i < 20; ++i)
+			{
+				auto key = "small_" + std::to_string(i);
+
+				backend.set(key, key);
+
+				std::string first;
+				std::string second;
+
+				bool isFound = small.GetValue(key, first);
+
+				auto hits = small.Statistics().hit;
+
+				isFound = small.GetValue(key, second) && isFound;
+
+				error += (isFound && first == key && second == key && small.Statistics().hit == hits + 1) ? 0 : 1;
+			}
+		}
+
+		return error;
+	}
+
+	// 返回每批平均耗时, 单位微秒
+	template <typename FuncT>
+	static double Measure(const std::size_t count, FuncT && func)
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			func();
+		}
+
+		auto stop = std::chrono::steady_clock::now();
+
+		return std::chrono::duration<double, std::micro>(stop - start).count() / count;
+	}
+	template <typename FuncT>
+	static void RunThreads(const std::size_t threadCount, const std::vector<std::string> & keys, FuncT && func)
+	{
+		std::vector<std::thread> threads;
+
+		for (std::size_t i = 0; i < threadCount; ++i)
+		{
+			threads.emplace_back
+			(
+				[&, i]()
+				{
+					std::string value;
+
+					for (std::size_t j = i; j < keys.size(); j += threadCount)
+					{
+						func(keys[j], value);
+					}
+				}
+			);
+		}
+
+		for (auto &t : threads)
+		{
+			t.join();
+		}
+	}
+};
+
+
+#endif // __EXAMPLE__MEMCACHED__EXAMPLE__H__
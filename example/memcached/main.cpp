@@ -0,0 +1,90 @@
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 主函数
+ *
+ */
+
+
+#include "main.h"
+
+
+void ParseOption(int argc, char const * argv[])
+{
+	TINY_OPTION_DEFINE("batch", "batch operation benchmark", "Batch options")
+	TINY_OPTION_DEFINE("pool", "connection pool test", "Pool options")
+	TINY_OPTION_DEFINE("near", "near cache benchmark", "Near options")
+	TINY_OPTION_DEFINE("value", "binary value and compression round trip", "Value options")
+	TINY_OPTION_DEFINE("server", "throughput and latency benchmark", "Server options")
+	TINY_OPTION_DEFINE("embedded", "run against an embedded memcached server", "Embedded options")
+
+	TINY_OPTION_DEFINE_ARG("host",  "memcached host", "127.0.0.1")
+	TINY_OPTION_DEFINE_ARG("port",  "memcached port", "11211")
+	TINY_OPTION_DEFINE_ARG("count", "iterations per test", "1000")
+
+	TINY_OPTION_DEFINE_VERSION("2018-05-08")
+
+	TINY_OPTION_PARSE(argc, argv);
+}
+
+void StartApp()
+{
+	auto host  = TINY_OPTION_GET("host");
+	auto port  = TINY_STR_TO_DIGITAL(uint16_t, TINY_OPTION_GET("port"));
+	auto count = TINY_STR_TO_DIGITAL(std::size_t, TINY_OPTION_GET("count"));
+
+	MemcachedServer server;
+
+	if (TINY_OPTION_HAS("embedded"))
+	{
+		if (!server.Start(host.c_str(), 0))
+		{
+			std::cout << "embedded server start failed : " << server.LastError() << std::endl;
+
+			return;
+		}
+
+		port = server.Port();
+	}
+
+	if (TINY_OPTION_HAS("batch"))
+	{
+		Example::Batch(host, port, count);
+	}
+	else if (TINY_OPTION_HAS("pool"))
+	{
+		Example::Pool(host, port, count);
+	}
+	else if (TINY_OPTION_HAS("near"))
+	{
+		Example::Near(host, port, count);
+	}
+	else if (TINY_OPTION_HAS("value"))
+	{
+		Example::Value(host, port);
+	}
+	else if (TINY_OPTION_HAS("server"))
+	{
+		Example::Server(host, port, count);
+	}
+	else
+	{
+		Example::Test(host, port, count);
+	}
+
+	// 连接被意外断开重连时, 总连接数会远大于客户端句柄数
+	if (TINY_OPTION_HAS("embedded"))
+	{
+		std::cout << "embedded server total connections : " << server.Statistics().totalConnection << std::endl;
+	}
+}
+
+int main(int argc, char const * argv[])
+{
+	ParseOption(argc, argv);
+
+	StartApp();
+
+	return 0;
+}
@@ -0,0 +1,8 @@
+#ifndef __EXAMPLE__MEMCACHED__MAIN__H__
+#define __EXAMPLE__MEMCACHED__MAIN__H__
+
+
+#include "example.h"
+
+
+#endif // __EXAMPLE__MEMCACHED__MAIN__H__
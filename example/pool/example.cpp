@@ -0,0 +1,59 @@
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 测试
+ *
+ */
+
+
+#include "example.h"
+
+
+// 替换全局 operator new, 统计内存申请次数
+static std::atomic<std::size_t> allocationCount{ 0 };
+
+
+std::size_t AllocationCount()
+{
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+void * operator new(std::size_t size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+	void * pointer = malloc(size == 0 ? 1 : size);
+
+	if (pointer == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+
+	return pointer;
+}
+
+void * operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void * pointer) noexcept
+{
+	free(pointer);
+}
+
+void operator delete[](void * pointer) noexcept
+{
+	free(pointer);
+}
+
+void operator delete(void * pointer, std::size_t) noexcept
+{
+	free(pointer);
+}
+
+void operator delete[](void * pointer, std::size_t) noexcept
+{
+	free(pointer);
+}
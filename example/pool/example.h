@@ -0,0 +1,1132 @@
+#ifndef __EXAMPLE__POOL__EXAMPLE__H__
+#define __EXAMPLE__POOL__EXAMPLE__H__
+
+
+#include <tinyCore/tinyCore.h>
+
+
+using namespace tinyCore::pool;
+
+
+std::size_t AllocationCount();
+
+
+class Example
+{
+	static const std::size_t WINDOW_SIZE = 1024;
+	static const std::size_t CHUNK_SIZE = 4096;
+
+	struct Chunk
+	{
+		std::vector<uint8_t> data;
+
+		uint64_t hash{ 0 };
+
+		std::size_t compressed{ 0 };
+	};
+
+public:
+	static void Test(const std::size_t count = 1000000, const std::size_t threadCount = 4)
+	{
+		Steal(count, threadCount);
+		Post(count, threadCount);
+		Parallel(count, threadCount);
+		Graph(count, threadCount);
+		Lane(count, threadCount);
+		Affinity(count, threadCount);
+		Metrics(count, threadCount);
+		Elastic(count, threadCount);
+		Schedule(count, threadCount);
+
+	#if defined(TINY_CORE_COROUTINE)
+
+		Coroutine(count, threadCount);
+
+	#endif
+	}
+
+	static void Steal(const std::size_t count = 1000000, const std::size_t threadCount = 4)
+	{
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Shared queue vs work stealing, up to " << threadCount << " threads, " << count << " empty tasks" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		// 树形派生的层数, 总任务数与 count 接近
+		std::size_t depth = 0;
+
+		while ((std::size_t(4) << depth) <= count)
+		{
+			++depth;
+		}
+
+		for (std::size_t thread = 1; thread <= threadCount; thread *= 2)
+		{
+			double sharedExternal = External(ThreadPool::MODE::SHARED_QUEUE, thread, count);
+			double stealExternal  = External(ThreadPool::MODE::WORK_STEALING, thread, count);
+
+			double sharedFanOut = FanOut(ThreadPool::MODE::SHARED_QUEUE, thread, depth);
+			double stealFanOut  = FanOut(ThreadPool::MODE::WORK_STEALING, thread, depth);
+
+			std::cout << "threads " << thread << std::endl;
+			std::cout << "  external shared : " << TINY_STR_TO_LOCAL(sharedExternal) << " tasks/sec" << std::endl;
+			std::cout << "  external steal  : " << TINY_STR_TO_LOCAL(stealExternal) << " tasks/sec" << std::endl;
+			std::cout << "  fan-out  shared : " << TINY_STR_TO_LOCAL(sharedFanOut) << " tasks/sec" << std::endl;
+			std::cout << "  fan-out  steal  : " << TINY_STR_TO_LOCAL(stealFanOut) << " tasks/sec" << std::endl << std::endl;
+		}
+	}
+
+	static void Post(const std::size_t count = 1000000, const std::size_t threadCount = 4)
+	{
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Task submission allocations, " << threadCount << " threads, " << count << " tasks" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		for (auto mode : { ThreadPool::MODE::SHARED_QUEUE, ThreadPool::MODE::WORK_STEALING })
+		{
+			ThreadPool pool;
+
+			pool.Launch(threadCount, mode);
+
+			std::atomic<std::size_t> done{ 0 };
+
+			std::vector<std::future<void>> futures;
+
+			futures.reserve(WINDOW_SIZE);
+
+			auto task = [&done]() { done.fetch_add(1, std::memory_order_release); };
+
+			// 旧的提交方式: packaged_task + shared_ptr + std::function
+			auto legacy = [&]()
+			{
+				auto packaged = std::make_shared<std::packaged_task<void()>>(task);
+
+				std::function<void()> function = [packaged]() { (*packaged)(); };
+
+				pool.Post(std::move(function));
+			};
+
+			auto post   = [&]() { pool.Post(task); };
+			auto commit = [&]() { pool.Commit(task); };
+			// 每提交一批等待一次, 模拟请求-响应式的使用方式
+			auto future = [&]()
+			{
+				futures.push_back(pool.Commit(task));
+
+				if (futures.size() == WINDOW_SIZE)
+				{
+					for (auto &iter : futures)
+					{
+						iter.get();
+					}
+
+					futures.clear();
+				}
+			};
+
+			std::cout << (mode == ThreadPool::MODE::SHARED_QUEUE ? "shared queue" : "work stealing") << std::endl;
+
+			Submit("legacy commit", done, count, legacy);
+			Submit("post", done, count, post);
+			Submit("commit", done, count, commit);
+			Submit("commit + get", done, count, future);
+
+			for (auto &iter : futures)
+			{
+				iter.get();
+			}
+
+			std::cout << std::endl;
+		}
+	}
+
+	static void Parallel(const std::size_t count = 1000000, const std::size_t threadCount = 4)
+	{
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Parallel for / reduce / sort, up to " << threadCount << " threads, " << count << " elements" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		std::vector<double> input(count);
+		std::vector<double> output(count);
+
+		std::vector<uint64_t> keys(count);
+
+		std::mt19937_64 random(0x5EED);
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			input[i] = static_cast<double>(i);
+			keys[i]  = random();
+		}
+
+		double serialFor    = 0.0;
+		double serialReduce = 0.0;
+		double serialSort   = 0.0;
+
+		{
+			auto start = TINY_TIME_STEADY_POINT();
+
+			std::transform(input.begin(), input.end(), output.begin(), [](double value) { return std::sqrt(value) * std::sin(value); });
+
+			auto middle = TINY_TIME_STEADY_POINT();
+
+			volatile double sum = std::accumulate(output.begin(), output.end(), 0.0);
+
+			(void)sum;
+
+			auto sorted = keys;
+
+			auto stop = TINY_TIME_STEADY_POINT();
+
+			std::sort(sorted.begin(), sorted.end());
+
+			auto end = TINY_TIME_STEADY_POINT();
+
+			serialFor    = TINY_TIME_DOUBLE(middle - start);
+			serialReduce = TINY_TIME_DOUBLE(stop - middle);
+			serialSort   = TINY_TIME_DOUBLE(end - stop);
+
+			std::cout << "serial   : transform " << serialFor * 1000 << " ms, reduce " << serialReduce * 1000 << " ms, sort " << serialSort * 1000 << " ms" << std::endl;
+		}
+
+		// 数据量很小时耗时可能为0, 不计算加速比
+		auto speedup = [](double serial, double parallel)
+		{
+			std::ostringstream stream;
+
+			if (parallel > 0.0)
+			{
+				stream << "x" << serial / parallel;
+			}
+			else
+			{
+				stream << "x-";
+			}
+
+			return stream.str();
+		};
+
+		std::vector<std::size_t> threads;
+
+		for (std::size_t thread = 1; thread < threadCount; thread *= 2)
+		{
+			threads.push_back(thread);
+		}
+
+		threads.push_back(threadCount);
+
+		for (auto thread : threads)
+		{
+			// 调用线程也参与计算, 工作线程少启动一个
+			ThreadPool pool;
+
+			pool.Launch(thread - 1, ThreadPool::MODE::WORK_STEALING);
+
+			auto start = TINY_TIME_STEADY_POINT();
+
+			tinyCore::pool::Parallel::Transform(pool, input.begin(), input.end(), output.begin(), [](double value) { return std::sqrt(value) * std::sin(value); });
+
+			auto middle = TINY_TIME_STEADY_POINT();
+
+			volatile double sum = tinyCore::pool::Parallel::Reduce(pool, std::size_t(0), count, 0, 0.0, [&output](std::size_t i) { return output[i]; }, std::plus<double>());
+
+			(void)sum;
+
+			auto sorted = keys;
+
+			auto stop = TINY_TIME_STEADY_POINT();
+
+			tinyCore::pool::Parallel::Sort(pool, sorted.begin(), sorted.end());
+
+			auto end = TINY_TIME_STEADY_POINT();
+
+			std::cout << "threads " << std::setw(2) << thread
+					  << " : transform " << TINY_TIME_DOUBLE(middle - start) * 1000 << " ms (" << speedup(serialFor, TINY_TIME_DOUBLE(middle - start)) << ")"
+					  << ", reduce " << TINY_TIME_DOUBLE(stop - middle) * 1000 << " ms (" << speedup(serialReduce, TINY_TIME_DOUBLE(stop - middle)) << ")"
+					  << ", sort " << TINY_TIME_DOUBLE(end - stop) * 1000 << " ms (" << speedup(serialSort, TINY_TIME_DOUBLE(end - stop)) << ")"
+					  << (std::is_sorted(sorted.begin(), sorted.end()) ? "" : " unsorted!") << std::endl;
+		}
+	}
+
+	static void Graph(const std::size_t count = 1000000, const std::size_t threadCount = 4)
+	{
+		// 每块 4KB, 块数与 count 成比例
+		std::size_t chunkCount = std::max<std::size_t>(count / 100, 64);
+
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "parse -> hash -> compress -> write pipeline, up to " << threadCount << " threads, " << chunkCount << " chunks" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		for (std::size_t thread = 1; thread <= threadCount; thread *= 2)
+		{
+			ThreadPool pool;
+
+			pool.Launch(thread);
+
+			std::vector<Chunk> chunks(chunkCount);
+
+			std::atomic<std::size_t> written{ 0 };
+
+			// 每个阶段提交为一个任务, 在任务内阻塞等待上一阶段的 future, 等待期间占用工作线程
+			auto blocking = [&]()
+			{
+				std::vector<std::future<void>> futures;
+
+				futures.reserve(chunkCount);
+
+				for (std::size_t i = 0; i < chunkCount; ++i)
+				{
+					auto parse    = pool.Commit([&chunks, i]() { Parse(chunks[i], i); }).share();
+					auto hash     = pool.Commit([&chunks, i, parse]() { parse.get(); Hash(chunks[i]); }).share();
+					auto compress = pool.Commit([&chunks, i, hash]() { hash.get(); Compress(chunks[i]); }).share();
+
+					futures.push_back(pool.Commit([&chunks, &written, i, compress]() { compress.get(); written.fetch_add(chunks[i].compressed); }));
+				}
+
+				for (auto &iter : futures)
+				{
+					iter.get();
+				}
+			};
+
+			// 上一阶段完成后才投递下一阶段, 工作线程不阻塞
+			auto then = [&]()
+			{
+				std::vector<Future<void>> futures;
+
+				futures.reserve(chunkCount);
+
+				for (std::size_t i = 0; i < chunkCount; ++i)
+				{
+					futures.push_back
+					(
+						pool.Async([&chunks, i]() { Parse(chunks[i], i); })
+							.Then(pool, [&chunks, i]() { Hash(chunks[i]); })
+							.Then(pool, [&chunks, i]() { Compress(chunks[i]); })
+							.Then(pool, [&chunks, &written, i]() { written.fetch_add(chunks[i].compressed); })
+					);
+				}
+
+				for (auto &iter : futures)
+				{
+					iter.Get();
+				}
+			};
+
+			auto graph = [&]()
+			{
+				TaskGraph taskGraph;
+
+				for (std::size_t i = 0; i < chunkCount; ++i)
+				{
+					auto parse    = taskGraph.Add([&chunks, i]() { Parse(chunks[i], i); });
+					auto hash     = taskGraph.Add([&chunks, i]() { Hash(chunks[i]); }, { parse });
+					auto compress = taskGraph.Add([&chunks, i]() { Compress(chunks[i]); }, { hash });
+
+					taskGraph.Add([&chunks, &written, i]() { written.fetch_add(chunks[i].compressed); }, { compress });
+				}
+
+				taskGraph.Run(pool).Get();
+			};
+
+			std::cout << "threads " << thread << std::endl;
+
+			Pipeline("blocking get", chunkCount, written, blocking);
+			Pipeline("then", chunkCount, written, then);
+			Pipeline("task graph", chunkCount, written, graph);
+
+			std::cout << std::endl;
+		}
+	}
+
+	static void Lane(const std::size_t count = 1000000, const std::size_t threadCount = 4)
+	{
+		// 后台任务每个约 20us, 积压量与 count 成比例
+		std::size_t bulkCount   = std::max<std::size_t>(count / 100, 1000);
+		std::size_t urgentCount = 200;
+
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Urgent latency behind " << bulkCount << " bulk tasks, " << threadCount << " threads, " << urgentCount << " urgent tasks" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		const char * names[] = { "single fifo", "weighted 16:1", "weighted + edf" };
+
+		for (std::size_t variant = 0; variant < 3; ++variant)
+		{
+			ThreadPool pool;
+
+			std::size_t urgent = 0;
+
+			if (variant > 0)
+			{
+				urgent = pool.AddLane(16, variant == 2 ? ThreadPool::ORDER::DEADLINE : ThreadPool::ORDER::FIFO);
+			}
+
+			pool.Launch(threadCount);
+
+			for (std::size_t i = 0; i < bulkCount; ++i)
+			{
+				pool.Post([]() { Spin(std::chrono::microseconds(20)); });
+			}
+
+			std::vector<double> latency(urgentCount);
+
+			std::atomic<std::size_t> done{ 0 };
+
+			for (std::size_t i = 0; i < urgentCount; ++i)
+			{
+				auto submit = TINY_TIME_STEADY_POINT();
+
+				// 一半请求的截止时间紧, 只在 EDF 通道中影响顺序
+				auto deadline = submit + (i % 2 ? std::chrono::milliseconds(50) : std::chrono::milliseconds(1));
+
+				pool.PostTo
+				(
+					{ urgent, deadline }, [&latency, &done, i, submit]()
+					{
+						latency[i] = TINY_TIME_DOUBLE(TINY_TIME_STEADY_POINT() - submit);
+
+						done.fetch_add(1, std::memory_order_release);
+					}
+				);
+
+				std::this_thread::sleep_for(std::chrono::microseconds(100));
+			}
+
+			Wait(done, urgentCount);
+
+			std::sort(latency.begin(), latency.end());
+
+			std::cout << std::left << std::setw(16) << names[variant]
+					  << ": urgent p50 " << latency[urgentCount / 2] * 1000 << " ms, p99 " << latency[urgentCount * 99 / 100] * 1000 << " ms" << std::endl;
+
+			for (auto &iter : pool.LaneStatistics())
+			{
+				std::cout << "  lane weight " << std::setw(3) << iter.weight
+						  << " depth " << std::setw(8) << iter.depth
+						  << " dequeued " << std::setw(8) << iter.dequeued
+						  << " avg wait " << (iter.dequeued ? TINY_TIME_DOUBLE(iter.totalWait) / iter.dequeued * 1000 : 0.0) << " ms"
+						  << " max wait " << TINY_TIME_DOUBLE(iter.maxWait) * 1000 << " ms" << std::endl;
+			}
+
+			std::cout << std::endl;
+		}
+	}
+
+	static void Affinity(const std::size_t count = 1000000, const std::size_t threadCount = 4)
+	{
+		// 每个线程扫描自己的缓冲区, 大小远超缓存, 受内存带宽与访问延迟限制
+		std::size_t elements = std::max<std::size_t>(count * 2, 1 << 20);
+		std::size_t passes   = 8;
+
+		auto nodes = tinyCore::thread::Topology::Nodes();
+
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Memory-bound scan, " << threadCount << " threads, " << elements * sizeof(uint64_t) / (1 << 20) << " MB per thread, " << nodes.size() << " NUMA nodes" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		for (auto node : nodes)
+		{
+			std::cout << "node " << node << " : " << tinyCore::thread::Topology::Cpus(node).size() << " cpus" << std::endl;
+		}
+
+		if (nodes.size() == 1)
+		{
+			std::cout << "single node, the layout below is simulated and both runs should be close" << std::endl;
+		}
+
+		std::cout << std::endl;
+
+		// 默认: 不绑核, 缓冲区由启动线程分配并首次写入
+		{
+			ThreadPool pool;
+
+			pool.Launch(threadCount);
+
+			std::vector<std::vector<uint64_t>> buffers(threadCount, std::vector<uint64_t>(elements, 1));
+
+			double seconds = Scan(pool, threadCount, passes, [&buffers](const std::size_t index) -> std::vector<uint64_t> & { return buffers[index]; });
+
+			std::cout << "  default        : " << elements * sizeof(uint64_t) * passes * threadCount / seconds / (1 << 30) << " GB/s" << std::endl;
+		}
+
+		// 线程轮流分到各节点, 在节点内依次绑定单个 CPU, 缓冲区由工作线程自己分配, 落在本节点
+		{
+			ThreadPool::LaunchOption option;
+
+			option.name = "scan";
+
+			for (std::size_t i = 0; i < threadCount; ++i)
+			{
+				auto node = nodes[i % nodes.size()];
+				auto cpus = tinyCore::thread::Topology::Cpus(node);
+
+				option.nodes.push_back(static_cast<int>(node));
+				option.cpus.push_back({ cpus[(i / nodes.size()) % cpus.size()] });
+			}
+
+			ThreadPool pool;
+
+			pool.Launch(threadCount, option);
+
+			std::vector<std::vector<uint64_t>> buffers(threadCount);
+
+			double seconds = Scan(pool, threadCount, passes, [&buffers, elements](const std::size_t index) -> std::vector<uint64_t> &
+			{
+				if (buffers[index].empty())
+				{
+					buffers[index].assign(elements, 1);
+				}
+
+				return buffers[index];
+			});
+
+			std::cout << "  pinned + local : " << elements * sizeof(uint64_t) * passes * threadCount / seconds / (1 << 30) << " GB/s" << std::endl;
+		}
+	}
+
+	static void Metrics(const std::size_t count = 1000000, const std::size_t threadCount = 4)
+	{
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Task metrics overhead, " << threadCount << " threads, " << count << " tasks" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		// 抽样任务路径上额外的工作: 三次读取时钟, 一次记录
+		{
+			tinyCore::pool::MetricsRecorder recorder;
+
+			tinyCore::pool::Cycle::Nanosecond();
+
+			uint64_t stamp = tinyCore::pool::Cycle::Now();
+
+			auto start = TINY_TIME_STEADY_POINT();
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				uint64_t begin = tinyCore::pool::Cycle::Now();
+				uint64_t end   = tinyCore::pool::Cycle::Now();
+
+				recorder.Record(i % 2, begin - stamp, end - begin);
+
+				stamp = tinyCore::pool::Cycle::Now();
+			}
+
+			std::cout << "  sampled path  : " << TINY_TIME_DOUBLE(TINY_TIME_STEADY_POINT() - start) * 1e9 / count << " ns/task" << std::endl;
+		}
+
+		for (auto mode : { ThreadPool::MODE::SHARED_QUEUE, ThreadPool::MODE::WORK_STEALING })
+		{
+			ThreadPool pool;
+
+			std::size_t tag = pool.AddTag("post");
+
+			pool.Launch(threadCount, mode);
+
+			std::atomic<std::size_t> done{ 0 };
+
+			ThreadPool::TaskOption option;
+
+			option.tag = tag;
+
+			// 停用, 每16个抽样一个, 全部计时
+			const std::size_t rates[] = { 0, 16, 1 };
+
+			double best[3] = { 1e9, 1e9, 1e9 };
+
+			// 交替运行, 各取最好的一次
+			for (std::size_t round = 0; round < 9; ++round)
+			{
+				std::size_t variant = round % 3;
+
+				if (rates[variant])
+				{
+					pool.EnableMetrics(rates[variant]);
+				}
+				else
+				{
+					pool.DisableMetrics();
+				}
+
+				done.store(0);
+
+				auto start = TINY_TIME_STEADY_POINT();
+
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					pool.PostTo(option, [&done]() { done.fetch_add(1, std::memory_order_release); });
+				}
+
+				Wait(done, count);
+
+				best[variant] = std::min(best[variant], TINY_TIME_DOUBLE(TINY_TIME_STEADY_POINT() - start) * 1e9 / count);
+			}
+
+			std::cout << (mode == ThreadPool::MODE::SHARED_QUEUE ? "shared queue" : "work stealing") << std::endl;
+			std::cout << "  disabled      : " << best[0] << " ns/task" << std::endl;
+			std::cout << "  sampled 1/16  : " << best[1] << " ns/task" << std::endl;
+			std::cout << "  every task    : " << best[2] << " ns/task" << std::endl;
+
+			pool.ResetMetrics();
+
+			pool.EnableMetrics();
+
+			pool.Metrics();
+
+			done.store(0);
+
+			for (std::size_t i = 0; i < count / 10; ++i)
+			{
+				pool.PostTo(option, [&done]() { done.fetch_add(1, std::memory_order_release); });
+			}
+
+			Wait(done, count / 10);
+
+			std::cout << pool.Metrics().ToString() << std::endl;
+		}
+	}
+
+	static void Schedule(const std::size_t count = 1000000, const std::size_t threadCount = 4)
+	{
+		// 每个周期任务做约100us的工作, 模拟刷新缓存或落地统计
+		std::size_t jobCount = std::max<std::size_t>(count / 20000, threadCount * 8);
+
+		auto period   = std::chrono::milliseconds(20);
+		auto duration = std::chrono::seconds(1);
+
+		std::size_t expect = static_cast<std::size_t>(duration / period);
+
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << jobCount << " periodic jobs, period 20 ms, 100 us work, run 1 s, " << threadCount << " pool threads" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		// 旧方式: 每个任务一个线程, 执行后 sleep 一个周期, 每次的执行时间与唤醒延迟累积成漂移
+		{
+			std::atomic<bool> isStop{ false };
+
+			std::vector<std::size_t> ticks(jobCount, 0);
+
+			std::vector<double> lag(jobCount, 0.0);
+
+			std::vector<std::thread> threads;
+
+			auto start = TINY_TIME_STEADY_POINT();
+
+			for (std::size_t i = 0; i < jobCount; ++i)
+			{
+				threads.emplace_back
+				(
+					[&, i]()
+					{
+						while (!isStop.load())
+						{
+							std::this_thread::sleep_for(period);
+
+							if (isStop.load())
+							{
+								break;
+							}
+
+							++ticks[i];
+
+							lag[i] = TINY_TIME_DOUBLE(TINY_TIME_STEADY_POINT() - (start + period * static_cast<int64_t>(ticks[i])));
+
+							Spin(std::chrono::microseconds(100));
+						}
+					}
+				);
+			}
+
+			std::this_thread::sleep_for(duration + period / 2);
+
+			isStop.store(true);
+
+			for (auto &iter : threads)
+			{
+				iter.join();
+			}
+
+			Report("sleeping threads", jobCount, expect, ticks, lag);
+		}
+
+		// 一个定时线程 + 线程池
+		{
+			ThreadPool pool;
+
+			pool.Launch(threadCount);
+
+			std::vector<std::size_t> ticks(jobCount, 0);
+
+			std::vector<double> lag(jobCount, 0.0);
+
+			std::vector<tinyCore::pool::TimerHandle> handles;
+
+			auto start = TINY_TIME_STEADY_POINT();
+
+			for (std::size_t i = 0; i < jobCount; ++i)
+			{
+				handles.push_back
+				(
+					pool.ScheduleEvery
+					(
+						period, [&, i]()
+						{
+							++ticks[i];
+
+							lag[i] = TINY_TIME_DOUBLE(TINY_TIME_STEADY_POINT() - (start + period * static_cast<int64_t>(ticks[i])));
+
+							Spin(std::chrono::microseconds(100));
+						}
+					)
+				);
+			}
+
+			std::this_thread::sleep_for(duration + period / 2);
+
+			for (auto &iter : handles)
+			{
+				iter.Cancel();
+			}
+
+			while (pool.IsWork())
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+
+			Report("schedule every", threadCount + 1, expect, ticks, lag);
+		}
+	}
+
+	static void Elastic(const std::size_t count = 1000000, const std::size_t threadCount = 4)
+	{
+		// 突发的阻塞任务 (模拟 IO) 占满固定线程, 后面的计算任务只能排队
+		std::size_t blockCount = threadCount * 4;
+		std::size_t spinCount  = std::max<std::size_t>(count / 10000, 100);
+
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Burst of " << blockCount << " blocking 50 ms tasks then " << spinCount << " cpu 1 ms tasks, " << threadCount << " threads" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		for (std::size_t variant = 0; variant < 2; ++variant)
+		{
+			ThreadPool pool;
+
+			ThreadPool::ElasticOption option;
+
+			option.minSize   = threadCount;
+			option.maxSize   = threadCount * 8;
+			option.keepAlive = std::chrono::milliseconds(200);
+
+			if (variant == 0)
+			{
+				pool.Launch(threadCount);
+			}
+			else
+			{
+				pool.LaunchElastic(option);
+			}
+
+			std::atomic<std::size_t> done{ 0 };
+
+			auto start = TINY_TIME_STEADY_POINT();
+
+			for (std::size_t i = 0; i < blockCount; ++i)
+			{
+				pool.Post([&done]() { std::this_thread::sleep_for(std::chrono::milliseconds(50)); done.fetch_add(1, std::memory_order_release); });
+			}
+
+			for (std::size_t i = 0; i < spinCount; ++i)
+			{
+				pool.Post([&done]() { Spin(std::chrono::milliseconds(1)); done.fetch_add(1, std::memory_order_release); });
+			}
+
+			std::size_t peak = 0;
+
+			while (done.load(std::memory_order_acquire) < blockCount + spinCount)
+			{
+				peak = std::max(peak, pool.ThreadCount());
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+
+			double seconds = TINY_TIME_DOUBLE(TINY_TIME_STEADY_POINT() - start);
+
+			std::cout << std::left << std::setw(8) << (variant == 0 ? "fixed" : "elastic")
+					  << ": " << seconds * 1000 << " ms, peak threads " << peak << std::endl;
+
+			if (variant == 1)
+			{
+				// 空闲超过 keepAlive 后回落到下限
+				std::this_thread::sleep_for(option.keepAlive * 2 + option.cooldown * static_cast<int64_t>(option.maxSize));
+
+				std::cout << "  after idle threads " << pool.ThreadCount() << ", spawned " << pool.SpawnCount() << ", retired " << pool.RetireCount() << std::endl;
+			}
+		}
+	}
+
+#if defined(TINY_CORE_COROUTINE)
+
+	static void Coroutine(const std::size_t count = 1000000, const std::size_t threadCount = 4)
+	{
+		// 每次切换都要往返线程池, 次数取 count 的十分之一
+		std::size_t hops = std::max<std::size_t>(count / 10, 1000);
+
+		std::cout << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << "Blocking future vs coroutine switch cost, " << threadCount << " threads, " << hops << " hops" << std::endl;
+		std::cout << "*******************************************************************************" << std::endl;
+		std::cout << std::endl;
+
+		for (auto mode : { ThreadPool::MODE::SHARED_QUEUE, ThreadPool::MODE::WORK_STEALING })
+		{
+			ThreadPool pool;
+
+			pool.Launch(threadCount, mode);
+
+			std::cout << (mode == ThreadPool::MODE::SHARED_QUEUE ? "shared queue" : "work stealing") << std::endl;
+
+			// 调用线程提交后阻塞等待
+			Hop
+			(
+				"commit + get", hops, [&]()
+				{
+					std::size_t sum = 0;
+
+					for (std::size_t i = 0; i < hops; ++i)
+					{
+						sum += pool.Commit([i]() { return i; }).get();
+					}
+
+					return sum;
+				}
+			);
+
+			// 协程挂起等待, 在完成任务的工作线程上恢复
+			Hop
+			(
+				"co_await async", hops, [&]()
+				{
+					return tinyCore::coroutine::Spawn(AwaitAsync(pool, hops)).Get();
+				}
+			);
+
+			// 协程每次把自身重新投递到线程池
+			Hop
+			(
+				"co_await yield", hops, [&]()
+				{
+					return tinyCore::coroutine::Spawn(AwaitSchedule(pool, hops)).Get();
+				}
+			);
+
+			std::cout << std::endl;
+		}
+	}
+
+#endif
+
+protected:
+#if defined(TINY_CORE_COROUTINE)
+
+	static tinyCore::coroutine::Task<std::size_t> AwaitAsync(ThreadPool & pool, const std::size_t hops)
+	{
+		std::size_t sum = 0;
+
+		for (std::size_t i = 0; i < hops; ++i)
+		{
+			sum += co_await pool.Async([i]() { return i; });
+		}
+
+		co_return sum;
+	}
+
+	static tinyCore::coroutine::Task<std::size_t> AwaitSchedule(ThreadPool & pool, const std::size_t hops)
+	{
+		std::size_t sum = 0;
+
+		for (std::size_t i = 0; i < hops; ++i)
+		{
+			co_await pool.Schedule();
+
+			sum += i;
+		}
+
+		co_return sum;
+	}
+
+	template <typename RunT>
+	static void Hop(const char * name, const std::size_t hops, RunT && run)
+	{
+		// 单次切换只有微秒级, 用单调时钟计时
+		auto start = TINY_TIME_STEADY_POINT();
+
+		std::size_t sum = run();
+
+		auto stop = TINY_TIME_STEADY_POINT();
+
+		std::cout << "  " << std::left << std::setw(16) << name
+				  << ": " << TINY_TIME_DOUBLE(stop - start) * 1e9 / hops << " ns/hop"
+				  << (sum == hops * (hops - 1) / 2 ? "" : " wrong sum!") << std::endl;
+	}
+
+#endif
+
+	// 每个任务取得自己的缓冲区后扫描 passes 遍, 第一遍 (分配与首次写入) 不计时
+	template <typename BufferT>
+	static double Scan(ThreadPool & pool, const std::size_t taskCount, const std::size_t passes, BufferT && buffer)
+	{
+		std::atomic<std::size_t> ready{ 0 };
+		std::atomic<std::size_t> done{ 0 };
+		std::atomic<bool> isGo{ false };
+
+		std::atomic<uint64_t> sum{ 0 };
+
+		for (std::size_t i = 0; i < taskCount; ++i)
+		{
+			pool.Post
+			(
+				[&, i]()
+				{
+					auto & data = buffer(i);
+
+					ready.fetch_add(1);
+
+					while (!isGo.load())
+					{
+						std::this_thread::yield();
+					}
+
+					uint64_t local = 0;
+
+					for (std::size_t pass = 0; pass < passes; ++pass)
+					{
+						for (auto iter : data)
+						{
+							local += iter;
+						}
+					}
+
+					sum.fetch_add(local);
+
+					done.fetch_add(1, std::memory_order_release);
+				}
+			);
+		}
+
+		Wait(ready, taskCount);
+
+		auto start = TINY_TIME_STEADY_POINT();
+
+		isGo.store(true);
+
+		Wait(done, taskCount);
+
+		return TINY_TIME_DOUBLE(TINY_TIME_STEADY_POINT() - start);
+	}
+
+	static void Spin(const SteadyClockDuration & duration)
+	{
+		auto stop = TINY_TIME_STEADY_POINT() + duration;
+
+		while (TINY_TIME_STEADY_POINT() < stop)
+		{
+
+		}
+	}
+
+	static void Parse(Chunk & chunk, const std::size_t index)
+	{
+		chunk.data.resize(CHUNK_SIZE);
+
+		uint64_t state = index * 0x9E3779B97F4A7C15ull + 1;
+
+		for (auto &iter : chunk.data)
+		{
+			state ^= state << 13;
+			state ^= state >> 7;
+			state ^= state << 17;
+
+			// 取值范围小, 产生可压缩的重复
+			iter = static_cast<uint8_t>(state % 4);
+		}
+	}
+
+	static void Hash(Chunk & chunk)
+	{
+		uint64_t hash = 14695981039346656037ull;
+
+		for (auto iter : chunk.data)
+		{
+			hash = (hash ^ iter) * 1099511628211ull;
+		}
+
+		chunk.hash = hash;
+	}
+
+	// 游程编码后的字节数
+	static void Compress(Chunk & chunk)
+	{
+		std::size_t size = 0;
+
+		for (std::size_t i = 0; i < chunk.data.size(); ++size)
+		{
+			std::size_t j = i + 1;
+
+			while (j < chunk.data.size() && j - i < 255 && chunk.data[j] == chunk.data[i])
+			{
+				++j;
+			}
+
+			i = j;
+		}
+
+		chunk.compressed = size * 2;
+	}
+
+	template <typename RunT>
+	static void Pipeline(const char * name, const std::size_t chunkCount, std::atomic<std::size_t> & written, RunT && run)
+	{
+		written.store(0);
+
+		auto start = TINY_TIME_POINT();
+
+		run();
+
+		auto stop = TINY_TIME_POINT();
+
+		std::cout << "  " << std::left << std::setw(14) << name
+				  << ": " << TINY_STR_TO_LOCAL(chunkCount / TINY_TIME_DOUBLE(stop - start)) << " chunks/sec, "
+				  << written.load() << " bytes written" << std::endl;
+	}
+
+	// 先预热一轮填充内存池, 再统计第二轮
+	template <typename SubmitT>
+	static void Submit(const char * name, std::atomic<std::size_t> & done, const std::size_t count, SubmitT && submit)
+	{
+		for (std::size_t round = 0; round < 2; ++round)
+		{
+			done.store(0);
+
+			std::size_t allocation = AllocationCount();
+
+			auto start = TINY_TIME_POINT();
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				submit();
+			}
+
+			Wait(done, count);
+
+			auto stop = TINY_TIME_POINT();
+
+			if (round == 1)
+			{
+				std::cout << "  " << std::left << std::setw(14) << name
+						  << ": " << TINY_STR_TO_LOCAL(count / TINY_TIME_DOUBLE(stop - start)) << " tasks/sec, "
+						  << static_cast<double>(AllocationCount() - allocation) / count << " allocations/task" << std::endl;
+			}
+		}
+	}
+
+	static void Report(const char * name, const std::size_t threadCount, const std::size_t expect, const std::vector<std::size_t> & ticks, const std::vector<double> & lag)
+	{
+		std::size_t total = std::accumulate(ticks.begin(), ticks.end(), static_cast<std::size_t>(0));
+
+		double maxLag = *std::max_element(lag.begin(), lag.end());
+
+		std::cout << "  " << std::left << std::setw(16) << name
+				  << ": " << std::setw(4) << threadCount << " threads, "
+				  << static_cast<double>(total) / ticks.size() << " / " << expect << " runs per job, "
+				  << "last run lag max " << maxLag * 1000 << " ms" << std::endl;
+	}
+
+	static void Wait(const std::atomic<std::size_t> & done, const std::size_t total)
+	{
+		while (done.load(std::memory_order_acquire) < total)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	// 外部线程逐个提交
+	static double External(const ThreadPool::MODE mode, const std::size_t threadCount, const std::size_t count)
+	{
+		ThreadPool pool;
+
+		pool.Launch(threadCount, mode);
+
+		std::atomic<std::size_t> done{ 0 };
+
+		auto start = TINY_TIME_POINT();
+
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			pool.Commit
+			(
+				[&done]()
+				{
+					done.fetch_add(1, std::memory_order_release);
+				}
+			);
+		}
+
+		Wait(done, count);
+
+		auto stop = TINY_TIME_POINT();
+
+		return count / TINY_TIME_DOUBLE(stop - start);
+	}
+
+	// 任务在工作线程内继续派生两个子任务
+	static double FanOut(const ThreadPool::MODE mode, const std::size_t threadCount, const std::size_t depth)
+	{
+		ThreadPool pool;
+
+		pool.Launch(threadCount, mode);
+
+		std::atomic<std::size_t> done{ 0 };
+
+		std::size_t total = (std::size_t(2) << depth) - 1;
+
+		auto start = TINY_TIME_POINT();
+
+		pool.Commit(Spawn, std::ref(pool), std::ref(done), depth);
+
+		Wait(done, total);
+
+		auto stop = TINY_TIME_POINT();
+
+		return total / TINY_TIME_DOUBLE(stop - start);
+	}
+
+	static void Spawn(ThreadPool & pool, std::atomic<std::size_t> & done, const std::size_t depth)
+	{
+		if (depth > 0)
+		{
+			pool.Commit(Spawn, std::ref(pool), std::ref(done), depth - 1);
+			pool.Commit(Spawn, std::ref(pool), std::ref(done), depth - 1);
+		}
+
+		done.fetch_add(1, std::memory_order_release);
+	}
+};
+
+
+#endif // __EXAMPLE__POOL__EXAMPLE__H__
@@ -0,0 +1,102 @@
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 主函数
+ *
+ */
+
+
+#include "main.h"
+
+
+void ParseOption(int argc, char const * argv[])
+{
+	TINY_OPTION_DEFINE("steal", "shared queue vs work stealing task throughput", "Steal options")
+	TINY_OPTION_DEFINE("post", "allocation-free post and pooled commit", "Post options")
+	TINY_OPTION_DEFINE("parallel", "parallel for / reduce / sort scaling", "Parallel options")
+	TINY_OPTION_DEFINE("graph", "blocking futures vs then continuations vs task graph", "Graph options")
+	TINY_OPTION_DEFINE("lane", "urgent latency with priority lanes behind bulk backlog", "Lane options")
+	TINY_OPTION_DEFINE("affinity", "memory-bound scan with default vs pinned node-local workers", "Affinity options")
+	TINY_OPTION_DEFINE("metrics", "task metrics overhead and snapshot", "Metrics options")
+	TINY_OPTION_DEFINE("elastic", "fixed vs elastic pool under a blocking burst", "Elastic options")
+	TINY_OPTION_DEFINE("schedule", "sleeping threads vs scheduled periodic tasks", "Schedule options")
+
+#if defined(TINY_CORE_COROUTINE)
+
+	TINY_OPTION_DEFINE("coroutine", "blocking future vs coroutine switch cost", "Coroutine options")
+
+#endif
+
+	TINY_OPTION_DEFINE_ARG("count",  "task count", "1000000")
+	TINY_OPTION_DEFINE_ARG("thread", "max thread count", "4")
+
+	TINY_OPTION_DEFINE_VERSION("2018-05-08")
+
+	TINY_OPTION_PARSE(argc, argv);
+}
+
+void StartApp()
+{
+	auto count  = TINY_STR_TO_DIGITAL(std::size_t, TINY_OPTION_GET("count"));
+	auto thread = TINY_STR_TO_DIGITAL(std::size_t, TINY_OPTION_GET("thread"));
+
+	if (TINY_OPTION_HAS("steal"))
+	{
+		Example::Steal(count, thread);
+	}
+	else if (TINY_OPTION_HAS("post"))
+	{
+		Example::Post(count, thread);
+	}
+	else if (TINY_OPTION_HAS("parallel"))
+	{
+		Example::Parallel(count, thread);
+	}
+	else if (TINY_OPTION_HAS("graph"))
+	{
+		Example::Graph(count, thread);
+	}
+	else if (TINY_OPTION_HAS("lane"))
+	{
+		Example::Lane(count, thread);
+	}
+	else if (TINY_OPTION_HAS("affinity"))
+	{
+		Example::Affinity(count, thread);
+	}
+	else if (TINY_OPTION_HAS("metrics"))
+	{
+		Example::Metrics(count, thread);
+	}
+	else if (TINY_OPTION_HAS("elastic"))
+	{
+		Example::Elastic(count, thread);
+	}
+	else if (TINY_OPTION_HAS("schedule"))
+	{
+		Example::Schedule(count, thread);
+	}
+
+#if defined(TINY_CORE_COROUTINE)
+
+	else if (TINY_OPTION_HAS("coroutine"))
+	{
+		Example::Coroutine(count, thread);
+	}
+
+#endif
+	else
+	{
+		Example::Test(count, thread);
+	}
+}
+
+int main(int argc, char const * argv[])
+{
+	ParseOption(argc, argv);
+
+	StartApp();
+
+	return 0;
+}
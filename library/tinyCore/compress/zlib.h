@@ -235,6 +235,16 @@ namespace tinyCore
 				return retVal;
 			}
 
+			template <typename ValueT>
+			static ValueT Compress(const Byte * data, const std::size_t len, const int32_t level = ZLIB_DEFAULT_COMPRESSION)
+			{
+				ValueT retVal = { };
+
+				Compress(retVal, data, len, level);
+
+				return retVal;
+			}
+
 			template <typename ValueT>
 			static ValueT Decompress(const char * data, const int32_t wBits = ZLIB_MAX_WBITS)
 			{
@@ -267,6 +277,16 @@ namespace tinyCore
 				return retVal;
 			}
 
+			template <typename ValueT>
+			static ValueT Decompress(const Byte * data, const std::size_t len, const int32_t wBits = ZLIB_MAX_WBITS)
+			{
+				ValueT retVal = { };
+
+				Decompress(retVal, data, len, wBits);
+
+				return retVal;
+			}
+
 		protected:
 			template <typename ValueT>
 			static void Compress(ValueT & retVal, const Byte * data, const std::size_t len, const int32_t level)
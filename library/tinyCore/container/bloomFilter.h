@@ -0,0 +1,310 @@
+#ifndef __TINY_CORE__CONTAINER__BLOOM_FILTER__H__
+#define __TINY_CORE__CONTAINER__BLOOM_FILTER__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 分块布隆过滤器
+ *
+ *  每个键只落在一个32字节的块内 (不跨缓存行), 块由8个32位字组成, 每个字置1位,
+ *  8个位置由同一个32位哈希分别乘8个奇数常量得到, 支持AVX2时一条指令完成全部8个字的计算与判断
+ *
+ *  返回false表示一定不存在, 返回true表示可能存在
+ *
+ *  可以保存到文件, 加载时直接映射文件 (写时复制), 无需解析
+ *
+ *  并发查询是安全的, 插入需要外部同步
+ *
+ */
+
+
+#if defined(__AVX2__)
+#
+#  include <immintrin.h>
+#
+#endif
+
+#include <tinyCore/system/mappedFile.h>
+
+
+namespace tinyCore
+{
+	namespace container
+	{
+		// 在std::hash基础上再混合一次, 避免整数恒等哈希导致分布不均
+		template <typename KeyT>
+		struct FilterHash
+		{
+			uint64_t operator() (const KeyT & key) const
+			{
+				uint64_t hash = static_cast<uint64_t>(std::hash<KeyT>()(key));
+
+				hash ^= hash >> 33;
+				hash *= 0xFF51AFD7ED558CCDull;
+				hash ^= hash >> 33;
+				hash *= 0xC4CEB9FE1A85EC53ull;
+				hash ^= hash >> 33;
+
+				return hash;
+			}
+		};
+
+		template <typename KeyT, typename HashT = FilterHash<KeyT>>
+		class BloomFilter
+		{
+			static const uint32_t VERSION = 1;
+
+			struct alignas(32) Block
+			{
+				uint32_t word[8];
+			};
+
+			// 文件头64字节, 保证映射后块数据仍按缓存行对齐
+			struct Header
+			{
+				char magic[8];
+
+				uint32_t version;
+				uint32_t blockSize;
+
+				uint64_t blockCount;
+				uint64_t count;
+
+				uint8_t reserved[32];
+			};
+
+			static_assert(sizeof(Header) == 64, "header must be one cache line");
+
+			static constexpr uint32_t SALT[8] =
+			{
+				0x47B6137Bu, 0x44974D91u, 0x8824AD5Bu, 0xA2B7289Du,
+				0x705495C7u, 0x2DF1424Bu, 0x9EFC4947u, 0x5C6BFB31u,
+			};
+
+		public:
+			// bitsPerKey为10时误判率约1%
+			explicit BloomFilter(const std::size_t expectedCount, const double bitsPerKey = 10.0)
+			{
+				TINY_THROW_EXCEPTION_IF(bitsPerKey <= 0.0, debug::SizeError, "Bits Per Key Must Be Greater Than Zero")
+
+				auto bits = static_cast<double>(std::max<std::size_t>(expectedCount, 1)) * bitsPerKey;
+
+				_blockCount = std::max<std::size_t>(static_cast<std::size_t>(std::ceil(bits / (sizeof(Block) * 8))), 1);
+
+				TINY_THROW_EXCEPTION_IF(_blockCount > UINT32_MAX, debug::SizeError, "Too Many Blocks")
+
+				Allocate();
+			}
+
+			BloomFilter(BloomFilter && rhs) noexcept
+			{
+				Swap(rhs);
+			}
+
+			BloomFilter & operator=(BloomFilter && rhs) noexcept
+			{
+				if (this != &rhs)
+				{
+					Swap(rhs);
+				}
+
+				return *this;
+			}
+
+			~BloomFilter()
+			{
+				free(_buffer);
+			}
+
+			BloomFilter(const BloomFilter &) = delete;
+			BloomFilter & operator=(const BloomFilter &) = delete;
+
+			void Insert(const KeyT & key)
+			{
+				InsertHash(_hash(key));
+			}
+
+			bool Contains(const KeyT & key) const
+			{
+				return ContainsHash(_hash(key));
+			}
+
+			// 直接使用调用方计算好的64位哈希
+			void InsertHash(const uint64_t hash)
+			{
+				Block & block = _blocks[BlockIndex(hash)];
+
+				auto key = static_cast<uint32_t>(hash);
+
+			#if defined(__AVX2__)
+
+				auto * pointer = reinterpret_cast<__m256i *>(&block);
+
+				_mm256_store_si256(pointer, _mm256_or_si256(_mm256_load_si256(pointer), Mask(key)));
+
+			#else
+
+				for (std::size_t i = 0; i < 8; ++i)
+				{
+					block.word[i] |= uint32_t(1) << ((key * SALT[i]) >> 27);
+				}
+
+			#endif
+
+				++_count;
+			}
+
+			bool ContainsHash(const uint64_t hash) const
+			{
+				const Block & block = _blocks[BlockIndex(hash)];
+
+				auto key = static_cast<uint32_t>(hash);
+
+			#if defined(__AVX2__)
+
+				return _mm256_testc_si256(_mm256_load_si256(reinterpret_cast<const __m256i *>(&block)), Mask(key)) != 0;
+
+			#else
+
+				for (std::size_t i = 0; i < 8; ++i)
+				{
+					if ((block.word[i] & (uint32_t(1) << ((key * SALT[i]) >> 27))) == 0)
+					{
+						return false;
+					}
+				}
+
+				return true;
+
+			#endif
+			}
+
+			void Clear()
+			{
+				memset(_blocks, 0, _blockCount * sizeof(Block));
+
+				_count = 0;
+			}
+
+			// 插入次数, 重复插入会重复计数
+			std::size_t Count() const
+			{
+				return _count;
+			}
+
+			std::size_t BlockCount() const
+			{
+				return _blockCount;
+			}
+
+			std::size_t SizeInBytes() const
+			{
+				return _blockCount * sizeof(Block);
+			}
+
+			void Save(const std::string & path) const
+			{
+				Header header{ };
+
+				memcpy(header.magic, "TCBLOOM", 8);
+
+				header.version    = VERSION;
+				header.blockSize  = sizeof(Block);
+				header.blockCount = _blockCount;
+				header.count      = _count;
+
+				system::MappedFile::Write(path, { { &header, sizeof(Header) }, { _blocks, SizeInBytes() } });
+			}
+
+			// 映射文件后直接使用, 之后的插入只修改进程内的副本
+			static BloomFilter Load(const std::string & path)
+			{
+				BloomFilter filter;
+
+				filter._file.Open(path, system::MappedFile::MODE::COPY_ON_WRITE);
+
+				TINY_THROW_EXCEPTION_IF(filter._file.Size() < sizeof(Header), debug::FileError, TINY_STR_FORMAT("{} is not a bloom filter", path))
+
+				auto * header = reinterpret_cast<const Header *>(filter._file.Data());
+
+				TINY_THROW_EXCEPTION_IF(memcmp(header->magic, "TCBLOOM", 8) != 0 ||
+										header->version != VERSION ||
+										header->blockSize != sizeof(Block) ||
+										header->blockCount == 0 ||
+										filter._file.Size() != sizeof(Header) + header->blockCount * sizeof(Block),
+										debug::FileError, TINY_STR_FORMAT("{} is not a valid bloom filter", path))
+
+				filter._blockCount = header->blockCount;
+				filter._count      = header->count;
+				filter._blocks     = reinterpret_cast<Block *>(filter._file.Data() + sizeof(Header));
+
+				return filter;
+			}
+
+		protected:
+			BloomFilter() = default;
+
+			void Allocate()
+			{
+				_buffer = aligned_alloc(64, (SizeInBytes() + 63) / 64 * 64);
+
+				TINY_THROW_EXCEPTION_IF(_buffer == nullptr, debug::MemoryError, "Allocate Bloom Filter Failed")
+
+				_blocks = static_cast<Block *>(_buffer);
+
+				memset(_blocks, 0, SizeInBytes());
+			}
+
+			void Swap(BloomFilter & rhs)
+			{
+				std::swap(_hash, rhs._hash);
+				std::swap(_count, rhs._count);
+				std::swap(_blocks, rhs._blocks);
+				std::swap(_buffer, rhs._buffer);
+				std::swap(_blockCount, rhs._blockCount);
+
+				std::swap(_file, rhs._file);
+			}
+
+			// 高32位按乘法映射到块, 低32位用于块内定位
+			std::size_t BlockIndex(const uint64_t hash) const
+			{
+				return static_cast<std::size_t>(((hash >> 32) * _blockCount) >> 32);
+			}
+
+		#if defined(__AVX2__)
+
+			static __m256i Mask(const uint32_t key)
+			{
+				const __m256i salt = _mm256_setr_epi32
+				(
+					static_cast<int>(SALT[0]), static_cast<int>(SALT[1]), static_cast<int>(SALT[2]), static_cast<int>(SALT[3]),
+					static_cast<int>(SALT[4]), static_cast<int>(SALT[5]), static_cast<int>(SALT[6]), static_cast<int>(SALT[7])
+				);
+
+				__m256i shift = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(key)), salt), 27);
+
+				return _mm256_sllv_epi32(_mm256_set1_epi32(1), shift);
+			}
+
+		#endif
+
+		protected:
+			HashT _hash{ };
+
+			std::size_t _count{ 0 };
+			std::size_t _blockCount{ 0 };
+
+			Block * _blocks{ nullptr };
+
+			void * _buffer{ nullptr };
+
+			system::MappedFile _file{ };
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__CONTAINER__BLOOM_FILTER__H__
@@ -0,0 +1,640 @@
+#ifndef __TINY_CORE__CONTAINER__CACHE__H__
+#define __TINY_CORE__CONTAINER__CACHE__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 并发缓存 (W-TinyLFU)
+ *
+ *  按哈希值分片, 每个分片一把锁
+ *
+ *  新数据先进入窗口LRU (约1%容量), 被挤出窗口后与主区 (分段LRU, 考察段/保护段) 的淘汰者
+ *  比较访问频率 (count-min sketch 估计), 频率更高者留下, 以抵抗扫描型访问污染缓存
+ *
+ *  支持单条数据过期时间与按权重计算容量
+ *
+ */
+
+
+#include <tinyCore/debug/trace.h>
+#include <tinyCore/container/concurrentHashMap.h>
+
+
+namespace tinyCore
+{
+	namespace container
+	{
+		// 4行计数器的count-min sketch, 计数上限15, 累计增加到一定次数后全部减半以淘汰旧频率
+		class FrequencySketch
+		{
+		public:
+			explicit FrequencySketch(std::size_t capacity = 16)
+			{
+				std::size_t width = 16;
+
+				while (width < capacity)
+				{
+					width <<= 1;
+				}
+
+				_mask       = width - 1;
+				_sampleSize = width * 10;
+
+				_table.assign(width * 4, 0);
+			}
+
+			void Increment(uint64_t hash)
+			{
+				bool added = false;
+
+				for (std::size_t i = 0; i < 4; ++i)
+				{
+					uint8_t & counter = _table[Index(hash, i)];
+
+					if (counter < 15)
+					{
+						++counter;
+
+						added = true;
+					}
+				}
+
+				if (added && ++_additions >= _sampleSize)
+				{
+					Reset();
+				}
+			}
+
+			uint8_t Frequency(uint64_t hash) const
+			{
+				uint8_t frequency = 15;
+
+				for (std::size_t i = 0; i < 4; ++i)
+				{
+					frequency = std::min(frequency, _table[Index(hash, i)]);
+				}
+
+				return frequency;
+			}
+
+		protected:
+			std::size_t Index(uint64_t hash, std::size_t row) const
+			{
+				static const uint64_t SEEDS[4] = { 0xC3A5C85C97CB3127ull, 0xB492B66FBE98F273ull,
+												   0x9AE16A3B2F90404Full, 0xCBF29CE484222325ull };
+
+				uint64_t value = (hash + SEEDS[row]) * SEEDS[row];
+
+				value ^= value >> 32;
+
+				return row * (_mask + 1) + static_cast<std::size_t>(value & _mask);
+			}
+
+			void Reset()
+			{
+				for (auto &iter : _table)
+				{
+					iter >>= 1;
+				}
+
+				_additions /= 2;
+			}
+
+		protected:
+			std::size_t _mask{ 0 };
+			std::size_t _additions{ 0 };
+			std::size_t _sampleSize{ 0 };
+
+			std::vector<uint8_t> _table{ };
+		};
+
+		typedef struct CacheStatistics
+		{
+			uint64_t hit{ 0 };
+			uint64_t miss{ 0 };
+			uint64_t put{ 0 };
+			uint64_t expire{ 0 };
+			uint64_t evict{ 0 };
+			uint64_t getCount{ 0 };
+			uint64_t getNanoseconds{ 0 };
+
+			double HitRatio() const
+			{
+				return (hit + miss) == 0 ? 0.0 : static_cast<double>(hit) / static_cast<double>(hit + miss);
+			}
+
+			double AvgGetNanoseconds() const
+			{
+				return getCount == 0 ? 0.0 : static_cast<double>(getNanoseconds) / static_cast<double>(getCount);
+			}
+		}CacheStatistics;
+
+		template <typename KeyT, typename ValueT, typename HashT = ConcurrentHash<KeyT>>
+		class ConcurrentCache
+		{
+			enum class REGION : uint8_t
+			{
+				WINDOW,
+				PROBATION,
+				PROTECTED,
+			};
+
+			struct Entry
+			{
+				KeyT key;
+				ValueT value;
+
+				uint64_t hash;
+
+				std::size_t weight;
+
+				REGION region;
+
+				SteadyClockTimesPoint expire;
+			};
+
+			using EntryList = std::list<Entry>;
+			using EntryMap = std::unordered_map<KeyT, typename EntryList::iterator, HashT>;
+
+			struct alignas(64) Shard
+			{
+				explicit Shard(std::size_t capacity) : sketch(capacity)
+				{
+
+				}
+
+				std::mutex lock{ };
+
+				EntryMap map{ };
+
+				EntryList window{ };
+				EntryList probation{ };
+				EntryList protect{ };
+
+				std::size_t windowWeight{ 0 };
+				std::size_t probationWeight{ 0 };
+				std::size_t protectWeight{ 0 };
+
+				std::size_t windowCapacity{ 0 };
+				std::size_t mainCapacity{ 0 };
+				std::size_t protectCapacity{ 0 };
+
+				FrequencySketch sketch;
+
+				std::atomic<uint64_t> hit{ 0 };
+				std::atomic<uint64_t> miss{ 0 };
+				std::atomic<uint64_t> put{ 0 };
+				std::atomic<uint64_t> expire{ 0 };
+				std::atomic<uint64_t> evict{ 0 };
+				std::atomic<uint64_t> getCount{ 0 };
+				std::atomic<uint64_t> getNanoseconds{ 0 };
+			};
+
+		public:
+			// 容量小于分片数时, 分片数减为不超过容量的最大2的幂, 保证每个分片至少容纳1
+			explicit ConcurrentCache(std::size_t capacity, std::size_t shardCount = 16)
+			{
+				if ((shardCount < 1) || ((shardCount & (shardCount - 1)) != 0))
+				{
+					TINY_THROW_EXCEPTION(debug::SizeError, "Shard Count Must Be Power Of Two")
+				}
+
+				TINY_THROW_EXCEPTION_IF(capacity == 0, debug::SizeError, "Capacity Must Be Greater Than Zero")
+
+				while (shardCount > capacity)
+				{
+					shardCount >>= 1;
+				}
+
+				_shardMask = shardCount - 1;
+
+				for (std::size_t i = 0; i < shardCount; ++i)
+				{
+					std::size_t shardCapacity = capacity / shardCount + (i < capacity % shardCount ? 1 : 0);
+
+					auto shard = std::make_unique<Shard>(shardCapacity);
+
+					shard->windowCapacity  = std::max<std::size_t>(1, shardCapacity / 100);
+					shard->mainCapacity    = shardCapacity - shard->windowCapacity;
+					shard->protectCapacity = shard->mainCapacity * 8 / 10;
+
+					_shards.push_back(std::move(shard));
+				}
+			}
+
+			ConcurrentCache(const ConcurrentCache &) = delete;
+			ConcurrentCache & operator=(const ConcurrentCache &) = delete;
+
+			// 默认过期时间, 0表示不过期
+			void SetDefaultTTL(const SteadyClockDuration & ttl)
+			{
+				_defaultTTL = ttl;
+			}
+
+			// 记录Get耗时, 每次多两次取时钟的开销
+			void SetRecordLatency(bool record)
+			{
+				_recordLatency = record;
+			}
+
+			bool Get(const KeyT & key, ValueT & value)
+			{
+				SteadyClockTimesPoint start;
+
+				if (_recordLatency)
+				{
+					start = SteadyClock::now();
+				}
+
+				uint64_t hash = Hash(key);
+
+				Shard & shard = *_shards[hash & _shardMask];
+
+				bool found = false;
+
+				{
+					std::lock_guard<std::mutex> lock(shard.lock);
+
+					shard.sketch.Increment(hash);
+
+					auto iter = shard.map.find(key);
+
+					if (iter != shard.map.end())
+					{
+						auto entry = iter->second;
+
+						if (entry->expire != SteadyClockTimesPoint::max() && IsExpired(*entry, SteadyClock::now()))
+						{
+							Remove(shard, iter);
+
+							shard.expire.fetch_add(1, std::memory_order_relaxed);
+						}
+						else
+						{
+							value = entry->value;
+
+							OnAccess(shard, entry);
+
+							found = true;
+						}
+					}
+				}
+
+				(found ? shard.hit : shard.miss).fetch_add(1, std::memory_order_relaxed);
+
+				if (_recordLatency)
+				{
+					auto cost = std::chrono::duration_cast<std::chrono::nanoseconds>(SteadyClock::now() - start).count();
+
+					shard.getCount.fetch_add(1, std::memory_order_relaxed);
+					shard.getNanoseconds.fetch_add(static_cast<uint64_t>(cost), std::memory_order_relaxed);
+				}
+
+				return found;
+			}
+
+			template <typename ValueU>
+			void Put(const KeyT & key, ValueU && value, const SteadyClockDuration & ttl = SteadyClockDuration::zero(), std::size_t weight = 1)
+			{
+				uint64_t hash = Hash(key);
+
+				Shard & shard = *_shards[hash & _shardMask];
+
+				SteadyClockDuration life = ttl == SteadyClockDuration::zero() ? _defaultTTL : ttl;
+
+				SteadyClockTimesPoint expire = life == SteadyClockDuration::zero() ? SteadyClockTimesPoint::max()
+																				   : SteadyClock::now() + life;
+
+				std::lock_guard<std::mutex> lock(shard.lock);
+
+				shard.sketch.Increment(hash);
+
+				shard.put.fetch_add(1, std::memory_order_relaxed);
+
+				auto iter = shard.map.find(key);
+
+				if (iter != shard.map.end())
+				{
+					auto entry = iter->second;
+
+					RegionWeight(shard, entry->region) -= entry->weight;
+
+					entry->value  = std::forward<ValueU>(value);
+					entry->weight = weight;
+					entry->expire = expire;
+
+					RegionWeight(shard, entry->region) += entry->weight;
+
+					OnAccess(shard, entry);
+				}
+				else
+				{
+					shard.window.push_front(Entry{ key, std::forward<ValueU>(value), hash, weight, REGION::WINDOW, expire });
+					shard.windowWeight += weight;
+
+					shard.map.emplace(key, shard.window.begin());
+				}
+
+				Evict(shard);
+			}
+
+			bool Erase(const KeyT & key)
+			{
+				uint64_t hash = Hash(key);
+
+				Shard & shard = *_shards[hash & _shardMask];
+
+				std::lock_guard<std::mutex> lock(shard.lock);
+
+				auto iter = shard.map.find(key);
+
+				if (iter == shard.map.end())
+				{
+					return false;
+				}
+
+				Remove(shard, iter);
+
+				return true;
+			}
+
+			// 清理已过期的数据, 返回清理个数
+			std::size_t CleanExpired()
+			{
+				std::size_t count = 0;
+
+				auto now = SteadyClock::now();
+
+				for (auto &shard : _shards)
+				{
+					std::size_t expired = 0;
+
+					std::lock_guard<std::mutex> lock(shard->lock);
+
+					for (auto iter = shard->map.begin(); iter != shard->map.end();)
+					{
+						if (IsExpired(*iter->second, now))
+						{
+							auto next = std::next(iter);
+
+							Remove(*shard, iter);
+
+							iter = next;
+
+							++expired;
+						}
+						else
+						{
+							++iter;
+						}
+					}
+
+					shard->expire.fetch_add(expired, std::memory_order_relaxed);
+
+					count += expired;
+				}
+
+				return count;
+			}
+
+			void Clear()
+			{
+				for (auto &shard : _shards)
+				{
+					std::lock_guard<std::mutex> lock(shard->lock);
+
+					shard->map.clear();
+					shard->window.clear();
+					shard->probation.clear();
+					shard->protect.clear();
+
+					shard->windowWeight    = 0;
+					shard->probationWeight = 0;
+					shard->protectWeight   = 0;
+				}
+			}
+
+			std::size_t Size() const
+			{
+				std::size_t size = 0;
+
+				for (auto &shard : _shards)
+				{
+					std::lock_guard<std::mutex> lock(shard->lock);
+
+					size += shard->map.size();
+				}
+
+				return size;
+			}
+
+			std::size_t Weight() const
+			{
+				std::size_t weight = 0;
+
+				for (auto &shard : _shards)
+				{
+					std::lock_guard<std::mutex> lock(shard->lock);
+
+					weight += shard->windowWeight + shard->probationWeight + shard->protectWeight;
+				}
+
+				return weight;
+			}
+
+			CacheStatistics Statistics() const
+			{
+				CacheStatistics statistics;
+
+				for (auto &shard : _shards)
+				{
+					statistics.hit            += shard->hit.load(std::memory_order_relaxed);
+					statistics.miss           += shard->miss.load(std::memory_order_relaxed);
+					statistics.put            += shard->put.load(std::memory_order_relaxed);
+					statistics.expire         += shard->expire.load(std::memory_order_relaxed);
+					statistics.evict          += shard->evict.load(std::memory_order_relaxed);
+					statistics.getCount       += shard->getCount.load(std::memory_order_relaxed);
+					statistics.getNanoseconds += shard->getNanoseconds.load(std::memory_order_relaxed);
+				}
+
+				return statistics;
+			}
+
+			void ResetStatistics()
+			{
+				for (auto &shard : _shards)
+				{
+					shard->hit.store(0, std::memory_order_relaxed);
+					shard->miss.store(0, std::memory_order_relaxed);
+					shard->put.store(0, std::memory_order_relaxed);
+					shard->expire.store(0, std::memory_order_relaxed);
+					shard->evict.store(0, std::memory_order_relaxed);
+					shard->getCount.store(0, std::memory_order_relaxed);
+					shard->getNanoseconds.store(0, std::memory_order_relaxed);
+				}
+			}
+
+		protected:
+			uint64_t Hash(const KeyT & key) const
+			{
+				auto hash = static_cast<uint64_t>(_hash(key));
+
+				hash *= 0x9E3779B97F4A7C15ull;
+				hash ^= hash >> 29;
+
+				return hash;
+			}
+
+			static bool IsExpired(const Entry & entry, const SteadyClockTimesPoint & now)
+			{
+				return entry.expire <= now;
+			}
+
+			static EntryList & RegionList(Shard & shard, REGION region)
+			{
+				switch (region)
+				{
+					case REGION::WINDOW:
+					{
+						return shard.window;
+					}
+
+					case REGION::PROBATION:
+					{
+						return shard.probation;
+					}
+
+					default:
+					{
+						return shard.protect;
+					}
+				}
+			}
+
+			static std::size_t & RegionWeight(Shard & shard, REGION region)
+			{
+				switch (region)
+				{
+					case REGION::WINDOW:
+					{
+						return shard.windowWeight;
+					}
+
+					case REGION::PROBATION:
+					{
+						return shard.probationWeight;
+					}
+
+					default:
+					{
+						return shard.protectWeight;
+					}
+				}
+			}
+
+			static void Move(Shard & shard, typename EntryList::iterator entry, REGION region)
+			{
+				RegionWeight(shard, entry->region) -= entry->weight;
+				RegionWeight(shard, region)        += entry->weight;
+
+				RegionList(shard, region).splice(RegionList(shard, region).begin(), RegionList(shard, entry->region), entry);
+
+				entry->region = region;
+			}
+
+			// 命中: 窗口内移到头部, 考察段晋升保护段, 保护段溢出时降级回考察段
+			static void OnAccess(Shard & shard, typename EntryList::iterator entry)
+			{
+				if (entry->region == REGION::PROBATION)
+				{
+					Move(shard, entry, REGION::PROTECTED);
+
+					while (shard.protectWeight > shard.protectCapacity && shard.protect.size() > 1)
+					{
+						Move(shard, std::prev(shard.protect.end()), REGION::PROBATION);
+					}
+				}
+				else
+				{
+					Move(shard, entry, entry->region);
+				}
+			}
+
+			static void Remove(Shard & shard, typename EntryMap::iterator iter)
+			{
+				auto entry = iter->second;
+
+				RegionWeight(shard, entry->region) -= entry->weight;
+
+				RegionList(shard, entry->region).erase(entry);
+
+				shard.map.erase(iter);
+			}
+
+			static void Evict(Shard & shard)
+			{
+				std::size_t candidates = 0;
+
+				// 窗口溢出的数据作为候选者进入考察段头部
+				while (shard.windowWeight > shard.windowCapacity && !shard.window.empty())
+				{
+					Move(shard, std::prev(shard.window.end()), REGION::PROBATION);
+
+					++candidates;
+				}
+
+				while (shard.probationWeight + shard.protectWeight > shard.mainCapacity)
+				{
+					EntryList & victims = shard.probation.empty() ? shard.protect : shard.probation;
+
+					auto victim = std::prev(victims.end());
+
+					if (candidates > 0)
+					{
+						auto candidate = shard.probation.begin();
+
+						if (candidate != victim && shard.sketch.Frequency(candidate->hash) > shard.sketch.Frequency(victim->hash))
+						{
+							EvictEntry(shard, victim);
+						}
+						else
+						{
+							EvictEntry(shard, candidate);
+
+							--candidates;
+						}
+					}
+					else
+					{
+						EvictEntry(shard, victim);
+					}
+				}
+			}
+
+			static void EvictEntry(Shard & shard, typename EntryList::iterator entry)
+			{
+				auto iter = shard.map.find(entry->key);
+
+				Remove(shard, iter);
+
+				shard.evict.fetch_add(1, std::memory_order_relaxed);
+			}
+
+		protected:
+			HashT _hash{ };
+
+			bool _recordLatency{ false };
+
+			std::size_t _shardMask{ 0 };
+
+			SteadyClockDuration _defaultTTL{ SteadyClockDuration::zero() };
+
+			std::vector<std::unique_ptr<Shard>> _shards{ };
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__CONTAINER__CACHE__H__
@@ -0,0 +1,631 @@
+#ifndef __TINY_CORE__CONTAINER__CHAIN_BUFFER__H__
+#define __TINY_CORE__CONTAINER__CHAIN_BUFFER__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 链式缓冲区
+ *
+ *  由定长内存块串联而成, 内存块来自池并带引用计数,
+ *  追加/前插/切片/拆分均不拷贝已有数据, 可直接导出iovec供writev/sendmsg使用
+ *
+ *  内存块仅在被唯一持有时才允许继续写入, 共享的内存块只读
+ *
+ */
+
+
+#include <sys/uio.h>
+
+#include <tinyCore/debug/trace.h>
+#include <tinyCore/container/message.h>
+
+
+namespace tinyCore
+{
+	namespace container
+	{
+		class ChainBlockPool;
+
+		struct ChainBlock
+		{
+			Byte * Data()
+			{
+				return reinterpret_cast<Byte *>(this + 1);
+			}
+
+			void Retain()
+			{
+				ref.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			void Release();
+
+			bool IsUnique() const
+			{
+				return ref.load(std::memory_order_acquire) == 1;
+			}
+
+			std::size_t capacity{ 0 };
+
+			std::atomic<uint32_t> ref{ 1 };
+
+			ChainBlockPool * pool{ nullptr };
+		};
+
+		class ChainBlockPool
+		{
+		public:
+			explicit ChainBlockPool(std::size_t blockSize = 4 * TINY_KB, std::size_t maxFree = TINY_KB) : _maxFree(maxFree),
+																										 _blockSize(blockSize)
+			{
+				TINY_THROW_EXCEPTION_IF(blockSize == 0, debug::SizeError, "Block Size Must Be Greater Than Zero")
+			}
+
+			~ChainBlockPool()
+			{
+				for (auto &iter : _free)
+				{
+					Destroy(iter);
+				}
+			}
+
+			ChainBlockPool(const ChainBlockPool &) = delete;
+			ChainBlockPool & operator=(const ChainBlockPool &) = delete;
+
+			static ChainBlockPool & Instance()
+			{
+				static ChainBlockPool instance;
+
+				return instance;
+			}
+
+			ChainBlock * Acquire()
+			{
+				{
+					std::lock_guard<std::mutex> lock(_lock);
+
+					if (!_free.empty())
+					{
+						ChainBlock * block = _free.back();
+
+						_free.pop_back();
+
+						block->ref.store(1, std::memory_order_relaxed);
+
+						return block;
+					}
+				}
+
+				void * memory = ::operator new(sizeof(ChainBlock) + _blockSize);
+
+				auto * block = new(memory) ChainBlock();
+
+				block->pool     = this;
+				block->capacity = _blockSize;
+
+				return block;
+			}
+
+			void Recover(ChainBlock * block)
+			{
+				{
+					std::lock_guard<std::mutex> lock(_lock);
+
+					if (_free.size() < _maxFree)
+					{
+						_free.push_back(block);
+
+						return;
+					}
+				}
+
+				Destroy(block);
+			}
+
+			std::size_t BlockSize() const
+			{
+				return _blockSize;
+			}
+
+			std::size_t FreeCount()
+			{
+				std::lock_guard<std::mutex> lock(_lock);
+
+				return _free.size();
+			}
+
+		protected:
+			static void Destroy(ChainBlock * block)
+			{
+				block->~ChainBlock();
+
+				::operator delete(block);
+			}
+
+		protected:
+			std::mutex _lock{ };
+
+			std::size_t _maxFree{ 0 };
+			std::size_t _blockSize{ 0 };
+
+			std::vector<ChainBlock *> _free{ };
+		};
+
+		inline void ChainBlock::Release()
+		{
+			if (ref.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				pool->Recover(this);
+			}
+		}
+
+		class ChainSegment
+		{
+		public:
+			ChainSegment() = default;
+
+			ChainSegment(ChainBlock * block, std::size_t begin, std::size_t end) : begin(begin), end(end), block(block)
+			{
+
+			}
+
+			ChainSegment(const ChainSegment & rhs) : begin(rhs.begin), end(rhs.end), block(rhs.block)
+			{
+				if (block)
+				{
+					block->Retain();
+				}
+			}
+
+			ChainSegment(ChainSegment && rhs) noexcept : begin(rhs.begin), end(rhs.end), block(rhs.block)
+			{
+				rhs.block = nullptr;
+			}
+
+			~ChainSegment()
+			{
+				if (block)
+				{
+					block->Release();
+				}
+			}
+
+			ChainSegment & operator=(ChainSegment rhs) noexcept
+			{
+				std::swap(begin, rhs.begin);
+				std::swap(end,   rhs.end);
+				std::swap(block, rhs.block);
+
+				return *this;
+			}
+
+			Byte * Data() const
+			{
+				return block->Data() + begin;
+			}
+
+			std::size_t Size() const
+			{
+				return end - begin;
+			}
+
+			std::size_t HeadRoom() const
+			{
+				return block->IsUnique() ? begin : 0;
+			}
+
+			std::size_t TailRoom() const
+			{
+				return block->IsUnique() ? block->capacity - end : 0;
+			}
+
+		public:
+			std::size_t begin{ 0 };
+			std::size_t end{ 0 };
+
+			ChainBlock * block{ nullptr };
+		};
+
+		class ChainBuffer
+		{
+		public:
+			ChainBuffer() : _pool(&ChainBlockPool::Instance())
+			{
+
+			}
+
+			explicit ChainBuffer(ChainBlockPool & pool) : _pool(&pool)
+			{
+
+			}
+
+			ChainBuffer(const ChainBuffer & rhs) = default;
+			ChainBuffer(ChainBuffer && rhs) noexcept : _size(rhs._size), _pool(rhs._pool), _segments(std::move(rhs._segments))
+			{
+				rhs._size = 0;
+			}
+
+			ChainBuffer & operator=(const ChainBuffer & rhs) = default;
+			ChainBuffer & operator=(ChainBuffer && rhs) noexcept
+			{
+				_size     = rhs._size;
+				_pool     = rhs._pool;
+				_segments = std::move(rhs._segments);
+
+				rhs._size = 0;
+
+				return *this;
+			}
+
+			void Reset()
+			{
+				_size = 0;
+
+				_segments.clear();
+			}
+
+			// 追加数据, 优先写入尾部内存块的剩余空间
+			void Write(const char * data)
+			{
+				TINY_ASSERT(data, "data is nullptr");
+
+				Write((const Byte *)data, strlen(data));
+			}
+
+			void Write(const std::string & data)
+			{
+				Write((const Byte *)data.data(), data.size());
+			}
+
+			void Write(const Byte * data, std::size_t size)
+			{
+				TINY_ASSERT(data || size == 0, "data is nullptr");
+
+				while (size > 0)
+				{
+					EnsureFreeSpace();
+
+					std::size_t len = std::min(size, UnWriteSize());
+
+					memcpy(WritePointer(), data, len);
+
+					WriteCompleted(len);
+
+					data += len;
+					size -= len;
+				}
+			}
+
+			// 拼接另一个缓冲区, 仅转移内存块引用
+			void Append(ChainBuffer && rhs)
+			{
+				if (&rhs == this)
+				{
+					Append(static_cast<const ChainBuffer &>(rhs));
+
+					return;
+				}
+
+				for (auto &iter : rhs._segments)
+				{
+					_segments.push_back(std::move(iter));
+				}
+
+				_size += rhs._size;
+
+				rhs.Reset();
+			}
+
+			void Append(const ChainBuffer & rhs)
+			{
+				// 拼接自身时先复制段列表, 避免遍历中插入同一容器
+				if (&rhs == this)
+				{
+					std::deque<ChainSegment> segments(_segments);
+
+					for (auto &iter : segments)
+					{
+						_segments.push_back(std::move(iter));
+					}
+
+					_size *= 2;
+
+					return;
+				}
+
+				for (auto &iter : rhs._segments)
+				{
+					_segments.push_back(iter);
+				}
+
+				_size += rhs._size;
+			}
+
+			// 前插数据 (如协议头), 优先使用首个内存块的头部空间
+			void Prepend(const Byte * data, std::size_t size)
+			{
+				TINY_ASSERT(data || size == 0, "data is nullptr");
+
+				while (size > 0)
+				{
+					if (_segments.empty() || _segments.front().HeadRoom() == 0)
+					{
+						ChainBlock * block = _pool->Acquire();
+
+						_segments.emplace_front(block, block->capacity, block->capacity);
+					}
+
+					ChainSegment & head = _segments.front();
+
+					std::size_t len = std::min(size, head.HeadRoom());
+
+					head.begin -= len;
+
+					memcpy(head.Data(), data + size - len, len);
+
+					size  -= len;
+					_size += len;
+				}
+			}
+
+			void Prepend(const std::string & data)
+			{
+				Prepend((const Byte *)data.data(), data.size());
+			}
+
+			// 返回 [offset, offset + length) 的共享视图
+			ChainBuffer Slice(std::size_t offset, std::size_t length) const
+			{
+				TINY_THROW_EXCEPTION_IF(offset + length > _size, debug::IndexError, "Slice Out Of Range")
+
+				ChainBuffer slice(*_pool);
+
+				for (auto &iter : _segments)
+				{
+					if (length == 0)
+					{
+						break;
+					}
+
+					if (offset >= iter.Size())
+					{
+						offset -= iter.Size();
+
+						continue;
+					}
+
+					std::size_t len = std::min(length, iter.Size() - offset);
+
+					ChainSegment segment(iter);
+
+					segment.begin += offset;
+					segment.end    = segment.begin + len;
+
+					slice._segments.push_back(std::move(segment));
+					slice._size += len;
+
+					offset  = 0;
+					length -= len;
+				}
+
+				return slice;
+			}
+
+			// 从头部拆出size字节, 本缓冲区保留剩余部分
+			ChainBuffer Split(std::size_t size)
+			{
+				TINY_THROW_EXCEPTION_IF(size > _size, debug::IndexError, "Split Out Of Range")
+
+				ChainBuffer head(*_pool);
+
+				while (size > 0)
+				{
+					ChainSegment & front = _segments.front();
+
+					if (front.Size() <= size)
+					{
+						size        -= front.Size();
+						_size       -= front.Size();
+						head._size  += front.Size();
+
+						head._segments.push_back(std::move(front));
+
+						_segments.pop_front();
+					}
+					else
+					{
+						ChainSegment segment(front);
+
+						segment.end   = segment.begin + size;
+						front.begin  += size;
+
+						head._segments.push_back(std::move(segment));
+
+						head._size += size;
+						_size      -= size;
+
+						size = 0;
+					}
+				}
+
+				return head;
+			}
+
+			// 导出iovec, 返回实际填充的个数
+			std::size_t ToIovec(struct iovec * vec, std::size_t count) const
+			{
+				std::size_t index = 0;
+
+				for (auto iter = _segments.begin(); iter != _segments.end() && index < count; ++iter)
+				{
+					if (iter->Size() == 0)
+					{
+						continue;
+					}
+
+					vec[index].iov_base = iter->Data();
+					vec[index].iov_len  = iter->Size();
+
+					++index;
+				}
+
+				return index;
+			}
+
+			std::vector<struct iovec> ToIovec() const
+			{
+				std::vector<struct iovec> vec(_segments.size());
+
+				vec.resize(ToIovec(vec.data(), vec.size()));
+
+				return vec;
+			}
+
+			// 拷贝出数据并消费
+			std::size_t Read(Byte * data, std::size_t size)
+			{
+				std::size_t len = Peek(data, size);
+
+				ReadCompleted(len);
+
+				return len;
+			}
+
+			// 拷贝出数据但不消费
+			std::size_t Peek(Byte * data, std::size_t size) const
+			{
+				std::size_t copied = 0;
+
+				for (auto iter = _segments.begin(); iter != _segments.end() && copied < size; ++iter)
+				{
+					std::size_t len = std::min(size - copied, iter->Size());
+
+					memcpy(data + copied, iter->Data(), len);
+
+					copied += len;
+				}
+
+				return copied;
+			}
+
+			void ReadCompleted(std::size_t bytes)
+			{
+				TINY_ASSERT(bytes <= _size, "wtf");
+
+				_size -= bytes;
+
+				while (bytes > 0)
+				{
+					ChainSegment & front = _segments.front();
+
+					if (front.Size() <= bytes)
+					{
+						bytes -= front.Size();
+
+						_segments.pop_front();
+					}
+					else
+					{
+						front.begin += bytes;
+
+						bytes = 0;
+					}
+				}
+			}
+
+			void WriteCompleted(std::size_t bytes)
+			{
+				TINY_ASSERT(bytes <= UnWriteSize(), "wtf");
+
+				_segments.back().end += bytes;
+
+				_size += bytes;
+			}
+
+			// 确保尾部内存块可写
+			void EnsureFreeSpace()
+			{
+				if (UnWriteSize() == 0)
+				{
+					ChainBlock * block = _pool->Acquire();
+
+					_segments.emplace_back(block, 0, 0);
+				}
+			}
+
+			// 追加到消息缓冲区末尾, 空间不足时按已写入位置扩容
+			void CopyTo(Message & message) const
+			{
+				if (message.UnWriteSize() < _size)
+				{
+					message.Resize(message.Size() + _size);
+				}
+
+				message.WriteCompleted(Peek(message.WritePointer(), _size));
+			}
+
+			std::string ToString() const
+			{
+				std::string value(_size, '\0');
+
+				Peek((Byte *)&value[0], _size);
+
+				return value;
+			}
+
+			std::size_t Size() const
+			{
+				return _size;
+			}
+
+			std::size_t UnReadSize() const
+			{
+				return _size;
+			}
+
+			std::size_t UnWriteSize() const
+			{
+				return _segments.empty() ? 0 : _segments.back().TailRoom();
+			}
+
+			std::size_t BlockCount() const
+			{
+				return _segments.size();
+			}
+
+			bool Empty() const
+			{
+				return _size == 0;
+			}
+
+			// 首个连续可读区域
+			Byte * ReadPointer()
+			{
+				return _segments.empty() ? nullptr : _segments.front().Data();
+			}
+
+			std::size_t ReadableSize() const
+			{
+				return _segments.empty() ? 0 : _segments.front().Size();
+			}
+
+			// 尾部连续可写区域
+			Byte * WritePointer()
+			{
+				return _segments.empty() ? nullptr : _segments.back().Data() + _segments.back().Size();
+			}
+
+		protected:
+			std::size_t _size{ 0 };
+
+			ChainBlockPool * _pool{ nullptr };
+
+			std::deque<ChainSegment> _segments{ };
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__CONTAINER__CHAIN_BUFFER__H__
@@ -0,0 +1,618 @@
+#ifndef __TINY_CORE__CONTAINER__CONCURRENT_HASH_MAP__H__
+#define __TINY_CORE__CONTAINER__CONCURRENT_HASH_MAP__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 并发哈希表
+ *
+ *  按哈希值分片, 每个分片一把读写锁, 分片内为开放寻址表
+ *
+ *  每16个槽位一组, 每个槽位一个字节的控制标记 (空/删除/哈希值低7位),
+ *  查找时用SSE2一次比较一组标记, 只有标记相同的槽位才比较键
+ *
+ */
+
+
+#include <shared_mutex>
+#include <string_view>
+
+#if defined(__SSE2__)
+#
+#  include <emmintrin.h>
+#
+#endif
+
+#include <tinyCore/debug/trace.h>
+
+
+namespace tinyCore
+{
+	namespace container
+	{
+		template <typename KeyT>
+		struct ConcurrentHash : public std::hash<KeyT>
+		{
+
+		};
+
+		template <>
+		struct ConcurrentHash<std::string>
+		{
+			using is_transparent = void;
+
+			std::size_t operator() (const std::string_view & key) const
+			{
+				return std::hash<std::string_view>()(key);
+			}
+		};
+
+		template <typename KeyT, typename ValueT, typename HashT = ConcurrentHash<KeyT>, typename EqualT = std::equal_to<>>
+		class ConcurrentHashMap
+		{
+			using Slot = std::pair<KeyT, ValueT>;
+			using SlotStorage = typename std::aligned_storage<sizeof(Slot), alignof(Slot)>::type;
+
+			static const std::size_t GROUP_SIZE = 16;
+
+			static const int8_t CTRL_EMPTY   = -128;
+			static const int8_t CTRL_DELETED = -2;
+
+			struct alignas(64) Shard
+			{
+				~Shard()
+				{
+					Destroy();
+				}
+
+				void Allocate(std::size_t size)
+				{
+					capacity = size;
+
+					ctrl  = new int8_t[size];
+					slots = new SlotStorage[size];
+
+					memset(ctrl, CTRL_EMPTY, size);
+				}
+
+				void Destroy()
+				{
+					if (ctrl == nullptr)
+					{
+						return;
+					}
+
+					for (std::size_t i = 0; i < capacity; ++i)
+					{
+						if (ctrl[i] >= 0)
+						{
+							At(i)->~Slot();
+						}
+					}
+
+					delete[] ctrl;
+					delete[] slots;
+
+					ctrl  = nullptr;
+					slots = nullptr;
+				}
+
+				Slot * At(std::size_t index) const
+				{
+					return reinterpret_cast<Slot *>(&slots[index]);
+				}
+
+				int8_t * ctrl{ nullptr };
+
+				SlotStorage * slots{ nullptr };
+
+				std::size_t size{ 0 };
+				std::size_t deleted{ 0 };
+				std::size_t capacity{ 0 };
+
+				mutable std::shared_timed_mutex lock{ };
+			};
+
+			struct Position
+			{
+				std::size_t shard;
+				std::size_t group;
+
+				int8_t tag;
+			};
+
+		public:
+			explicit ConcurrentHashMap(std::size_t shardCount = 64, std::size_t shardCapacity = GROUP_SIZE) : _shardMask(shardCount - 1)
+			{
+				if ((shardCount < 1) || ((shardCount & (shardCount - 1)) != 0))
+				{
+					TINY_THROW_EXCEPTION(debug::SizeError, "Shard Count Must Be Power Of Two")
+				}
+
+				std::size_t capacity = GROUP_SIZE;
+
+				while (capacity < shardCapacity)
+				{
+					capacity <<= 1;
+				}
+
+				while ((std::size_t(1) << _shardBits) < shardCount)
+				{
+					++_shardBits;
+				}
+
+				_shards.reset(new Shard[shardCount]);
+
+				for (std::size_t i = 0; i < shardCount; ++i)
+				{
+					_shards[i].Allocate(capacity);
+				}
+			}
+
+			ConcurrentHashMap(const ConcurrentHashMap &) = delete;
+			ConcurrentHashMap & operator=(const ConcurrentHashMap &) = delete;
+
+			// 查找并拷贝出值, 支持异构键 (如std::string键使用std::string_view查找)
+			template <typename LookupT>
+			bool Find(const LookupT & key, ValueT & value) const
+			{
+				Position pos = Locate(key);
+
+				Shard & shard = _shards[pos.shard];
+
+				std::shared_lock<std::shared_timed_mutex> lock(shard.lock);
+
+				Slot * slot = FindSlot(shard, pos, key);
+
+				if (slot == nullptr)
+				{
+					return false;
+				}
+
+				value = slot->second;
+
+				return true;
+			}
+
+			template <typename LookupT>
+			bool Contains(const LookupT & key) const
+			{
+				Position pos = Locate(key);
+
+				Shard & shard = _shards[pos.shard];
+
+				std::shared_lock<std::shared_timed_mutex> lock(shard.lock);
+
+				return FindSlot(shard, pos, key) != nullptr;
+			}
+
+			// 在读锁下访问值, 避免拷贝大对象
+			template <typename LookupT, typename FuncT>
+			bool Visit(const LookupT & key, FuncT && func) const
+			{
+				Position pos = Locate(key);
+
+				Shard & shard = _shards[pos.shard];
+
+				std::shared_lock<std::shared_timed_mutex> lock(shard.lock);
+
+				Slot * slot = FindSlot(shard, pos, key);
+
+				if (slot == nullptr)
+				{
+					return false;
+				}
+
+				func(static_cast<const ValueT &>(slot->second));
+
+				return true;
+			}
+
+			// 键不存在时插入, 返回是否插入成功
+			template <typename KeyU, typename ValueU>
+			bool Insert(KeyU && key, ValueU && value)
+			{
+				Position pos = Locate(key);
+
+				Shard & shard = _shards[pos.shard];
+
+				std::unique_lock<std::shared_timed_mutex> lock(shard.lock);
+
+				if (FindSlot(shard, pos, key))
+				{
+					return false;
+				}
+
+				Emplace(shard, pos, std::forward<KeyU>(key), std::forward<ValueU>(value));
+
+				return true;
+			}
+
+			// 插入或覆盖, 返回true表示插入, false表示覆盖
+			template <typename KeyU, typename ValueU>
+			bool Upsert(KeyU && key, ValueU && value)
+			{
+				Position pos = Locate(key);
+
+				Shard & shard = _shards[pos.shard];
+
+				std::unique_lock<std::shared_timed_mutex> lock(shard.lock);
+
+				Slot * slot = FindSlot(shard, pos, key);
+
+				if (slot)
+				{
+					slot->second = std::forward<ValueU>(value);
+
+					return false;
+				}
+
+				Emplace(shard, pos, std::forward<KeyU>(key), std::forward<ValueU>(value));
+
+				return true;
+			}
+
+			// 存在时在写锁下调用func修改值, 否则插入value
+			template <typename KeyU, typename ValueU, typename FuncT>
+			bool Upsert(KeyU && key, ValueU && value, FuncT && func)
+			{
+				Position pos = Locate(key);
+
+				Shard & shard = _shards[pos.shard];
+
+				std::unique_lock<std::shared_timed_mutex> lock(shard.lock);
+
+				Slot * slot = FindSlot(shard, pos, key);
+
+				if (slot)
+				{
+					func(slot->second);
+
+					return false;
+				}
+
+				Emplace(shard, pos, std::forward<KeyU>(key), std::forward<ValueU>(value));
+
+				return true;
+			}
+
+			// 存在时在写锁下调用func修改值, 返回键是否存在
+			template <typename LookupT, typename FuncT>
+			bool Update(const LookupT & key, FuncT && func)
+			{
+				Position pos = Locate(key);
+
+				Shard & shard = _shards[pos.shard];
+
+				std::unique_lock<std::shared_timed_mutex> lock(shard.lock);
+
+				Slot * slot = FindSlot(shard, pos, key);
+
+				if (slot == nullptr)
+				{
+					return false;
+				}
+
+				func(slot->second);
+
+				return true;
+			}
+
+			template <typename LookupT>
+			bool Erase(const LookupT & key)
+			{
+				return EraseIf(key, [](const ValueT &) { return true; });
+			}
+
+			// 存在且pred返回true时删除, 返回是否删除
+			template <typename LookupT, typename PredT>
+			bool EraseIf(const LookupT & key, PredT && pred)
+			{
+				Position pos = Locate(key);
+
+				Shard & shard = _shards[pos.shard];
+
+				std::unique_lock<std::shared_timed_mutex> lock(shard.lock);
+
+				Slot * slot = FindSlot(shard, pos, key);
+
+				if (slot == nullptr || !pred(static_cast<const ValueT &>(slot->second)))
+				{
+					return false;
+				}
+
+				std::size_t index = static_cast<std::size_t>(reinterpret_cast<SlotStorage *>(slot) - shard.slots);
+				std::size_t group = index & ~(GROUP_SIZE - 1);
+
+				slot->~Slot();
+
+				// 组内仍有空位时探测不会越过该组, 可直接置空, 否则留下删除标记
+				if (MatchEmpty(shard.ctrl + group))
+				{
+					shard.ctrl[index] = CTRL_EMPTY;
+				}
+				else
+				{
+					shard.ctrl[index] = CTRL_DELETED;
+
+					++shard.deleted;
+				}
+
+				--shard.size;
+
+				return true;
+			}
+
+			// 逐个分片在读锁下遍历, 不是全局一致的快照
+			template <typename FuncT>
+			void ForEach(FuncT && func) const
+			{
+				for (std::size_t i = 0; i <= _shardMask; ++i)
+				{
+					Shard & shard = _shards[i];
+
+					std::shared_lock<std::shared_timed_mutex> lock(shard.lock);
+
+					for (std::size_t j = 0; j < shard.capacity; ++j)
+					{
+						if (shard.ctrl[j] >= 0)
+						{
+							Slot * slot = shard.At(j);
+
+							func(static_cast<const KeyT &>(slot->first), static_cast<const ValueT &>(slot->second));
+						}
+					}
+				}
+			}
+
+			void Clear()
+			{
+				for (std::size_t i = 0; i <= _shardMask; ++i)
+				{
+					Shard & shard = _shards[i];
+
+					std::unique_lock<std::shared_timed_mutex> lock(shard.lock);
+
+					std::size_t capacity = shard.capacity;
+
+					shard.Destroy();
+					shard.Allocate(capacity);
+
+					shard.size    = 0;
+					shard.deleted = 0;
+				}
+			}
+
+			std::size_t Size() const
+			{
+				std::size_t size = 0;
+
+				for (std::size_t i = 0; i <= _shardMask; ++i)
+				{
+					std::shared_lock<std::shared_timed_mutex> lock(_shards[i].lock);
+
+					size += _shards[i].size;
+				}
+
+				return size;
+			}
+
+			bool Empty() const
+			{
+				return Size() == 0;
+			}
+
+			std::size_t ShardCount() const
+			{
+				return _shardMask + 1;
+			}
+
+		protected:
+			template <typename LookupT>
+			Position Locate(const LookupT & key) const
+			{
+				auto hash = static_cast<uint64_t>(_hash(key));
+
+				hash *= 0x9E3779B97F4A7C15ull;
+				hash ^= hash >> 32;
+
+				Position pos{ };
+
+				pos.tag   = static_cast<int8_t>(hash & 0x7F);
+				pos.shard = static_cast<std::size_t>((hash >> 7) & _shardMask);
+				pos.group = static_cast<std::size_t>(hash >> (7 + _shardBits));
+
+				return pos;
+			}
+
+			template <typename LookupT>
+			Slot * FindSlot(Shard & shard, const Position & pos, const LookupT & key) const
+			{
+				std::size_t groupMask = shard.capacity / GROUP_SIZE - 1;
+				std::size_t group     = pos.group & groupMask;
+
+				for (std::size_t step = 1; step <= groupMask + 1; ++step)
+				{
+					int8_t * ctrl = shard.ctrl + group * GROUP_SIZE;
+
+					uint32_t mask = Match(ctrl, pos.tag);
+
+					while (mask)
+					{
+						std::size_t index = group * GROUP_SIZE + __builtin_ctz(mask);
+
+						Slot * slot = shard.At(index);
+
+						if (_equal(slot->first, key))
+						{
+							return slot;
+						}
+
+						mask &= mask - 1;
+					}
+
+					if (MatchEmpty(ctrl))
+					{
+						return nullptr;
+					}
+
+					group = (group + step) & groupMask;
+				}
+
+				return nullptr;
+			}
+
+			template <typename KeyU, typename ValueU>
+			void Emplace(Shard & shard, const Position & pos, KeyU && key, ValueU && value)
+			{
+				// 负载超过7/8时扩容, 删除标记较多时原容量重建
+				if ((shard.size + shard.deleted + 1) * 8 > shard.capacity * 7)
+				{
+					Rehash(shard, (shard.size + 1) * 16 > shard.capacity * 7 ? shard.capacity * 2 : shard.capacity);
+				}
+
+				std::size_t index = FindFree(shard, pos.group);
+
+				if (shard.ctrl[index] == CTRL_DELETED)
+				{
+					--shard.deleted;
+				}
+
+				new(&shard.slots[index]) Slot(KeyT(std::forward<KeyU>(key)), std::forward<ValueU>(value));
+
+				shard.ctrl[index] = pos.tag;
+
+				++shard.size;
+			}
+
+			std::size_t FindFree(Shard & shard, std::size_t hashGroup) const
+			{
+				std::size_t groupMask = shard.capacity / GROUP_SIZE - 1;
+				std::size_t group     = hashGroup & groupMask;
+
+				for (std::size_t step = 1; ; ++step)
+				{
+					int8_t * ctrl = shard.ctrl + group * GROUP_SIZE;
+
+					uint32_t mask = MatchFree(ctrl);
+
+					if (mask)
+					{
+						return group * GROUP_SIZE + __builtin_ctz(mask);
+					}
+
+					group = (group + step) & groupMask;
+				}
+			}
+
+			void Rehash(Shard & shard, std::size_t capacity)
+			{
+				Shard temp;
+
+				temp.Allocate(capacity);
+
+				for (std::size_t i = 0; i < shard.capacity; ++i)
+				{
+					if (shard.ctrl[i] < 0)
+					{
+						continue;
+					}
+
+					Slot * slot = shard.At(i);
+
+					Position pos = Locate(slot->first);
+
+					std::size_t index = FindFree(temp, pos.group);
+
+					new(&temp.slots[index]) Slot(std::move(*slot));
+
+					temp.ctrl[index] = pos.tag;
+				}
+
+				temp.size = shard.size;
+
+				std::swap(shard.ctrl,     temp.ctrl);
+				std::swap(shard.slots,    temp.slots);
+				std::swap(shard.capacity, temp.capacity);
+
+				shard.deleted = 0;
+			}
+
+		#if defined(__SSE2__)
+
+			static uint32_t Match(const int8_t * ctrl, int8_t tag)
+			{
+				__m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl));
+
+				return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(tag))));
+			}
+
+			static uint32_t MatchEmpty(const int8_t * ctrl)
+			{
+				return Match(ctrl, CTRL_EMPTY);
+			}
+
+			static uint32_t MatchFree(const int8_t * ctrl)
+			{
+				__m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl));
+
+				// 空与删除标记均为负数, 取符号位即可
+				return static_cast<uint32_t>(_mm_movemask_epi8(group));
+			}
+
+		#else
+
+			static uint32_t Match(const int8_t * ctrl, int8_t tag)
+			{
+				uint32_t mask = 0;
+
+				for (std::size_t i = 0; i < GROUP_SIZE; ++i)
+				{
+					if (ctrl[i] == tag)
+					{
+						mask |= (1u << i);
+					}
+				}
+
+				return mask;
+			}
+
+			static uint32_t MatchEmpty(const int8_t * ctrl)
+			{
+				return Match(ctrl, CTRL_EMPTY);
+			}
+
+			static uint32_t MatchFree(const int8_t * ctrl)
+			{
+				uint32_t mask = 0;
+
+				for (std::size_t i = 0; i < GROUP_SIZE; ++i)
+				{
+					if (ctrl[i] < 0)
+					{
+						mask |= (1u << i);
+					}
+				}
+
+				return mask;
+			}
+
+		#endif
+
+		protected:
+			HashT _hash{ };
+
+			EqualT _equal{ };
+
+			std::size_t _shardBits{ 0 };
+			std::size_t _shardMask{ 0 };
+
+			std::unique_ptr<Shard[]> _shards{ };
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__CONTAINER__CONCURRENT_HASH_MAP__H__
@@ -0,0 +1,567 @@
+#ifndef __TINY_CORE__CONTAINER__CONCURRENT_SKIP_LIST__H__
+#define __TINY_CORE__CONTAINER__CONCURRENT_SKIP_LIST__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 并发有序表 (乐观锁跳表)
+ *
+ *  查找与遍历不加锁, 插入与删除只锁住待修改的前驱节点, 加锁后校验前驱未变化, 否则重试
+ *
+ *  删除先标记节点再摘除, 摘除后的节点交给纪元回收, 保证仍在遍历的线程可以安全访问
+ *
+ *  值在插入后不可修改, 需要更新时先删除再插入
+ *
+ *  正向遍历为弱一致: 键严格递增, 遍历期间始终存在的键一定会被访问到且只访问一次, 并发插入或删除的键可能看到也可能看不到
+ *
+ */
+
+
+#include <tinyCore/lock/epoch.h>
+#include <tinyCore/debug/trace.h>
+
+
+namespace tinyCore
+{
+	namespace container
+	{
+		template <typename KeyT, typename ValueT, typename CompareT = std::less<KeyT>>
+		class ConcurrentSkipList
+		{
+			static const int32_t MAX_LEVEL = 16;
+
+			struct Node
+			{
+				Node(const KeyT & k, const ValueT & v, int32_t level) : key(k), value(v), topLevel(level)
+				{
+
+				}
+
+				void Lock()
+				{
+					while (isLocked.exchange(true, std::memory_order_acquire))
+					{
+						while (isLocked.load(std::memory_order_relaxed))
+						{
+							std::this_thread::yield();
+						}
+					}
+				}
+
+				void UnLock()
+				{
+					isLocked.store(false, std::memory_order_release);
+				}
+
+				std::atomic<Node *> * Next()
+				{
+					return reinterpret_cast<std::atomic<Node *> *>(this + 1);
+				}
+
+				KeyT key;
+				ValueT value;
+
+				int32_t topLevel{ 0 };
+
+				std::atomic<bool> isMarked{ false };
+				std::atomic<bool> isLocked{ false };
+				std::atomic<bool> isFullyLinked{ false };
+			};
+
+			static_assert(alignof(Node) >= alignof(std::atomic<Node *>), "next pointers follow the node");
+
+		public:
+			// 持有纪元保护, 存活期间访问到的节点不会被释放, 不应长时间持有
+			class Iterator
+			{
+				friend class ConcurrentSkipList;
+
+			public:
+				bool Valid() const
+				{
+					return _node != nullptr;
+				}
+
+				const KeyT & Key() const
+				{
+					return _node->key;
+				}
+
+				const ValueT & Value() const
+				{
+					return _node->value;
+				}
+
+				void Next()
+				{
+					_node = ConcurrentSkipList::Live(_node->Next()[0].load(std::memory_order_acquire));
+				}
+
+			protected:
+				Iterator(lock::EpochDomain::Guard && guard, Node * node) : _guard(std::move(guard)), _node(node)
+				{
+
+				}
+
+			protected:
+				lock::EpochDomain::Guard _guard;
+
+				Node * _node{ nullptr };
+			};
+
+		public:
+			explicit ConcurrentSkipList(const CompareT & compare = CompareT()) : _compare(compare)
+			{
+				_head = static_cast<Node *>(::operator new(sizeof(Node) + sizeof(std::atomic<Node *>) * MAX_LEVEL));
+
+				// 头节点只使用链接部分, 不构造键值
+				for (int32_t i = 0; i < MAX_LEVEL; ++i)
+				{
+					new (&_head->Next()[i]) std::atomic<Node *>(nullptr);
+				}
+
+				new (&_head->isMarked) std::atomic<bool>(false);
+				new (&_head->isLocked) std::atomic<bool>(false);
+				new (&_head->isFullyLinked) std::atomic<bool>(true);
+
+				_head->topLevel = MAX_LEVEL;
+			}
+
+			~ConcurrentSkipList()
+			{
+				Node * node = _head->Next()[0].load(std::memory_order_relaxed);
+
+				while (node)
+				{
+					Node * next = node->Next()[0].load(std::memory_order_relaxed);
+
+					Destroy(node);
+
+					node = next;
+				}
+
+				::operator delete(_head);
+			}
+
+			ConcurrentSkipList(const ConcurrentSkipList &) = delete;
+			ConcurrentSkipList & operator=(const ConcurrentSkipList &) = delete;
+
+			// 键已存在时返回false
+			bool Insert(const KeyT & key, const ValueT & value)
+			{
+				auto guard = _epoch.Pin();
+
+				int32_t topLevel = RandomLevel();
+
+				Node * preds[MAX_LEVEL];
+				Node * succs[MAX_LEVEL];
+
+				while (true)
+				{
+					int32_t found = Find(key, preds, succs);
+
+					if (found != -1)
+					{
+						Node * node = succs[found];
+
+						if (!node->isMarked.load(std::memory_order_acquire))
+						{
+							// 等待并发插入完成, 保证返回后可以查找到
+							while (!node->isFullyLinked.load(std::memory_order_acquire))
+							{
+								std::this_thread::yield();
+							}
+
+							return false;
+						}
+
+						// 正在被删除, 重试
+						continue;
+					}
+
+					int32_t highest = -1;
+
+					bool isValid = true;
+
+					Node * prev = nullptr;
+
+					for (int32_t level = 0; isValid && level < topLevel; ++level)
+					{
+						Node * pred = preds[level];
+						Node * succ = succs[level];
+
+						if (pred != prev)
+						{
+							pred->Lock();
+
+							highest = level;
+
+							prev = pred;
+						}
+
+						isValid = !pred->isMarked.load(std::memory_order_acquire) &&
+								  (succ == nullptr || !succ->isMarked.load(std::memory_order_acquire)) &&
+								  pred->Next()[level].load(std::memory_order_acquire) == succ;
+					}
+
+					if (!isValid)
+					{
+						UnLock(preds, highest);
+
+						continue;
+					}
+
+					Node * node = Create(key, value, topLevel);
+
+					for (int32_t level = 0; level < topLevel; ++level)
+					{
+						node->Next()[level].store(succs[level], std::memory_order_relaxed);
+					}
+
+					for (int32_t level = 0; level < topLevel; ++level)
+					{
+						preds[level]->Next()[level].store(node, std::memory_order_release);
+					}
+
+					node->isFullyLinked.store(true, std::memory_order_release);
+
+					UnLock(preds, highest);
+
+					_size.fetch_add(1, std::memory_order_relaxed);
+
+					return true;
+				}
+			}
+
+			bool Erase(const KeyT & key)
+			{
+				auto guard = _epoch.Pin();
+
+				Node * victim = nullptr;
+
+				bool isMarked = false;
+
+				int32_t topLevel = -1;
+
+				Node * preds[MAX_LEVEL];
+				Node * succs[MAX_LEVEL];
+
+				while (true)
+				{
+					int32_t found = Find(key, preds, succs);
+
+					if (!isMarked)
+					{
+						if (found == -1 || !CanErase(succs[found], found))
+						{
+							return false;
+						}
+
+						victim   = succs[found];
+						topLevel = victim->topLevel;
+
+						victim->Lock();
+
+						if (victim->isMarked.load(std::memory_order_relaxed))
+						{
+							victim->UnLock();
+
+							return false;
+						}
+
+						// 标记后其他线程不再把它当作存在的键, 也不会在它之后链接新节点
+						victim->isMarked.store(true, std::memory_order_release);
+
+						isMarked = true;
+					}
+
+					int32_t highest = -1;
+
+					bool isValid = true;
+
+					Node * prev = nullptr;
+
+					for (int32_t level = 0; isValid && level < topLevel; ++level)
+					{
+						Node * pred = preds[level];
+
+						if (pred != prev)
+						{
+							pred->Lock();
+
+							highest = level;
+
+							prev = pred;
+						}
+
+						isValid = !pred->isMarked.load(std::memory_order_acquire) &&
+								  pred->Next()[level].load(std::memory_order_acquire) == victim;
+					}
+
+					if (!isValid)
+					{
+						UnLock(preds, highest);
+
+						continue;
+					}
+
+					for (int32_t level = topLevel - 1; level >= 0; --level)
+					{
+						preds[level]->Next()[level].store(victim->Next()[level].load(std::memory_order_relaxed), std::memory_order_release);
+					}
+
+					victim->UnLock();
+
+					UnLock(preds, highest);
+
+					_size.fetch_sub(1, std::memory_order_relaxed);
+
+					_epoch.Retire(victim, &ConcurrentSkipList::DestroyNode);
+
+					return true;
+				}
+			}
+
+			bool Find(const KeyT & key, ValueT & value)
+			{
+				auto guard = _epoch.Pin();
+
+				Node * node = FindNode(key);
+
+				if (node == nullptr)
+				{
+					return false;
+				}
+
+				value = node->value;
+
+				return true;
+			}
+
+			bool Contains(const KeyT & key)
+			{
+				auto guard = _epoch.Pin();
+
+				return FindNode(key) != nullptr;
+			}
+
+			Iterator Begin()
+			{
+				auto guard = _epoch.Pin();
+
+				Node * node = Live(_head->Next()[0].load(std::memory_order_acquire));
+
+				return Iterator(std::move(guard), node);
+			}
+
+			// 第一个不小于key的位置
+			Iterator LowerBound(const KeyT & key)
+			{
+				auto guard = _epoch.Pin();
+
+				Node * pred = _head;
+
+				for (int32_t level = MAX_LEVEL - 1; level >= 0; --level)
+				{
+					Node * curr = pred->Next()[level].load(std::memory_order_acquire);
+
+					while (curr && _compare(curr->key, key))
+					{
+						pred = curr;
+						curr = pred->Next()[level].load(std::memory_order_acquire);
+					}
+				}
+
+				Node * node = Live(pred->Next()[0].load(std::memory_order_acquire));
+
+				return Iterator(std::move(guard), node);
+			}
+
+			// 依次访问[low, high)内的键值, func返回false时停止, 返回访问数量
+			template <typename FunctionT>
+			std::size_t Range(const KeyT & low, const KeyT & high, FunctionT && func)
+			{
+				std::size_t count = 0;
+
+				for (auto iter = LowerBound(low); iter.Valid() && _compare(iter.Key(), high); iter.Next())
+				{
+					++count;
+
+					if (!func(iter.Key(), iter.Value()))
+					{
+						break;
+					}
+				}
+
+				return count;
+			}
+
+			std::size_t Size() const
+			{
+				return _size.load(std::memory_order_relaxed);
+			}
+
+			bool Empty() const
+			{
+				return Size() == 0;
+			}
+
+			// 当前线程尝试回收已删除的节点
+			void Reclaim()
+			{
+				_epoch.Flush();
+			}
+
+		protected:
+			// 返回键所在的最高层, 不存在返回-1
+			int32_t Find(const KeyT & key, Node ** preds, Node ** succs)
+			{
+				int32_t found = -1;
+
+				Node * pred = _head;
+
+				for (int32_t level = MAX_LEVEL - 1; level >= 0; --level)
+				{
+					Node * curr = pred->Next()[level].load(std::memory_order_acquire);
+
+					while (curr && _compare(curr->key, key))
+					{
+						pred = curr;
+						curr = pred->Next()[level].load(std::memory_order_acquire);
+					}
+
+					if (found == -1 && curr && !_compare(key, curr->key))
+					{
+						found = level;
+					}
+
+					preds[level] = pred;
+					succs[level] = curr;
+				}
+
+				return found;
+			}
+
+			Node * FindNode(const KeyT & key)
+			{
+				Node * pred = _head;
+				Node * curr = nullptr;
+
+				for (int32_t level = MAX_LEVEL - 1; level >= 0; --level)
+				{
+					curr = pred->Next()[level].load(std::memory_order_acquire);
+
+					while (curr && _compare(curr->key, key))
+					{
+						pred = curr;
+						curr = pred->Next()[level].load(std::memory_order_acquire);
+					}
+
+					if (curr && !_compare(key, curr->key))
+					{
+						return IsLive(curr) ? curr : nullptr;
+					}
+				}
+
+				return nullptr;
+			}
+
+			bool CanErase(Node * node, int32_t found) const
+			{
+				return node->isFullyLinked.load(std::memory_order_acquire) &&
+					   node->topLevel - 1 == found &&
+					   !node->isMarked.load(std::memory_order_acquire);
+			}
+
+			void UnLock(Node ** preds, int32_t highest)
+			{
+				Node * prev = nullptr;
+
+				for (int32_t level = 0; level <= highest; ++level)
+				{
+					if (preds[level] != prev)
+					{
+						preds[level]->UnLock();
+
+						prev = preds[level];
+					}
+				}
+			}
+
+			static bool IsLive(Node * node)
+			{
+				return node->isFullyLinked.load(std::memory_order_acquire) && !node->isMarked.load(std::memory_order_acquire);
+			}
+
+			// 跳过已标记删除或尚未链接完成的节点
+			static Node * Live(Node * node)
+			{
+				while (node && !IsLive(node))
+				{
+					node = node->Next()[0].load(std::memory_order_acquire);
+				}
+
+				return node;
+			}
+
+			static int32_t RandomLevel()
+			{
+				static thread_local uint64_t state = reinterpret_cast<uintptr_t>(&state) | 1;
+
+				state ^= state << 13;
+				state ^= state >> 7;
+				state ^= state << 17;
+
+				// 每层晋升概率1/4
+				int32_t level = 1;
+
+				for (uint64_t bits = state; level < MAX_LEVEL && (bits & 3) == 0; bits >>= 2)
+				{
+					++level;
+				}
+
+				return level;
+			}
+
+			static Node * Create(const KeyT & key, const ValueT & value, int32_t level)
+			{
+				void * memory = ::operator new(sizeof(Node) + sizeof(std::atomic<Node *>) * level);
+
+				auto * node = new (memory) Node(key, value, level);
+
+				for (int32_t i = 0; i < level; ++i)
+				{
+					new (&node->Next()[i]) std::atomic<Node *>(nullptr);
+				}
+
+				return node;
+			}
+
+			static void Destroy(Node * node)
+			{
+				node->~Node();
+
+				::operator delete(node);
+			}
+
+			static void DestroyNode(void * node)
+			{
+				Destroy(static_cast<Node *>(node));
+			}
+
+		protected:
+			CompareT _compare;
+
+			Node * _head{ nullptr };
+
+			std::atomic<std::size_t> _size{ 0 };
+
+			lock::EpochDomain _epoch;
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__CONTAINER__CONCURRENT_SKIP_LIST__H__
@@ -0,0 +1,411 @@
+#ifndef __TINY_CORE__CONTAINER__CUCKOO_FILTER__H__
+#define __TINY_CORE__CONTAINER__CUCKOO_FILTER__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 布谷鸟过滤器
+ *
+ *  每个桶4个16位指纹, 正好一个64位字, 查询时只访问两个候选桶, 用位运算一次比较桶内4个指纹
+ *
+ *  候选桶 i2 = (hash(指纹) - i1) mod n, 对i2再算一次得到i1, 踢出时只凭指纹即可算出另一个桶, 因此支持删除, 桶数不必是2的幂
+ *
+ *  只能删除确实插入过的键, 同一个键插入多次需要删除同样多次
+ *
+ *  装载率约95%之前插入基本都能成功, 踢出次数用尽时最后一个指纹放入备用位置, 此后插入失败
+ *
+ *  可以保存到文件, 加载时直接映射文件 (写时复制), 无需解析
+ *
+ *  并发查询是安全的, 插入与删除需要外部同步
+ *
+ */
+
+
+#include <random>
+
+#include <tinyCore/container/bloomFilter.h>
+
+
+namespace tinyCore
+{
+	namespace container
+	{
+		template <typename KeyT, typename HashT = FilterHash<KeyT>>
+		class CuckooFilter
+		{
+			static const uint32_t VERSION = 1;
+
+			static const std::size_t SLOT_COUNT = 4;
+			static const std::size_t MAX_KICKS = 500;
+
+			static const uint64_t LANE_LOW  = 0x0001000100010001ull;
+			static const uint64_t LANE_HIGH = 0x8000800080008000ull;
+
+			struct Header
+			{
+				char magic[8];
+
+				uint32_t version;
+				uint32_t slotCount;
+
+				uint64_t bucketCount;
+				uint64_t count;
+
+				uint64_t victimIndex;
+				uint16_t victimFingerprint;
+
+				uint8_t reserved[22];
+			};
+
+			static_assert(sizeof(Header) == 64, "header must be one cache line");
+
+		public:
+			explicit CuckooFilter(const std::size_t expectedCount)
+			{
+				// 按95%装载率估算桶数, 至少2个桶
+				_bucketCount = std::max<std::size_t>(static_cast<std::size_t>(std::ceil(static_cast<double>(std::max<std::size_t>(expectedCount, 1)) / SLOT_COUNT / 0.95)), 2);
+
+				TINY_THROW_EXCEPTION_IF(_bucketCount > UINT32_MAX, debug::SizeError, "Too Many Buckets")
+
+				_storage.resize(_bucketCount, 0);
+
+				_buckets = _storage.data();
+			}
+
+			CuckooFilter(CuckooFilter && rhs) noexcept
+			{
+				Swap(rhs);
+			}
+
+			CuckooFilter & operator=(CuckooFilter && rhs) noexcept
+			{
+				if (this != &rhs)
+				{
+					Swap(rhs);
+				}
+
+				return *this;
+			}
+
+			CuckooFilter(const CuckooFilter &) = delete;
+			CuckooFilter & operator=(const CuckooFilter &) = delete;
+
+			// 过滤器已满时返回false
+			bool Insert(const KeyT & key)
+			{
+				return InsertHash(_hash(key));
+			}
+
+			bool Contains(const KeyT & key) const
+			{
+				return ContainsHash(_hash(key));
+			}
+
+			bool Erase(const KeyT & key)
+			{
+				return EraseHash(_hash(key));
+			}
+
+			bool InsertHash(const uint64_t hash)
+			{
+				if (_victimFingerprint != 0)
+				{
+					return false;
+				}
+
+				uint16_t fingerprint = Fingerprint(hash);
+
+				std::size_t index = Index(hash);
+
+				if (Place(index, fingerprint) || Place(AltIndex(index, fingerprint), fingerprint))
+				{
+					++_count;
+
+					return true;
+				}
+
+				// 随机踢出一个指纹, 放到它的另一个候选桶
+				index = _random() & 1 ? AltIndex(index, fingerprint) : index;
+
+				for (std::size_t kick = 0; kick < MAX_KICKS; ++kick)
+				{
+					std::size_t slot = _random() % SLOT_COUNT;
+
+					uint16_t evicted = Get(index, slot);
+
+					Set(index, slot, fingerprint);
+
+					fingerprint = evicted;
+
+					index = AltIndex(index, fingerprint);
+
+					if (Place(index, fingerprint))
+					{
+						++_count;
+
+						return true;
+					}
+				}
+
+				_victimIndex       = index;
+				_victimFingerprint = fingerprint;
+
+				++_count;
+
+				return true;
+			}
+
+			bool ContainsHash(const uint64_t hash) const
+			{
+				uint16_t fingerprint = Fingerprint(hash);
+
+				std::size_t first  = Index(hash);
+				std::size_t second = AltIndex(first, fingerprint);
+
+				if (HasFingerprint(_buckets[first], fingerprint) || HasFingerprint(_buckets[second], fingerprint))
+				{
+					return true;
+				}
+
+				return _victimFingerprint == fingerprint && (_victimIndex == first || _victimIndex == second);
+			}
+
+			bool EraseHash(const uint64_t hash)
+			{
+				uint16_t fingerprint = Fingerprint(hash);
+
+				std::size_t first  = Index(hash);
+				std::size_t second = AltIndex(first, fingerprint);
+
+				if (Remove(first, fingerprint) || Remove(second, fingerprint))
+				{
+					--_count;
+
+					// 腾出了位置, 尝试放回备用位置中的指纹
+					if (_victimFingerprint != 0)
+					{
+						uint16_t victim = _victimFingerprint;
+
+						_victimFingerprint = 0;
+
+						--_count;
+
+						InsertVictim(_victimIndex, victim);
+					}
+
+					return true;
+				}
+
+				if (_victimFingerprint == fingerprint && (_victimIndex == first || _victimIndex == second))
+				{
+					_victimFingerprint = 0;
+
+					--_count;
+
+					return true;
+				}
+
+				return false;
+			}
+
+			void Clear()
+			{
+				memset(_buckets, 0, _bucketCount * sizeof(uint64_t));
+
+				_count = 0;
+
+				_victimIndex       = 0;
+				_victimFingerprint = 0;
+			}
+
+			std::size_t Count() const
+			{
+				return _count;
+			}
+
+			std::size_t BucketCount() const
+			{
+				return _bucketCount;
+			}
+
+			std::size_t SizeInBytes() const
+			{
+				return _bucketCount * sizeof(uint64_t);
+			}
+
+			double LoadFactor() const
+			{
+				return static_cast<double>(_count) / static_cast<double>(_bucketCount * SLOT_COUNT);
+			}
+
+			void Save(const std::string & path) const
+			{
+				Header header{ };
+
+				memcpy(header.magic, "TCCUCKOO", 8);
+
+				header.version           = VERSION;
+				header.slotCount         = SLOT_COUNT;
+				header.bucketCount       = _bucketCount;
+				header.count             = _count;
+				header.victimIndex       = _victimIndex;
+				header.victimFingerprint = _victimFingerprint;
+
+				system::MappedFile::Write(path, { { &header, sizeof(Header) }, { _buckets, SizeInBytes() } });
+			}
+
+			// 映射文件后直接使用, 之后的修改只作用于进程内的副本
+			static CuckooFilter Load(const std::string & path)
+			{
+				CuckooFilter filter;
+
+				filter._file.Open(path, system::MappedFile::MODE::COPY_ON_WRITE);
+
+				TINY_THROW_EXCEPTION_IF(filter._file.Size() < sizeof(Header), debug::FileError, TINY_STR_FORMAT("{} is not a cuckoo filter", path))
+
+				auto * header = reinterpret_cast<const Header *>(filter._file.Data());
+
+				// 先取出再比较, 避免 header->bucketCount < 2 在模板中被解析为模板实参列表
+				uint64_t bucketCount = header->bucketCount;
+
+				TINY_THROW_EXCEPTION_IF(memcmp(header->magic, "TCCUCKOO", 8) != 0 ||
+										header->version != VERSION ||
+										header->slotCount != SLOT_COUNT ||
+										bucketCount < 2 ||
+										bucketCount > UINT32_MAX ||
+										filter._file.Size() != sizeof(Header) + bucketCount * sizeof(uint64_t),
+										debug::FileError, TINY_STR_FORMAT("{} is not a valid cuckoo filter", path))
+
+				filter._bucketCount       = bucketCount;
+				filter._count             = header->count;
+				filter._victimIndex       = header->victimIndex;
+				filter._victimFingerprint = header->victimFingerprint;
+				filter._buckets           = reinterpret_cast<uint64_t *>(filter._file.Data() + sizeof(Header));
+
+				return filter;
+			}
+
+		protected:
+			CuckooFilter() = default;
+
+			void Swap(CuckooFilter & rhs)
+			{
+				std::swap(_hash, rhs._hash);
+				std::swap(_count, rhs._count);
+				std::swap(_random, rhs._random);
+				std::swap(_buckets, rhs._buckets);
+				std::swap(_storage, rhs._storage);
+				std::swap(_bucketCount, rhs._bucketCount);
+				std::swap(_victimIndex, rhs._victimIndex);
+				std::swap(_victimFingerprint, rhs._victimFingerprint);
+				std::swap(_file, rhs._file);
+			}
+
+			void InsertVictim(const std::size_t index, const uint16_t fingerprint)
+			{
+				if (Place(index, fingerprint) || Place(AltIndex(index, fingerprint), fingerprint))
+				{
+					++_count;
+
+					return;
+				}
+
+				_victimIndex       = index;
+				_victimFingerprint = fingerprint;
+
+				++_count;
+			}
+
+			// 取高16位, 0表示空槽位
+			static uint16_t Fingerprint(const uint64_t hash)
+			{
+				auto fingerprint = static_cast<uint16_t>(hash >> 48);
+
+				return fingerprint == 0 ? 1 : fingerprint;
+			}
+
+			// 低32位按乘法映射到桶
+			std::size_t Index(const uint64_t hash) const
+			{
+				return static_cast<std::size_t>(((hash & 0xFFFFFFFF) * _bucketCount) >> 32);
+			}
+
+			std::size_t AltIndex(const std::size_t index, const uint16_t fingerprint) const
+			{
+				std::size_t mix = Index(static_cast<uint32_t>(fingerprint * 0x5BD1E995u));
+
+				return index <= mix ? mix - index : mix + _bucketCount - index;
+			}
+
+			// 桶内任意16位与指纹相同
+			static bool HasFingerprint(const uint64_t bucket, const uint16_t fingerprint)
+			{
+				uint64_t value = bucket ^ (fingerprint * LANE_LOW);
+
+				return ((value - LANE_LOW) & ~value & LANE_HIGH) != 0;
+			}
+
+			uint16_t Get(const std::size_t index, const std::size_t slot) const
+			{
+				return static_cast<uint16_t>(_buckets[index] >> (slot * 16));
+			}
+
+			void Set(const std::size_t index, const std::size_t slot, const uint16_t fingerprint)
+			{
+				_buckets[index] = (_buckets[index] & ~(uint64_t(0xFFFF) << (slot * 16))) | (uint64_t(fingerprint) << (slot * 16));
+			}
+
+			bool Place(const std::size_t index, const uint16_t fingerprint)
+			{
+				for (std::size_t slot = 0; slot < SLOT_COUNT; ++slot)
+				{
+					if (Get(index, slot) == 0)
+					{
+						Set(index, slot, fingerprint);
+
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+			bool Remove(const std::size_t index, const uint16_t fingerprint)
+			{
+				for (std::size_t slot = 0; slot < SLOT_COUNT; ++slot)
+				{
+					if (Get(index, slot) == fingerprint)
+					{
+						Set(index, slot, 0);
+
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+		protected:
+			HashT _hash{ };
+
+			std::size_t _count{ 0 };
+			std::size_t _bucketCount{ 0 };
+			std::size_t _victimIndex{ 0 };
+
+			uint16_t _victimFingerprint{ 0 };
+
+			uint64_t * _buckets{ nullptr };
+
+			std::minstd_rand _random{ 0x5EED };
+
+			std::vector<uint64_t> _storage{ };
+
+			system::MappedFile _file{ };
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__CONTAINER__CUCKOO_FILTER__H__
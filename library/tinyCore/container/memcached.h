@@ -14,14 +14,134 @@
 #include <libmemcached/memcached.h>
 
 #include <tinyCore/debug/trace.h>
+#include <tinyCore/compress/zlib.h>
+#include <tinyCore/container/message.h>
 
 
 namespace tinyCore
 {
 	namespace container
 	{
+		// memcached返回值句柄, 直接持有libmemcached分配的缓冲区, 不做拷贝 (解压后的数据除外)
+		class MemcachedValue
+		{
+			friend class Memcached;
+
+		public:
+			MemcachedValue() = default;
+
+			MemcachedValue(MemcachedValue && rhs) noexcept : _data(rhs._data),
+															 _size(rhs._size),
+															 _flags(rhs._flags),
+															 _storage(std::move(rhs._storage))
+			{
+				rhs._data  = nullptr;
+				rhs._size  = 0;
+				rhs._flags = 0;
+			}
+
+			MemcachedValue & operator=(MemcachedValue && rhs) noexcept
+			{
+				if (this != &rhs)
+				{
+					Reset();
+
+					_data    = rhs._data;
+					_size    = rhs._size;
+					_flags   = rhs._flags;
+					_storage = std::move(rhs._storage);
+
+					rhs._data  = nullptr;
+					rhs._size  = 0;
+					rhs._flags = 0;
+				}
+
+				return *this;
+			}
+
+			MemcachedValue(const MemcachedValue &) = delete;
+			MemcachedValue & operator=(const MemcachedValue &) = delete;
+
+			~MemcachedValue()
+			{
+				Reset();
+			}
+
+			void Reset()
+			{
+				if (_data)
+				{
+					free(_data);
+
+					_data = nullptr;
+				}
+
+				_size  = 0;
+				_flags = 0;
+
+				_storage.clear();
+			}
+
+			const char * Data() const
+			{
+				return _data ? _data : (const char *)_storage.data();
+			}
+
+			std::size_t Size() const
+			{
+				return _size;
+			}
+
+			uint32_t Flags() const
+			{
+				return _flags;
+			}
+
+			bool Empty() const
+			{
+				return _size == 0;
+			}
+
+			std::string ToString() const
+			{
+				return _size == 0 ? std::string() : std::string(Data(), _size);
+			}
+
+		protected:
+			void Assign(char * data, const std::size_t size, const uint32_t flags)
+			{
+				Reset();
+
+				_data  = data;
+				_size  = size;
+				_flags = flags;
+			}
+
+			void Assign(ByteVector && storage, const uint32_t flags)
+			{
+				Reset();
+
+				_size    = storage.size();
+				_flags   = flags;
+				_storage = std::move(storage);
+			}
+
+		protected:
+			char * _data{ nullptr };
+
+			std::size_t _size{ 0 };
+
+			uint32_t _flags{ 0 };
+
+			ByteVector _storage{ };
+		};
+
 		class Memcached
 		{
+		public:
+			// 最高位保留, 标记数据经过zlib压缩
+			static const uint32_t FLAG_COMPRESSED = 0x80000000u;
+
 		public:
 			bool Initialize(const char * host = "127.0.0.1", uint16_t port = 11211)
 			{
@@ -42,7 +162,7 @@ namespace tinyCore
 
 				if (server == nullptr)
 				{
-					_errorMsg = memcached_strerror(_memcached, ret);
+					SetError(ret);
 
 					return false;
 				}
@@ -55,7 +175,7 @@ namespace tinyCore
 
 				if (ret != MEMCACHED_SUCCESS)
 				{
-					_errorMsg = memcached_strerror(_memcached, ret);
+					SetError(ret);
 
 					return false;
 				}
@@ -65,7 +185,7 @@ namespace tinyCore
 
 				if (ret != MEMCACHED_SUCCESS)
 				{
-					_errorMsg = memcached_strerror(_memcached, ret);
+					SetError(ret);
 
 					return false;
 				}
@@ -75,7 +195,7 @@ namespace tinyCore
 
 				if (ret != MEMCACHED_SUCCESS)
 				{
-					_errorMsg = memcached_strerror(_memcached, ret);
+					SetError(ret);
 
 					return false;
 				}
@@ -84,7 +204,7 @@ namespace tinyCore
 
 				if (ret != MEMCACHED_SUCCESS)
 				{
-					_errorMsg = memcached_strerror(_memcached, ret);
+					SetError(ret);
 
 					return false;
 				}
@@ -93,7 +213,7 @@ namespace tinyCore
 
 				if (ret != MEMCACHED_SUCCESS)
 				{
-					_errorMsg = memcached_strerror(_memcached, ret);
+					SetError(ret);
 
 					return false;
 				}
@@ -102,7 +222,7 @@ namespace tinyCore
 
 				if (ret != MEMCACHED_SUCCESS)
 				{
-					_errorMsg = memcached_strerror(_memcached, ret);
+					SetError(ret);
 
 					return false;
 				}
@@ -113,48 +233,125 @@ namespace tinyCore
 			bool GetValue(const char * key, std::string & value)
 			{
 				TINY_ASSERT(key, "key is nullptr");
-				TINY_ASSERT(_memcached, "memcached not initialize or nullptr");
 
-				uint32_t flag;
-				std::size_t len;
-				memcached_return_t ret;
+				return GetValue(key, strlen(key), value);
+			}
 
-				char * tempStr = memcached_get(_memcached, key, strlen(key), &len, &flag, &ret);
+			// 二进制安全, 值中可以包含'\0'
+			bool GetValue(const char * key, const std::size_t keyLen, std::string & value)
+			{
+				MemcachedValue temp;
 
-				if (ret == MEMCACHED_SUCCESS)
+				if (!GetValue(key, keyLen, temp))
 				{
-					value = tempStr;
+					return false;
 				}
-				else
+
+				value.assign(temp.Data(), temp.Size());
+
+				return true;
+			}
+
+			// 追加写入调用方提供的消息缓冲区
+			bool GetValue(const char * key, const std::size_t keyLen, Message & message)
+			{
+				MemcachedValue temp;
+
+				if (!GetValue(key, keyLen, temp))
 				{
-					_errorMsg = memcached_strerror(_memcached, ret);
+					return false;
 				}
 
-				if (tempStr)
+				if (!temp.Empty())
 				{
-					free(tempStr);
+					message.EnsureFreeSpace(temp.Size());
+
+					message.Write((const Byte *)temp.Data(), temp.Size());
 				}
 
-				return (ret == MEMCACHED_SUCCESS);
+				return true;
 			}
 
-			bool SetValue(const char * key, const std::string & value)
+			// 零拷贝, 句柄接管libmemcached分配的缓冲区
+			bool GetValue(const char * key, const std::size_t keyLen, MemcachedValue & value)
 			{
 				TINY_ASSERT(key, "key is nullptr");
 				TINY_ASSERT(_memcached, "memcached not initialize or nullptr");
 
 				uint32_t flags = 0;
+				std::size_t len = 0;
+				memcached_return_t ret;
+
+				char * tempStr = memcached_get(_memcached, key, keyLen, &len, &flags, &ret);
+
+				if (ret != MEMCACHED_SUCCESS)
+				{
+					SetError(ret);
+
+					if (tempStr)
+					{
+						free(tempStr);
+					}
+
+					return false;
+				}
+
+				if (flags & FLAG_COMPRESSED)
+				{
+					ByteVector storage;
+
+					bool success = Decompress((const Byte *)tempStr, len, storage);
+
+					if (tempStr)
+					{
+						free(tempStr);
+					}
+
+					if (!success)
+					{
+						return false;
+					}
+
+					value.Assign(std::move(storage), flags & ~FLAG_COMPRESSED);
+				}
+				else
+				{
+					value.Assign(tempStr, len, flags);
+				}
+
+				return true;
+			}
+
+			bool SetValue(const char * key, const std::string & value)
+			{
+				TINY_ASSERT(key, "key is nullptr");
 
-				auto ret = memcached_set(_memcached, key, strlen(key), value.c_str(), value.size(), _expiration, flags);
+				return SetValue(key, strlen(key), value.data(), value.size());
+			}
+
+			// 二进制安全, flags最高位保留给压缩标记
+			bool SetValue(const char * key, const std::size_t keyLen, const char * data, const std::size_t len, const uint32_t flags = 0)
+			{
+				TINY_ASSERT(key, "key is nullptr");
+				TINY_ASSERT(_memcached, "memcached not initialize or nullptr");
+
+				auto ret = Store(key, keyLen, data, len, flags);
 
 				if (ret != MEMCACHED_SUCCESS)
 				{
-					_errorMsg = memcached_strerror(_memcached, ret);
+					SetError(ret);
 				}
 
 				return (ret == MEMCACHED_SUCCESS);
 			}
 
+			// 超过阈值的值使用zlib压缩后存储 (压缩后未变小则原样存储), 0表示关闭
+			void SetCompression(const std::size_t threshold, const int32_t level = compress::ZLib::ZLIB_DEFAULT_COMPRESSION)
+			{
+				_compressLevel     = level;
+				_compressThreshold = threshold;
+			}
+
 			void SetExpiration(const std::time_t expiration)
 			{
 				_expiration = expiration;
@@ -168,14 +365,177 @@ namespace tinyCore
 
 				if (ret != MEMCACHED_SUCCESS)
 				{
-					_errorMsg = memcached_strerror(_memcached, ret);
+					SetError(ret);
 				}
 
 				return (ret == MEMCACHED_SUCCESS);
 			}
 
+			// 批量获取, 一次请求发出所有键, 不存在的键不会出现在结果中
+			// 压缩数据解压失败的键同样不出现在结果中, 其余键照常返回, 但整体返回false并记录错误, 与GetValue一致
+			bool GetMulti(const StringVector & keys, std::unordered_map<std::string, std::string> & values)
+			{
+				TINY_ASSERT(_memcached, "memcached not initialize or nullptr");
+
+				if (keys.empty())
+				{
+					return true;
+				}
+
+				std::vector<std::size_t> keysLength;
+				std::vector<const char *> keysData;
+
+				keysLength.reserve(keys.size());
+				keysData.reserve(keys.size());
+
+				for (auto &iter : keys)
+				{
+					keysData.push_back(iter.data());
+					keysLength.push_back(iter.size());
+				}
+
+				auto ret = memcached_mget(_memcached, keysData.data(), keysLength.data(), keys.size());
+
+				if (ret != MEMCACHED_SUCCESS)
+				{
+					SetError(ret);
+
+					return false;
+				}
+
+				memcached_result_st result;
+
+				if (memcached_result_create(_memcached, &result) == nullptr)
+				{
+					_errorMsg = "memcached_result_create failed";
+
+					return false;
+				}
+
+				bool isCorrupt = false;
+
+				while (memcached_fetch_result(_memcached, &result, &ret) != nullptr)
+				{
+					if (ret != MEMCACHED_SUCCESS)
+					{
+						continue;
+					}
+
+					std::string key(memcached_result_key_value(&result), memcached_result_key_length(&result));
+
+					if (memcached_result_flags(&result) & FLAG_COMPRESSED)
+					{
+						ByteVector storage;
+
+						if (Decompress((const Byte *)memcached_result_value(&result), memcached_result_length(&result), storage))
+						{
+							values[key].assign((const char *)storage.data(), storage.size());
+						}
+						else
+						{
+							isCorrupt = true;
+						}
+					}
+					else
+					{
+						values[key].assign(memcached_result_value(&result), memcached_result_length(&result));
+					}
+				}
+
+				memcached_result_free(&result);
+
+				if (ret != MEMCACHED_END && ret != MEMCACHED_SUCCESS && ret != MEMCACHED_NOTFOUND)
+				{
+					SetError(ret);
+
+					return false;
+				}
+
+				// 结果已全部取完, 连接可以继续使用, 错误信息由Decompress记录
+				return !isCorrupt;
+			}
+
+			// 批量设置, noreply时使用静默命令流水线发送, 不等待逐条应答 (也无法得知单条失败)
+			bool SetMulti(const std::unordered_map<std::string, std::string> & values, bool noreply = true)
+			{
+				TINY_ASSERT(_memcached, "memcached not initialize or nullptr");
+
+				if (!noreply)
+				{
+					bool success = true;
+
+					for (auto &iter : values)
+					{
+						success &= SetValue(iter.first.c_str(), iter.second);
+					}
+
+					return success;
+				}
+
+				return Pipeline
+				(
+					[&](memcached_st * batch)
+					{
+						for (auto &iter : values)
+						{
+							auto ret = Store(batch, iter.first.data(), iter.first.size(), iter.second.data(), iter.second.size(), 0);
+
+							if (ret != MEMCACHED_SUCCESS && ret != MEMCACHED_BUFFERED)
+							{
+								return ret;
+							}
+						}
+
+						return MEMCACHED_SUCCESS;
+					}
+				);
+			}
+
+			// 批量删除, noreply含义同SetMulti
+			bool DeleteMulti(const StringVector & keys, bool noreply = true)
+			{
+				TINY_ASSERT(_memcached, "memcached not initialize or nullptr");
+
+				if (!noreply)
+				{
+					bool success = true;
+
+					for (auto &iter : keys)
+					{
+						success &= DeleteValue(iter);
+					}
+
+					return success;
+				}
+
+				return Pipeline
+				(
+					[&](memcached_st * batch)
+					{
+						for (auto &iter : keys)
+						{
+							auto ret = memcached_delete(batch, iter.data(), iter.size(), 0);
+
+							if (ret != MEMCACHED_SUCCESS && ret != MEMCACHED_BUFFERED)
+							{
+								return ret;
+							}
+						}
+
+						return MEMCACHED_SUCCESS;
+					}
+				);
+			}
+
 			void Release()
 			{
+				if (_batch)
+				{
+					memcached_free(_batch);
+
+					_batch = nullptr;
+				}
+
 				if (_memcached)
 				{
 					memcached_free(_memcached);
@@ -189,12 +549,192 @@ namespace tinyCore
 				return _errorMsg;
 			}
 
+			memcached_return_t LastCode() const
+			{
+				return _lastCode;
+			}
+
+			void ClearError()
+			{
+				_errorMsg.clear();
+
+				_lastCode = MEMCACHED_SUCCESS;
+			}
+
+			// 最近一次错误是否为连接层错误 (连接断开, 超时, 服务器被标记失效等)
+			bool IsConnectionError() const
+			{
+				switch (_lastCode)
+				{
+					case MEMCACHED_ERRNO:
+					case MEMCACHED_TIMEOUT:
+					case MEMCACHED_READ_FAILURE:
+					case MEMCACHED_WRITE_FAILURE:
+					case MEMCACHED_SERVER_MARKED_DEAD:
+					case MEMCACHED_CONNECTION_FAILURE:
+					case MEMCACHED_UNKNOWN_READ_FAILURE:
+					case MEMCACHED_SERVER_TEMPORARILY_DISABLED:
+					{
+						return true;
+					}
+
+					default:
+					{
+						return false;
+					}
+				}
+			}
+
+			// 复制已配置好的句柄 (服务器列表与各项设置), 每个线程使用各自的句柄
+			bool Clone(const Memcached & master)
+			{
+				TINY_ASSERT(_memcached == nullptr, "memcached already initialize")
+				TINY_ASSERT(master._memcached, "master memcached not initialize or nullptr");
+
+				_memcached = memcached_clone(nullptr, master._memcached);
+
+				if (_memcached == nullptr)
+				{
+					_errorMsg = "memcached_clone failed";
+
+					_lastCode = MEMCACHED_MEMORY_ALLOCATION_FAILURE;
+
+					return false;
+				}
+
+				_expiration        = master._expiration;
+				_compressLevel     = master._compressLevel;
+				_compressThreshold = master._compressThreshold;
+
+				return true;
+			}
+
+		protected:
+			void SetError(memcached_return_t ret)
+			{
+				_lastCode = ret;
+
+				_errorMsg = memcached_strerror(_memcached, ret);
+			}
+
+			memcached_return_t Store(const char * key, const std::size_t keyLen, const char * data, const std::size_t len, const uint32_t flags)
+			{
+				return Store(_memcached, key, keyLen, data, len, flags);
+			}
+
+			memcached_return_t Store(memcached_st * memcached, const char * key, const std::size_t keyLen,
+									 const char * data, const std::size_t len, const uint32_t flags)
+			{
+				TINY_ASSERT((flags & FLAG_COMPRESSED) == 0, "compressed flag is reserved");
+
+				if (_compressThreshold > 0 && len >= _compressThreshold)
+				{
+					auto compressed = compress::ZLib::Compress<ByteVector>((const Byte *)data, len, _compressLevel);
+
+					if (compressed.size() < len)
+					{
+						return memcached_set(memcached, key, keyLen, (const char *)compressed.data(), compressed.size(),
+											 _expiration, flags | FLAG_COMPRESSED);
+					}
+				}
+
+				return memcached_set(memcached, key, keyLen, data, len, _expiration, flags);
+			}
+
+			bool Decompress(const Byte * data, const std::size_t len, ByteVector & storage)
+			{
+				try
+				{
+					storage = compress::ZLib::Decompress<ByteVector>(data, len);
+				}
+				catch (...)
+				{
+					_errorMsg = "decompress value failed";
+
+					_lastCode = MEMCACHED_FAILURE;
+
+					return false;
+				}
+
+				return true;
+			}
+
+			// 批量命令走独立句柄, noreply与请求缓冲只在创建时设置一次
+			// (libmemcached修改BUFFER_REQUESTS会断开该句柄的所有连接, 不能在已连接的句柄上来回切换)
+			template <typename FuncT>
+			bool Pipeline(FuncT && func)
+			{
+				if (_batch == nullptr && !CreateBatch())
+				{
+					return false;
+				}
+
+				memcached_return_t ret = func(_batch);
+
+				memcached_return_t flush = memcached_flush_buffers(_batch);
+
+				if (ret == MEMCACHED_SUCCESS)
+				{
+					ret = flush;
+				}
+
+				if (ret != MEMCACHED_SUCCESS)
+				{
+					SetError(ret);
+				}
+
+				return (ret == MEMCACHED_SUCCESS);
+			}
+
+			// 克隆时尚未建立连接, 此时设置不会触发断开
+			bool CreateBatch()
+			{
+				_batch = memcached_clone(nullptr, _memcached);
+
+				if (_batch == nullptr)
+				{
+					_errorMsg = "memcached_clone failed";
+
+					_lastCode = MEMCACHED_MEMORY_ALLOCATION_FAILURE;
+
+					return false;
+				}
+
+				memcached_return_t ret = memcached_behavior_set(_batch, MEMCACHED_BEHAVIOR_NOREPLY, 1);
+
+				if (ret == MEMCACHED_SUCCESS)
+				{
+					ret = memcached_behavior_set(_batch, MEMCACHED_BEHAVIOR_BUFFER_REQUESTS, 1);
+				}
+
+				if (ret != MEMCACHED_SUCCESS)
+				{
+					SetError(ret);
+
+					memcached_free(_batch);
+
+					_batch = nullptr;
+
+					return false;
+				}
+
+				return true;
+			}
+
 		protected:
 			std::time_t _expiration{ 0 };
 
+			int32_t _compressLevel{ compress::ZLib::ZLIB_DEFAULT_COMPRESSION };
+
+			std::size_t _compressThreshold{ 0 };
+
 			std::string _errorMsg{ };
 
+			memcached_return_t _lastCode{ MEMCACHED_SUCCESS };
+
 			memcached_st * _memcached{ nullptr };
+
+			memcached_st * _batch{ nullptr };
 		};
 	}
 }
@@ -0,0 +1,451 @@
+#ifndef __TINY_CORE__CONTAINER__MEMCACHED_NEAR_CACHE__H__
+#define __TINY_CORE__CONTAINER__MEMCACHED_NEAR_CACHE__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: memcached本地近端缓存
+ *
+ *  在进程内缓存热点数据 (短过期时间), 不存在的键也会缓存一小段时间 (负缓存)
+ *
+ *  多个线程同时读取同一个未缓存的键时, 只有一个线程访问memcached, 其他线程等待其结果 (single-flight)
+ *
+ *  写入, 删除与失效会作废进行中的读取, 读取到的旧值不会再写入本地缓存
+ *
+ */
+
+
+#include <tinyCore/container/cache.h>
+#include <tinyCore/container/memcached.h>
+#include <tinyCore/container/memcachedPool.h>
+
+
+namespace tinyCore
+{
+	namespace container
+	{
+		typedef struct NearCacheStatistics
+		{
+			uint64_t hit{ 0 };
+			uint64_t negativeHit{ 0 };
+			uint64_t miss{ 0 };
+			uint64_t coalesce{ 0 };
+			uint64_t backendError{ 0 };
+
+			// 未访问memcached的请求比例
+			double LocalRatio() const
+			{
+				uint64_t total = hit + negativeHit + miss + coalesce;
+
+				return total == 0 ? 0.0 : static_cast<double>(hit + negativeHit + coalesce) / static_cast<double>(total);
+			}
+		}NearCacheStatistics;
+
+		class MemcachedNearCache
+		{
+		public:
+			enum class FETCH_RESULT : uint8_t
+			{
+				FOUND,
+				NOT_FOUND,
+				ERROR,
+			};
+
+			// 后端接口, 可替换为测试桩
+			typedef struct Backend
+			{
+				std::function<FETCH_RESULT(const std::string &, std::string &)> get;
+				std::function<bool(const std::string &, const std::string &)> set;
+				std::function<bool(const std::string &)> del;
+			}Backend;
+
+		protected:
+			struct Entry
+			{
+				bool found{ false };
+
+				std::string value{ };
+			};
+
+			struct Flight
+			{
+				bool done{ false };
+				bool stale{ false };
+
+				FETCH_RESULT result{ FETCH_RESULT::ERROR };
+
+				std::string value{ };
+
+				std::condition_variable condition{ };
+			};
+
+		public:
+			// 容量小于默认分片数时, 本地缓存自动减少分片数
+			MemcachedNearCache(Backend backend, std::size_t capacity,
+							   const SteadyClockDuration & ttl = std::chrono::seconds(1),
+							   const SteadyClockDuration & negativeTTL = std::chrono::milliseconds(200))
+							   : _ttl(ttl),
+								 _negativeTTL(negativeTTL),
+								 _backend(std::move(backend)),
+								 _cache(capacity)
+			{
+
+			}
+
+			// 单个句柄不是线程安全的, 所有后端访问串行执行
+			MemcachedNearCache(Memcached & memcached, std::size_t capacity,
+							   const SteadyClockDuration & ttl = std::chrono::seconds(1),
+							   const SteadyClockDuration & negativeTTL = std::chrono::milliseconds(200))
+							   : MemcachedNearCache(MakeBackend(memcached), capacity, ttl, negativeTTL)
+			{
+
+			}
+
+			MemcachedNearCache(MemcachedPool & pool, std::size_t capacity,
+							   const SteadyClockDuration & ttl = std::chrono::seconds(1),
+							   const SteadyClockDuration & negativeTTL = std::chrono::milliseconds(200))
+							   : MemcachedNearCache(MakeBackend(pool), capacity, ttl, negativeTTL)
+			{
+
+			}
+
+			MemcachedNearCache(const MemcachedNearCache &) = delete;
+			MemcachedNearCache & operator=(const MemcachedNearCache &) = delete;
+
+			bool GetValue(const std::string & key, std::string & value)
+			{
+				Entry entry;
+
+				if (_cache.Get(key, entry))
+				{
+					if (entry.found)
+					{
+						_hit.fetch_add(1, std::memory_order_relaxed);
+
+						value = std::move(entry.value);
+					}
+					else
+					{
+						_negativeHit.fetch_add(1, std::memory_order_relaxed);
+					}
+
+					return entry.found;
+				}
+
+				std::shared_ptr<Flight> flight;
+
+				bool isLeader = false;
+
+				{
+					std::lock_guard<std::mutex> lock(_flightLock);
+
+					auto iter = _flights.find(key);
+
+					if (iter == _flights.end())
+					{
+						flight = std::make_shared<Flight>();
+
+						_flights.emplace(key, flight);
+
+						isLeader = true;
+					}
+					else
+					{
+						flight = iter->second;
+					}
+				}
+
+				if (isLeader)
+				{
+					std::string temp;
+
+					FETCH_RESULT result;
+
+					// 后端或本地缓存抛出异常时同样结束本次请求, 否则等待者与后续请求会永久阻塞
+					try
+					{
+						result = Fetch(key, temp, *flight);
+
+						if (result == FETCH_RESULT::FOUND)
+						{
+							flight->value = temp;
+						}
+					}
+					catch (...)
+					{
+						Complete(key, flight, FETCH_RESULT::ERROR);
+
+						throw;
+					}
+
+					Complete(key, flight, result);
+
+					if (result == FETCH_RESULT::FOUND)
+					{
+						value = std::move(temp);
+					}
+
+					return result == FETCH_RESULT::FOUND;
+				}
+
+				_coalesce.fetch_add(1, std::memory_order_relaxed);
+
+				std::unique_lock<std::mutex> lock(_flightLock);
+
+				flight->condition.wait(lock, [&flight]() { return flight->done; });
+
+				if (flight->result == FETCH_RESULT::FOUND)
+				{
+					value = flight->value;
+				}
+
+				return flight->result == FETCH_RESULT::FOUND;
+			}
+
+			// 写穿到memcached, 成功后更新本地缓存
+			bool SetValue(const std::string & key, const std::string & value)
+			{
+				bool success = _backend.set(key, value);
+
+				Cancel(key);
+
+				if (!success)
+				{
+					_cache.Erase(key);
+
+					return false;
+				}
+
+				_cache.Put(key, Entry{ true, value }, _ttl);
+
+				return true;
+			}
+
+			bool DeleteValue(const std::string & key)
+			{
+				bool success = _backend.del(key);
+
+				Cancel(key);
+
+				_cache.Erase(key);
+
+				return success;
+			}
+
+			// 仅删除本地缓存, 用于收到外部失效通知时
+			void Invalidate(const std::string & key)
+			{
+				Cancel(key);
+
+				_cache.Erase(key);
+			}
+
+			void Clear()
+			{
+				{
+					std::lock_guard<std::mutex> lock(_flightLock);
+
+					for (auto &iter : _flights)
+					{
+						iter.second->stale = true;
+					}
+
+					_flights.clear();
+				}
+
+				_cache.Clear();
+			}
+
+			NearCacheStatistics Statistics() const
+			{
+				NearCacheStatistics statistics;
+
+				statistics.hit          = _hit.load(std::memory_order_relaxed);
+				statistics.negativeHit  = _negativeHit.load(std::memory_order_relaxed);
+				statistics.miss         = _miss.load(std::memory_order_relaxed);
+				statistics.coalesce     = _coalesce.load(std::memory_order_relaxed);
+				statistics.backendError = _backendError.load(std::memory_order_relaxed);
+
+				return statistics;
+			}
+
+		protected:
+			// 唤醒等待者, 并从进行中的请求里移除
+			void Complete(const std::string & key, const std::shared_ptr<Flight> & flight, FETCH_RESULT result)
+			{
+				{
+					std::lock_guard<std::mutex> lock(_flightLock);
+
+					flight->done   = true;
+					flight->result = result;
+
+					// 已被作废的请求可能已让位于新的请求
+					auto iter = _flights.find(key);
+
+					if (iter != _flights.end() && iter->second == flight)
+					{
+						_flights.erase(iter);
+					}
+				}
+
+				flight->condition.notify_all();
+			}
+
+			// 作废进行中的读取, 之后的未命中重新访问后端
+			void Cancel(const std::string & key)
+			{
+				std::lock_guard<std::mutex> lock(_flightLock);
+
+				auto iter = _flights.find(key);
+
+				if (iter != _flights.end())
+				{
+					iter->second->stale = true;
+
+					_flights.erase(iter);
+				}
+			}
+
+			// 与Cancel在同一把锁下判断, 作废后不再回填
+			void Fill(const std::string & key, const Flight & flight, Entry && entry, const SteadyClockDuration & ttl)
+			{
+				std::lock_guard<std::mutex> lock(_flightLock);
+
+				if (!flight.stale)
+				{
+					_cache.Put(key, std::move(entry), ttl);
+				}
+			}
+
+			FETCH_RESULT Fetch(const std::string & key, std::string & value, const Flight & flight)
+			{
+				_miss.fetch_add(1, std::memory_order_relaxed);
+
+				FETCH_RESULT result = _backend.get(key, value);
+
+				switch (result)
+				{
+					case FETCH_RESULT::FOUND:
+					{
+						Fill(key, flight, Entry{ true, value }, _ttl);
+
+						break;
+					}
+
+					case FETCH_RESULT::NOT_FOUND:
+					{
+						Fill(key, flight, Entry{ false, std::string() }, _negativeTTL);
+
+						break;
+					}
+
+					default:
+					{
+						// 后端错误不缓存, 下次请求重试
+						_backendError.fetch_add(1, std::memory_order_relaxed);
+
+						break;
+					}
+				}
+
+				return result;
+			}
+
+			static FETCH_RESULT ToResult(bool success, const Memcached & memcached)
+			{
+				if (success)
+				{
+					return FETCH_RESULT::FOUND;
+				}
+
+				return memcached.LastCode() == MEMCACHED_NOTFOUND ? FETCH_RESULT::NOT_FOUND : FETCH_RESULT::ERROR;
+			}
+
+			static Backend MakeBackend(Memcached & memcached)
+			{
+				auto lock = std::make_shared<std::mutex>();
+
+				Backend backend;
+
+				backend.get = [&memcached, lock](const std::string & key, std::string & value)
+				{
+					std::lock_guard<std::mutex> guard(*lock);
+
+					return ToResult(memcached.GetValue(key.data(), key.size(), value), memcached);
+				};
+
+				backend.set = [&memcached, lock](const std::string & key, const std::string & value)
+				{
+					std::lock_guard<std::mutex> guard(*lock);
+
+					return memcached.SetValue(key.data(), key.size(), value.data(), value.size());
+				};
+
+				backend.del = [&memcached, lock](const std::string & key)
+				{
+					std::lock_guard<std::mutex> guard(*lock);
+
+					return memcached.DeleteValue(key);
+				};
+
+				return backend;
+			}
+
+			static Backend MakeBackend(MemcachedPool & pool)
+			{
+				Backend backend;
+
+				backend.get = [&pool](const std::string & key, std::string & value)
+				{
+					auto handle = pool.Checkout();
+
+					if (!handle)
+					{
+						return FETCH_RESULT::ERROR;
+					}
+
+					return ToResult(handle->GetValue(key.data(), key.size(), value), *handle);
+				};
+
+				backend.set = [&pool](const std::string & key, const std::string & value)
+				{
+					auto handle = pool.Checkout();
+
+					return handle && handle->SetValue(key.data(), key.size(), value.data(), value.size());
+				};
+
+				backend.del = [&pool](const std::string & key)
+				{
+					auto handle = pool.Checkout();
+
+					return handle && handle->DeleteValue(key);
+				};
+
+				return backend;
+			}
+
+		protected:
+			SteadyClockDuration _ttl{ };
+			SteadyClockDuration _negativeTTL{ };
+
+			Backend _backend{ };
+
+			ConcurrentCache<std::string, Entry> _cache;
+
+			std::mutex _flightLock{ };
+
+			std::unordered_map<std::string, std::shared_ptr<Flight>> _flights{ };
+
+			std::atomic<uint64_t> _hit{ 0 };
+			std::atomic<uint64_t> _negativeHit{ 0 };
+			std::atomic<uint64_t> _miss{ 0 };
+			std::atomic<uint64_t> _coalesce{ 0 };
+			std::atomic<uint64_t> _backendError{ 0 };
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__CONTAINER__MEMCACHED_NEAR_CACHE__H__
@@ -0,0 +1,338 @@
+#ifndef __TINY_CORE__CONTAINER__MEMCACHED_POOL__H__
+#define __TINY_CORE__CONTAINER__MEMCACHED_POOL__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: memcached连接池
+ *
+ *  memcached_st 句柄不是线程安全的, 连接池持有一个配置好的主句柄, 按需克隆出有限个工作句柄
+ *
+ *  取出时优先返回该线程上次使用的句柄 (连接已预热), 归还时若本次使用中出现连接层错误则销毁该句柄,
+ *  之后按需重新克隆
+ *
+ */
+
+
+#include <tinyCore/container/memcached.h>
+
+
+namespace tinyCore
+{
+	namespace container
+	{
+		class MemcachedPool
+		{
+			struct Item
+			{
+				Memcached memcached{ };
+
+				std::thread::id owner{ };
+			};
+
+		public:
+			class Handle
+			{
+				friend class MemcachedPool;
+
+			public:
+				Handle() = default;
+
+				Handle(Handle && rhs) noexcept : _pool(rhs._pool), _item(rhs._item)
+				{
+					rhs._pool = nullptr;
+					rhs._item = nullptr;
+				}
+
+				Handle & operator=(Handle && rhs) noexcept
+				{
+					if (this != &rhs)
+					{
+						Reset();
+
+						_pool = rhs._pool;
+						_item = rhs._item;
+
+						rhs._pool = nullptr;
+						rhs._item = nullptr;
+					}
+
+					return *this;
+				}
+
+				Handle(const Handle &) = delete;
+				Handle & operator=(const Handle &) = delete;
+
+				~Handle()
+				{
+					Reset();
+				}
+
+				// 提前归还
+				void Reset()
+				{
+					if (_pool && _item)
+					{
+						_pool->Recover(_item);
+					}
+
+					_pool = nullptr;
+					_item = nullptr;
+				}
+
+				Memcached * operator->() const
+				{
+					return &_item->memcached;
+				}
+
+				Memcached & operator*() const
+				{
+					return _item->memcached;
+				}
+
+				explicit operator bool() const
+				{
+					return _item != nullptr;
+				}
+
+			protected:
+				Handle(MemcachedPool * pool, Item * item) : _pool(pool), _item(item)
+				{
+
+				}
+
+			protected:
+				MemcachedPool * _pool{ nullptr };
+
+				Item * _item{ nullptr };
+			};
+
+		public:
+			MemcachedPool() = default;
+
+			~MemcachedPool()
+			{
+				Release();
+			}
+
+			MemcachedPool(const MemcachedPool &) = delete;
+			MemcachedPool & operator=(const MemcachedPool &) = delete;
+
+			bool Initialize(const char * host = "127.0.0.1", uint16_t port = 11211, std::size_t maxSize = 16)
+			{
+				TINY_THROW_EXCEPTION_IF(maxSize == 0, debug::SizeError, "Pool Size Must Be Greater Than Zero")
+
+				_maxSize = maxSize;
+
+				if (!_master.Initialize(host, port))
+				{
+					_errorMsg = _master.LastError();
+
+					return false;
+				}
+
+				return true;
+			}
+
+			// 需在Initialize之后, 第一次Checkout之前调用
+			void SetExpiration(const std::time_t expiration)
+			{
+				_master.SetExpiration(expiration);
+			}
+
+			// 超时返回空句柄
+			Handle Checkout(const std::chrono::milliseconds & timeout = std::chrono::milliseconds(1000))
+			{
+				auto self = std::this_thread::get_id();
+
+				std::unique_lock<std::mutex> lock(_lock);
+
+				auto deadline = SteadyClock::now() + timeout;
+
+				while (true)
+				{
+					if (!_idle.empty())
+					{
+						auto iter = std::find_if(_idle.begin(), _idle.end(), [&self](Item * item) { return item->owner == self; });
+
+						if (iter == _idle.end())
+						{
+							iter = std::prev(_idle.end());
+						}
+
+						Item * item = *iter;
+
+						_idle.erase(iter);
+
+						return Prepare(item, self);
+					}
+
+					if (_created < _maxSize)
+					{
+						++_created;
+
+						lock.unlock();
+
+						Item * item = Create();
+
+						if (item == nullptr)
+						{
+							lock.lock();
+
+							--_created;
+
+							_condition.notify_one();
+
+							return Handle();
+						}
+
+						return Prepare(item, self);
+					}
+
+					if (_condition.wait_until(lock, deadline) == std::cv_status::timeout && _idle.empty() && _created >= _maxSize)
+					{
+						_errorMsg = "checkout timeout";
+
+						return Handle();
+					}
+				}
+			}
+
+			void Release()
+			{
+				std::unique_lock<std::mutex> lock(_lock);
+
+				TINY_ASSERT(_idle.size() == _created, "memcached handle still checked out")
+
+				for (auto &iter : _idle)
+				{
+					Destroy(iter);
+				}
+
+				_idle.clear();
+
+				_created = 0;
+
+				_master.Release();
+			}
+
+			std::size_t Size()
+			{
+				std::lock_guard<std::mutex> lock(_lock);
+
+				return _created;
+			}
+
+			std::size_t IdleCount()
+			{
+				std::lock_guard<std::mutex> lock(_lock);
+
+				return _idle.size();
+			}
+
+			std::size_t EvictCount() const
+			{
+				return _evictCount.load(std::memory_order_relaxed);
+			}
+
+			std::string LastError()
+			{
+				std::lock_guard<std::mutex> lock(_lock);
+
+				return _errorMsg;
+			}
+
+		protected:
+			Handle Prepare(Item * item, const std::thread::id & self)
+			{
+				item->owner = self;
+
+				item->memcached.ClearError();
+
+				return Handle(this, item);
+			}
+
+			Item * Create()
+			{
+				auto * item = new Item();
+
+				bool success;
+
+				{
+					std::lock_guard<std::mutex> lock(_cloneLock);
+
+					success = item->memcached.Clone(_master);
+				}
+
+				if (!success)
+				{
+					std::lock_guard<std::mutex> lock(_lock);
+
+					_errorMsg = item->memcached.LastError();
+
+					delete item;
+
+					return nullptr;
+				}
+
+				return item;
+			}
+
+			void Recover(Item * item)
+			{
+				bool isBroken = item->memcached.IsConnectionError();
+
+				if (isBroken)
+				{
+					Destroy(item);
+
+					_evictCount.fetch_add(1, std::memory_order_relaxed);
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(_lock);
+
+					if (isBroken)
+					{
+						--_created;
+					}
+					else
+					{
+						_idle.push_back(item);
+					}
+				}
+
+				_condition.notify_one();
+			}
+
+			static void Destroy(Item * item)
+			{
+				item->memcached.Release();
+
+				delete item;
+			}
+
+		protected:
+			Memcached _master{ };
+
+			std::mutex _lock{ };
+			std::mutex _cloneLock{ };
+
+			std::string _errorMsg{ };
+
+			std::size_t _created{ 0 };
+			std::size_t _maxSize{ 16 };
+
+			std::vector<Item *> _idle{ };
+
+			std::atomic<std::size_t> _evictCount{ 0 };
+
+			std::condition_variable _condition{ };
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__CONTAINER__MEMCACHED_POOL__H__
@@ -0,0 +1,1404 @@
+#ifndef __TINY_CORE__CONTAINER__MEMCACHED_SERVER__H__
+#define __TINY_CORE__CONTAINER__MEMCACHED_SERVER__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 内嵌memcached服务 (二进制协议)
+ *
+ *  用于不依赖外部memcached进程的测试与压测, 数据存放在ConcurrentHashMap中, 过期数据在访问时惰性删除
+ *
+ *  每个工作线程持有独立的epoll, 监听套接字加入所有epoll (EPOLLEXCLUSIVE), 连接由接受它的线程独占处理
+ *
+ *  支持 get/getq/getk/getkq, set/add/replace, delete, incr/decr, append/prepend, touch/gat,
+ *  flush, noop, version, stat, quit 及对应的静默命令
+ *
+ */
+
+
+#include <endian.h>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#include <tinyCore/container/concurrentHashMap.h>
+
+
+namespace tinyCore
+{
+	namespace container
+	{
+		typedef struct MemcachedServerStatistics
+		{
+			uint64_t command{ 0 };
+			uint64_t getHit{ 0 };
+			uint64_t getMiss{ 0 };
+			uint64_t connection{ 0 };
+			uint64_t totalConnection{ 0 };
+		}MemcachedServerStatistics;
+
+		class MemcachedServer
+		{
+			enum OPCODE : uint8_t
+			{
+				OPCODE_GET = 0x00,
+				OPCODE_SET = 0x01,
+				OPCODE_ADD = 0x02,
+				OPCODE_REPLACE = 0x03,
+				OPCODE_DELETE = 0x04,
+				OPCODE_INCREMENT = 0x05,
+				OPCODE_DECREMENT = 0x06,
+				OPCODE_QUIT = 0x07,
+				OPCODE_FLUSH = 0x08,
+				OPCODE_GETQ = 0x09,
+				OPCODE_NOOP = 0x0a,
+				OPCODE_VERSION = 0x0b,
+				OPCODE_GETK = 0x0c,
+				OPCODE_GETKQ = 0x0d,
+				OPCODE_APPEND = 0x0e,
+				OPCODE_PREPEND = 0x0f,
+				OPCODE_STAT = 0x10,
+				OPCODE_SETQ = 0x11,
+				OPCODE_ADDQ = 0x12,
+				OPCODE_REPLACEQ = 0x13,
+				OPCODE_DELETEQ = 0x14,
+				OPCODE_INCREMENTQ = 0x15,
+				OPCODE_DECREMENTQ = 0x16,
+				OPCODE_QUITQ = 0x17,
+				OPCODE_FLUSHQ = 0x18,
+				OPCODE_APPENDQ = 0x19,
+				OPCODE_PREPENDQ = 0x1a,
+				OPCODE_TOUCH = 0x1c,
+				OPCODE_GAT = 0x1d,
+				OPCODE_GATQ = 0x1e,
+			};
+
+			enum STATUS : uint16_t
+			{
+				STATUS_SUCCESS = 0x00,
+				STATUS_KEY_NOT_FOUND = 0x01,
+				STATUS_KEY_EXISTS = 0x02,
+				STATUS_VALUE_TOO_LARGE = 0x03,
+				STATUS_INVALID_ARGUMENTS = 0x04,
+				STATUS_NOT_STORED = 0x05,
+				STATUS_DELTA_BAD_VALUE = 0x06,
+				STATUS_UNKNOWN_COMMAND = 0x81,
+			};
+
+			struct Item
+			{
+				std::string value{ };
+
+				uint32_t flags{ 0 };
+
+				uint64_t cas{ 0 };
+
+				std::time_t expire{ 0 };
+			};
+
+			struct Header
+			{
+				uint8_t opcode{ 0 };
+				uint8_t extLen{ 0 };
+
+				uint16_t keyLen{ 0 };
+
+				uint32_t bodyLen{ 0 };
+				uint32_t opaque{ 0 };
+
+				uint64_t cas{ 0 };
+			};
+
+			struct Connection
+			{
+				int fd{ -1 };
+
+				bool isClosing{ false };
+				bool isWriting{ false };
+
+				std::size_t inputPos{ 0 };
+				std::size_t outputPos{ 0 };
+
+				std::string input{ };
+				std::string output{ };
+			};
+
+			// 统计只由所属线程写入, 分开缓存行避免伪共享
+			struct alignas(64) Worker
+			{
+				int epollFd{ -1 };
+
+				std::thread thread{ };
+
+				std::atomic<uint64_t> command{ 0 };
+				std::atomic<uint64_t> getHit{ 0 };
+				std::atomic<uint64_t> getMiss{ 0 };
+				std::atomic<uint64_t> connection{ 0 };
+				std::atomic<uint64_t> totalConnection{ 0 };
+			};
+
+		public:
+			MemcachedServer() = default;
+
+			~MemcachedServer()
+			{
+				Stop();
+			}
+
+			MemcachedServer(const MemcachedServer &) = delete;
+			MemcachedServer & operator=(const MemcachedServer &) = delete;
+
+			// port为0时由系统分配, 启动后通过Port获取
+			bool Start(const char * host = "127.0.0.1", uint16_t port = 0, std::size_t threadCount = 4)
+			{
+				TINY_ASSERT(host, "host is nullptr");
+				TINY_ASSERT(!_isRunning.load(), "memcached server already start");
+
+				TINY_THROW_EXCEPTION_IF(threadCount == 0, debug::SizeError, "Thread Count Must Be Greater Than Zero")
+
+				if (!Listen(host, port))
+				{
+					Close();
+
+					return false;
+				}
+
+				_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+				if (_eventFd == -1)
+				{
+					SetError("eventfd");
+
+					Close();
+
+					return false;
+				}
+
+				for (std::size_t i = 0; i < threadCount; ++i)
+				{
+					auto worker = std::make_unique<Worker>();
+
+					worker->epollFd = epoll_create1(EPOLL_CLOEXEC);
+
+					if (worker->epollFd == -1)
+					{
+						SetError("epoll_create1");
+
+						Close();
+
+						return false;
+					}
+
+					epoll_event listenEvent{ };
+
+					listenEvent.events   = EPOLLIN;
+					listenEvent.data.ptr = nullptr;
+
+				#ifdef EPOLLEXCLUSIVE
+
+					listenEvent.events |= EPOLLEXCLUSIVE;
+
+				#endif
+
+					epoll_event stopEvent{ };
+
+					stopEvent.events   = EPOLLIN;
+					stopEvent.data.ptr = this;
+
+					_workers.push_back(std::move(worker));
+
+					if (epoll_ctl(_workers.back()->epollFd, EPOLL_CTL_ADD, _listenFd, &listenEvent) == -1 ||
+						epoll_ctl(_workers.back()->epollFd, EPOLL_CTL_ADD, _eventFd, &stopEvent) == -1)
+					{
+						SetError("epoll_ctl");
+
+						Close();
+
+						return false;
+					}
+				}
+
+				_isRunning.store(true);
+
+				for (auto &iter : _workers)
+				{
+					Worker * worker = iter.get();
+
+					worker->thread = std::thread([this, worker]() { Run(*worker); });
+				}
+
+				return true;
+			}
+
+			void Stop()
+			{
+				if (!_isRunning.exchange(false))
+				{
+					return;
+				}
+
+				// eventfd不读取, 保持可读以唤醒所有线程
+				uint64_t one = 1;
+
+				ssize_t ret = write(_eventFd, &one, sizeof(one));
+
+				(void)ret;
+
+				for (auto &iter : _workers)
+				{
+					if (iter->thread.joinable())
+					{
+						iter->thread.join();
+					}
+				}
+
+				Close();
+			}
+
+			bool IsRunning() const
+			{
+				return _isRunning.load();
+			}
+
+			uint16_t Port() const
+			{
+				return _port;
+			}
+
+			// 需在Start之前调用
+			void SetMaxValueSize(const std::size_t size)
+			{
+				_maxValueSize = size;
+			}
+
+			std::size_t ItemCount() const
+			{
+				return _items.Size();
+			}
+
+			const std::string & LastError() const
+			{
+				return _errorMsg;
+			}
+
+			MemcachedServerStatistics Statistics() const
+			{
+				MemcachedServerStatistics statistics;
+
+				for (auto &iter : _workers)
+				{
+					statistics.command         += iter->command.load(std::memory_order_relaxed);
+					statistics.getHit          += iter->getHit.load(std::memory_order_relaxed);
+					statistics.getMiss         += iter->getMiss.load(std::memory_order_relaxed);
+					statistics.connection      += iter->connection.load(std::memory_order_relaxed);
+					statistics.totalConnection += iter->totalConnection.load(std::memory_order_relaxed);
+				}
+
+				return statistics;
+			}
+
+		protected:
+			bool Listen(const char * host, uint16_t port)
+			{
+				_listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+				if (_listenFd == -1)
+				{
+					SetError("socket");
+
+					return false;
+				}
+
+				int32_t on = 1;
+
+				setsockopt(_listenFd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+				sockaddr_in address{ };
+
+				address.sin_family = AF_INET;
+				address.sin_port   = htons(port);
+
+				if (inet_pton(AF_INET, host, &address.sin_addr) != 1)
+				{
+					_errorMsg = TINY_STR_FORMAT("invalid host {}", host);
+
+					return false;
+				}
+
+				if (bind(_listenFd, (sockaddr *)&address, sizeof(address)) == -1)
+				{
+					SetError("bind");
+
+					return false;
+				}
+
+				if (listen(_listenFd, SOMAXCONN) == -1)
+				{
+					SetError("listen");
+
+					return false;
+				}
+
+				socklen_t len = sizeof(address);
+
+				if (getsockname(_listenFd, (sockaddr *)&address, &len) == -1)
+				{
+					SetError("getsockname");
+
+					return false;
+				}
+
+				_port = ntohs(address.sin_port);
+
+				return true;
+			}
+
+			void Close()
+			{
+				for (auto &iter : _workers)
+				{
+					if (iter->epollFd != -1)
+					{
+						close(iter->epollFd);
+					}
+				}
+
+				_workers.clear();
+
+				if (_eventFd != -1)
+				{
+					close(_eventFd);
+
+					_eventFd = -1;
+				}
+
+				if (_listenFd != -1)
+				{
+					close(_listenFd);
+
+					_listenFd = -1;
+				}
+			}
+
+			void Run(Worker & worker)
+			{
+				std::unordered_map<Connection *, std::unique_ptr<Connection>> connections;
+
+				epoll_event events[128];
+
+				while (_isRunning.load(std::memory_order_relaxed))
+				{
+					int32_t count = epoll_wait(worker.epollFd, events, 128, -1);
+
+					if (count == -1)
+					{
+						if (errno == EINTR)
+						{
+							continue;
+						}
+
+						break;
+					}
+
+					for (int32_t i = 0; i < count; ++i)
+					{
+						void * ptr = events[i].data.ptr;
+
+						if (ptr == this)
+						{
+							continue;
+						}
+
+						if (ptr == nullptr)
+						{
+							Accept(worker, connections);
+
+							continue;
+						}
+
+						auto * connection = static_cast<Connection *>(ptr);
+
+						bool isAlive = true;
+
+						if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+						{
+							isAlive = OnRead(worker, *connection);
+						}
+
+						if (isAlive)
+						{
+							isAlive = OnWrite(worker, *connection);
+						}
+
+						if (!isAlive)
+						{
+							epoll_ctl(worker.epollFd, EPOLL_CTL_DEL, connection->fd, nullptr);
+
+							close(connection->fd);
+
+							connections.erase(connection);
+
+							worker.connection.fetch_sub(1, std::memory_order_relaxed);
+						}
+					}
+				}
+
+				for (auto &iter : connections)
+				{
+					close(iter.second->fd);
+				}
+
+				worker.connection.store(0, std::memory_order_relaxed);
+			}
+
+			// 每次只接受一个连接, 水平触发下剩余连接会唤醒其他线程, 使连接分布均匀
+			void Accept(Worker & worker, std::unordered_map<Connection *, std::unique_ptr<Connection>> & connections)
+			{
+				int fd = accept4(_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+				if (fd == -1)
+				{
+					return;
+				}
+
+				int32_t on = 1;
+
+				setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+				auto connection = std::make_unique<Connection>();
+
+				connection->fd = fd;
+
+				epoll_event event{ };
+
+				event.events   = EPOLLIN;
+				event.data.ptr = connection.get();
+
+				if (epoll_ctl(worker.epollFd, EPOLL_CTL_ADD, fd, &event) == -1)
+				{
+					close(fd);
+
+					return;
+				}
+
+				connections.emplace(connection.get(), std::move(connection));
+
+				worker.connection.fetch_add(1, std::memory_order_relaxed);
+				worker.totalConnection.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			bool OnRead(Worker & worker, Connection & connection)
+			{
+				static const std::size_t READ_SIZE = 64 * TINY_KB;
+
+				while (true)
+				{
+					std::size_t size = connection.input.size();
+
+					connection.input.resize(size + READ_SIZE);
+
+					ssize_t len = read(connection.fd, &connection.input[size], READ_SIZE);
+
+					connection.input.resize(size + (len > 0 ? len : 0));
+
+					if (len > 0)
+					{
+						continue;
+					}
+
+					if (len == 0)
+					{
+						return false;
+					}
+
+					if (errno == EINTR)
+					{
+						continue;
+					}
+
+					if (errno == EAGAIN || errno == EWOULDBLOCK)
+					{
+						break;
+					}
+
+					return false;
+				}
+
+				return Process(worker, connection);
+			}
+
+			bool OnWrite(Worker & worker, Connection & connection)
+			{
+				while (connection.outputPos < connection.output.size())
+				{
+					ssize_t len = send(connection.fd, connection.output.data() + connection.outputPos,
+									   connection.output.size() - connection.outputPos, MSG_NOSIGNAL);
+
+					if (len > 0)
+					{
+						connection.outputPos += len;
+					}
+					else if (len == -1 && errno == EINTR)
+					{
+						continue;
+					}
+					else if (len == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+					{
+						break;
+					}
+					else
+					{
+						return false;
+					}
+				}
+
+				bool isPending = connection.outputPos < connection.output.size();
+
+				if (!isPending)
+				{
+					connection.output.clear();
+
+					connection.outputPos = 0;
+
+					if (connection.isClosing)
+					{
+						return false;
+					}
+				}
+
+				// 仅在有数据积压时关注可写事件
+				if (isPending != connection.isWriting)
+				{
+					epoll_event event{ };
+
+					event.events   = isPending ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+					event.data.ptr = &connection;
+
+					if (epoll_ctl(worker.epollFd, EPOLL_CTL_MOD, connection.fd, &event) == -1)
+					{
+						return false;
+					}
+
+					connection.isWriting = isPending;
+				}
+
+				return true;
+			}
+
+			bool Process(Worker & worker, Connection & connection)
+			{
+				static const std::size_t HEADER_SIZE = 24;
+
+				while (!connection.isClosing && connection.input.size() - connection.inputPos >= HEADER_SIZE)
+				{
+					const char * data = connection.input.data() + connection.inputPos;
+
+					if (static_cast<uint8_t>(data[0]) != 0x80)
+					{
+						return false;
+					}
+
+					Header header;
+
+					header.opcode  = static_cast<uint8_t>(data[1]);
+					header.keyLen  = Load16(data + 2);
+					header.extLen  = static_cast<uint8_t>(data[4]);
+					header.bodyLen = Load32(data + 8);
+					header.cas     = Load64(data + 16);
+
+					memcpy(&header.opaque, data + 12, sizeof(header.opaque));
+
+					// 超大请求无法缓冲, 直接断开
+					if (header.bodyLen > _maxValueSize + TINY_KB)
+					{
+						return false;
+					}
+
+					if (connection.input.size() - connection.inputPos < HEADER_SIZE + header.bodyLen)
+					{
+						break;
+					}
+
+					connection.inputPos += HEADER_SIZE + header.bodyLen;
+
+					worker.command.fetch_add(1, std::memory_order_relaxed);
+
+					if (header.extLen + header.keyLen > header.bodyLen)
+					{
+						Respond(connection.output, header, STATUS_INVALID_ARGUMENTS);
+
+						continue;
+					}
+
+					const char * extras = data + HEADER_SIZE;
+					const char * key    = extras + header.extLen;
+					const char * value  = key + header.keyLen;
+
+					Dispatch(worker, connection, header, extras, std::string_view(key, header.keyLen),
+							 value, header.bodyLen - header.extLen - header.keyLen);
+				}
+
+				if (connection.inputPos == connection.input.size())
+				{
+					connection.input.clear();
+				}
+				else
+				{
+					connection.input.erase(0, connection.inputPos);
+				}
+
+				connection.inputPos = 0;
+
+				return true;
+			}
+
+			void Dispatch(Worker & worker, Connection & connection, const Header & header, const char * extras,
+						  const std::string_view & key, const char * value, const std::size_t valueLen)
+			{
+				std::string & output = connection.output;
+
+				std::time_t now = std::time(nullptr);
+
+				switch (header.opcode)
+				{
+					case OPCODE_GET:
+					case OPCODE_GETQ:
+					case OPCODE_GETK:
+					case OPCODE_GETKQ:
+					case OPCODE_GAT:
+					case OPCODE_GATQ:
+					case OPCODE_TOUCH:
+					{
+						Get(worker, output, header, extras, key, now);
+
+						break;
+					}
+
+					case OPCODE_SET:
+					case OPCODE_SETQ:
+					case OPCODE_ADD:
+					case OPCODE_ADDQ:
+					case OPCODE_REPLACE:
+					case OPCODE_REPLACEQ:
+					{
+						Store(output, header, extras, key, value, valueLen, now);
+
+						break;
+					}
+
+					case OPCODE_APPEND:
+					case OPCODE_APPENDQ:
+					case OPCODE_PREPEND:
+					case OPCODE_PREPENDQ:
+					{
+						Concat(output, header, key, value, valueLen, now);
+
+						break;
+					}
+
+					case OPCODE_DELETE:
+					case OPCODE_DELETEQ:
+					{
+						Delete(output, header, key, now);
+
+						break;
+					}
+
+					case OPCODE_INCREMENT:
+					case OPCODE_INCREMENTQ:
+					case OPCODE_DECREMENT:
+					case OPCODE_DECREMENTQ:
+					{
+						Arithmetic(output, header, extras, key, now);
+
+						break;
+					}
+
+					case OPCODE_FLUSH:
+					case OPCODE_FLUSHQ:
+					{
+						_items.Clear();
+
+						if (header.opcode == OPCODE_FLUSH)
+						{
+							Respond(output, header, STATUS_SUCCESS);
+						}
+
+						break;
+					}
+
+					case OPCODE_QUIT:
+					case OPCODE_QUITQ:
+					{
+						if (header.opcode == OPCODE_QUIT)
+						{
+							Respond(output, header, STATUS_SUCCESS);
+						}
+
+						connection.isClosing = true;
+
+						break;
+					}
+
+					case OPCODE_NOOP:
+					{
+						Respond(output, header, STATUS_SUCCESS);
+
+						break;
+					}
+
+					case OPCODE_VERSION:
+					{
+						static const std::string version = "1.6.0";
+
+						Respond(output, header, STATUS_SUCCESS, 0, nullptr, 0, std::string_view(), version.data(), version.size());
+
+						break;
+					}
+
+					case OPCODE_STAT:
+					{
+						Stat(output, header, key);
+
+						break;
+					}
+
+					default:
+					{
+						RespondError(output, header, STATUS_UNKNOWN_COMMAND);
+
+						break;
+					}
+				}
+			}
+
+			// get/getq/getk/getkq, 以及带过期时间的touch/gat/gatq
+			void Get(Worker & worker, std::string & output, const Header & header, const char * extras,
+					 const std::string_view & key, const std::time_t now)
+			{
+				bool isTouch = header.opcode == OPCODE_TOUCH || header.opcode == OPCODE_GAT || header.opcode == OPCODE_GATQ;
+				bool isQuiet = header.opcode == OPCODE_GETQ || header.opcode == OPCODE_GETKQ || header.opcode == OPCODE_GATQ;
+				bool withKey = header.opcode == OPCODE_GETK || header.opcode == OPCODE_GETKQ;
+
+				if (key.empty() || header.extLen != (isTouch ? 4 : 0))
+				{
+					RespondError(output, header, STATUS_INVALID_ARGUMENTS);
+
+					return;
+				}
+
+				bool isHit = false;
+
+				auto respond = [&](const Item & item)
+				{
+					if (IsExpired(item, now))
+					{
+						return;
+					}
+
+					isHit = true;
+
+					if (header.opcode == OPCODE_TOUCH)
+					{
+						Respond(output, header, STATUS_SUCCESS, item.cas);
+
+						return;
+					}
+
+					uint32_t flags = htonl(item.flags);
+
+					Respond(output, header, STATUS_SUCCESS, item.cas, &flags, sizeof(flags),
+							withKey ? key : std::string_view(), item.value.data(), item.value.size());
+				};
+
+				if (isTouch)
+				{
+					std::time_t expire = ToExpire(Load32(extras), now);
+
+					_items.Update
+					(
+						key,
+
+						[&](Item & item)
+						{
+							if (!IsExpired(item, now))
+							{
+								item.expire = expire;
+							}
+
+							respond(item);
+						}
+					);
+				}
+				else
+				{
+					_items.Visit(key, respond);
+				}
+
+				if (isHit)
+				{
+					worker.getHit.fetch_add(1, std::memory_order_relaxed);
+
+					return;
+				}
+
+				worker.getMiss.fetch_add(1, std::memory_order_relaxed);
+
+				_items.EraseIf(key, [now](const Item & item) { return IsExpired(item, now); });
+
+				if (!isQuiet)
+				{
+					RespondError(output, header, STATUS_KEY_NOT_FOUND, withKey ? key : std::string_view());
+				}
+			}
+
+			// set/add/replace, 请求带cas时仅在cas一致时覆盖
+			void Store(std::string & output, const Header & header, const char * extras, const std::string_view & key,
+					   const char * value, const std::size_t valueLen, const std::time_t now)
+			{
+				bool isQuiet = header.opcode == OPCODE_SETQ || header.opcode == OPCODE_ADDQ || header.opcode == OPCODE_REPLACEQ;
+
+				if (key.empty() || header.extLen != 8)
+				{
+					RespondError(output, header, STATUS_INVALID_ARGUMENTS);
+
+					return;
+				}
+
+				if (valueLen > _maxValueSize)
+				{
+					RespondError(output, header, STATUS_VALUE_TOO_LARGE);
+
+					return;
+				}
+
+				Item fresh;
+
+				fresh.value.assign(value, valueLen);
+
+				fresh.flags  = Load32(extras);
+				fresh.expire = ToExpire(Load32(extras + 4), now);
+				fresh.cas    = _casId.fetch_add(1, std::memory_order_relaxed) + 1;
+
+				uint64_t cas = fresh.cas;
+
+				uint16_t status = STATUS_SUCCESS;
+
+				auto replace = [&](Item & item)
+				{
+					if (IsExpired(item, now))
+					{
+						status = STATUS_KEY_NOT_FOUND;
+					}
+					else if (header.cas != 0 && header.cas != item.cas)
+					{
+						status = STATUS_KEY_EXISTS;
+					}
+					else
+					{
+						item = std::move(fresh);
+					}
+				};
+
+				if (header.opcode == OPCODE_ADD || header.opcode == OPCODE_ADDQ)
+				{
+					_items.Upsert
+					(
+						std::string(key), std::move(fresh),
+
+						[&](Item & item)
+						{
+							if (IsExpired(item, now))
+							{
+								item = std::move(fresh);
+							}
+							else
+							{
+								status = STATUS_KEY_EXISTS;
+							}
+						}
+					);
+				}
+				else if ((header.opcode == OPCODE_SET || header.opcode == OPCODE_SETQ) && header.cas == 0)
+				{
+					_items.Upsert(std::string(key), std::move(fresh));
+				}
+				else if (!_items.Update(key, replace))
+				{
+					status = STATUS_KEY_NOT_FOUND;
+				}
+
+				if (status != STATUS_SUCCESS)
+				{
+					RespondError(output, header, status);
+				}
+				else if (!isQuiet)
+				{
+					Respond(output, header, STATUS_SUCCESS, cas);
+				}
+			}
+
+			void Concat(std::string & output, const Header & header, const std::string_view & key,
+						const char * value, const std::size_t valueLen, const std::time_t now)
+			{
+				bool isQuiet  = header.opcode == OPCODE_APPENDQ || header.opcode == OPCODE_PREPENDQ;
+				bool isAppend = header.opcode == OPCODE_APPEND || header.opcode == OPCODE_APPENDQ;
+
+				if (key.empty() || header.extLen != 0)
+				{
+					RespondError(output, header, STATUS_INVALID_ARGUMENTS);
+
+					return;
+				}
+
+				uint64_t cas = 0;
+
+				uint16_t status = STATUS_SUCCESS;
+
+				bool isFound = _items.Update
+				(
+					key,
+
+					[&](Item & item)
+					{
+						if (IsExpired(item, now))
+						{
+							status = STATUS_NOT_STORED;
+						}
+						else if (header.cas != 0 && header.cas != item.cas)
+						{
+							status = STATUS_KEY_EXISTS;
+						}
+						else if (item.value.size() + valueLen > _maxValueSize)
+						{
+							status = STATUS_VALUE_TOO_LARGE;
+						}
+						else
+						{
+							if (isAppend)
+							{
+								item.value.append(value, valueLen);
+							}
+							else
+							{
+								item.value.insert(0, value, valueLen);
+							}
+
+							item.cas = cas = _casId.fetch_add(1, std::memory_order_relaxed) + 1;
+						}
+					}
+				);
+
+				if (!isFound)
+				{
+					status = STATUS_NOT_STORED;
+				}
+
+				if (status != STATUS_SUCCESS)
+				{
+					RespondError(output, header, status);
+				}
+				else if (!isQuiet)
+				{
+					Respond(output, header, STATUS_SUCCESS, cas);
+				}
+			}
+
+			void Delete(std::string & output, const Header & header, const std::string_view & key, const std::time_t now)
+			{
+				if (key.empty() || header.extLen != 0)
+				{
+					RespondError(output, header, STATUS_INVALID_ARGUMENTS);
+
+					return;
+				}
+
+				uint16_t status = STATUS_SUCCESS;
+
+				bool isErased = _items.EraseIf
+				(
+					key,
+
+					[&](const Item & item)
+					{
+						if (IsExpired(item, now))
+						{
+							status = STATUS_KEY_NOT_FOUND;
+
+							return true;
+						}
+
+						if (header.cas != 0 && header.cas != item.cas)
+						{
+							status = STATUS_KEY_EXISTS;
+
+							return false;
+						}
+
+						return true;
+					}
+				);
+
+				if (!isErased && status == STATUS_SUCCESS)
+				{
+					status = STATUS_KEY_NOT_FOUND;
+				}
+
+				if (status != STATUS_SUCCESS)
+				{
+					RespondError(output, header, status);
+				}
+				else if (header.opcode == OPCODE_DELETE)
+				{
+					Respond(output, header, STATUS_SUCCESS);
+				}
+			}
+
+			// 键不存在时以initial创建, 过期时间为0xffffffff时不创建
+			void Arithmetic(std::string & output, const Header & header, const char * extras, const std::string_view & key, const std::time_t now)
+			{
+				bool isQuiet     = header.opcode == OPCODE_INCREMENTQ || header.opcode == OPCODE_DECREMENTQ;
+				bool isIncrement = header.opcode == OPCODE_INCREMENT || header.opcode == OPCODE_INCREMENTQ;
+
+				if (key.empty() || header.extLen != 20)
+				{
+					RespondError(output, header, STATUS_INVALID_ARGUMENTS);
+
+					return;
+				}
+
+				uint64_t delta   = Load64(extras);
+				uint64_t initial = Load64(extras + 8);
+				uint32_t exptime = Load32(extras + 16);
+
+				uint64_t cas = 0;
+				uint64_t result = initial;
+
+				uint16_t status = STATUS_SUCCESS;
+
+				Item fresh;
+
+				fresh.value  = std::to_string(initial);
+				fresh.expire = ToExpire(exptime, now);
+				fresh.cas    = _casId.fetch_add(1, std::memory_order_relaxed) + 1;
+
+				auto apply = [&](Item & item)
+				{
+					if (IsExpired(item, now))
+					{
+						if (exptime == 0xffffffff)
+						{
+							status = STATUS_KEY_NOT_FOUND;
+						}
+						else
+						{
+							item = std::move(fresh);
+
+							cas = item.cas;
+						}
+
+						return;
+					}
+
+					if (header.cas != 0 && header.cas != item.cas)
+					{
+						status = STATUS_KEY_EXISTS;
+
+						return;
+					}
+
+					uint64_t current = 0;
+
+					if (!ParseUInt64(item.value, current))
+					{
+						status = STATUS_DELTA_BAD_VALUE;
+
+						return;
+					}
+
+					if (isIncrement)
+					{
+						result = current + delta;
+					}
+					else
+					{
+						result = current < delta ? 0 : current - delta;
+					}
+
+					item.value = std::to_string(result);
+
+					item.cas = cas = _casId.fetch_add(1, std::memory_order_relaxed) + 1;
+				};
+
+				if (exptime == 0xffffffff)
+				{
+					if (!_items.Update(key, apply))
+					{
+						status = STATUS_KEY_NOT_FOUND;
+					}
+				}
+				else
+				{
+					cas = fresh.cas;
+
+					_items.Upsert(std::string(key), std::move(fresh), apply);
+				}
+
+				if (status != STATUS_SUCCESS)
+				{
+					RespondError(output, header, status);
+				}
+				else if (!isQuiet)
+				{
+					uint64_t value = htobe64(result);
+
+					Respond(output, header, STATUS_SUCCESS, cas, nullptr, 0, std::string_view(), (const char *)&value, sizeof(value));
+				}
+			}
+
+			// 逐条返回统计项, 以空键结束; 不支持分组统计
+			void Stat(std::string & output, const Header & header, const std::string_view & key)
+			{
+				if (key.empty())
+				{
+					auto statistics = Statistics();
+
+					std::vector<std::pair<std::string, std::string>> stats =
+					{
+						{ "pid",               std::to_string(getpid()) },
+						{ "version",           "1.6.0" },
+						{ "threads",           std::to_string(_workers.size()) },
+						{ "curr_items",        std::to_string(ItemCount()) },
+						{ "curr_connections",  std::to_string(statistics.connection) },
+						{ "total_connections", std::to_string(statistics.totalConnection) },
+						{ "cmd_total",         std::to_string(statistics.command) },
+						{ "get_hits",          std::to_string(statistics.getHit) },
+						{ "get_misses",        std::to_string(statistics.getMiss) },
+					};
+
+					for (auto &iter : stats)
+					{
+						Respond(output, header, STATUS_SUCCESS, 0, nullptr, 0, iter.first, iter.second.data(), iter.second.size());
+					}
+				}
+
+				Respond(output, header, STATUS_SUCCESS);
+			}
+
+			static void Respond(std::string & output, const Header & header, const uint16_t status, const uint64_t cas = 0,
+								const void * extras = nullptr, const uint8_t extLen = 0, const std::string_view & key = std::string_view(),
+								const char * value = nullptr, const std::size_t valueLen = 0)
+			{
+				char data[24];
+
+				data[0] = static_cast<char>(0x81);
+				data[1] = static_cast<char>(header.opcode);
+				data[4] = static_cast<char>(extLen);
+				data[5] = 0;
+
+				Store16(data + 2, static_cast<uint16_t>(key.size()));
+				Store16(data + 6, status);
+				Store32(data + 8, static_cast<uint32_t>(extLen + key.size() + valueLen));
+				Store64(data + 16, cas);
+
+				memcpy(data + 12, &header.opaque, sizeof(header.opaque));
+
+				output.append(data, sizeof(data));
+
+				if (extLen > 0)
+				{
+					output.append((const char *)extras, extLen);
+				}
+
+				output.append(key.data(), key.size());
+
+				if (valueLen > 0)
+				{
+					output.append(value, valueLen);
+				}
+			}
+
+			static void RespondError(std::string & output, const Header & header, const uint16_t status, const std::string_view & key = std::string_view())
+			{
+				const char * message = StatusMessage(status);
+
+				Respond(output, header, status, 0, nullptr, 0, key, message, strlen(message));
+			}
+
+			static const char * StatusMessage(const uint16_t status)
+			{
+				switch (status)
+				{
+					case STATUS_KEY_NOT_FOUND:
+					{
+						return "Not found";
+					}
+
+					case STATUS_KEY_EXISTS:
+					{
+						return "Data exists for key.";
+					}
+
+					case STATUS_VALUE_TOO_LARGE:
+					{
+						return "Too large.";
+					}
+
+					case STATUS_INVALID_ARGUMENTS:
+					{
+						return "Invalid arguments";
+					}
+
+					case STATUS_NOT_STORED:
+					{
+						return "Not stored.";
+					}
+
+					case STATUS_DELTA_BAD_VALUE:
+					{
+						return "Non-numeric server-side value for incr or decr";
+					}
+
+					case STATUS_UNKNOWN_COMMAND:
+					{
+						return "Unknown command";
+					}
+
+					default:
+					{
+						return "Unknown error";
+					}
+				}
+			}
+
+			// 不超过30天为相对秒数, 否则为绝对时间戳
+			static std::time_t ToExpire(const uint32_t exptime, const std::time_t now)
+			{
+				if (exptime == 0)
+				{
+					return 0;
+				}
+
+				if (exptime <= 60 * 60 * 24 * 30)
+				{
+					return now + exptime;
+				}
+
+				return static_cast<std::time_t>(exptime);
+			}
+
+			static bool IsExpired(const Item & item, const std::time_t now)
+			{
+				return item.expire != 0 && item.expire <= now;
+			}
+
+			static bool ParseUInt64(const std::string & value, uint64_t & result)
+			{
+				if (value.empty() || value.size() > 20)
+				{
+					return false;
+				}
+
+				result = 0;
+
+				for (char c : value)
+				{
+					if (c < '0' || c > '9')
+					{
+						return false;
+					}
+
+					uint64_t next = result * 10 + (c - '0');
+
+					if (next / 10 != result)
+					{
+						return false;
+					}
+
+					result = next;
+				}
+
+				return true;
+			}
+
+			static uint16_t Load16(const char * data)
+			{
+				uint16_t value;
+
+				memcpy(&value, data, sizeof(value));
+
+				return be16toh(value);
+			}
+
+			static uint32_t Load32(const char * data)
+			{
+				uint32_t value;
+
+				memcpy(&value, data, sizeof(value));
+
+				return be32toh(value);
+			}
+
+			static uint64_t Load64(const char * data)
+			{
+				uint64_t value;
+
+				memcpy(&value, data, sizeof(value));
+
+				return be64toh(value);
+			}
+
+			static void Store16(char * data, const uint16_t value)
+			{
+				uint16_t temp = htobe16(value);
+
+				memcpy(data, &temp, sizeof(temp));
+			}
+
+			static void Store32(char * data, const uint32_t value)
+			{
+				uint32_t temp = htobe32(value);
+
+				memcpy(data, &temp, sizeof(temp));
+			}
+
+			static void Store64(char * data, const uint64_t value)
+			{
+				uint64_t temp = htobe64(value);
+
+				memcpy(data, &temp, sizeof(temp));
+			}
+
+			void SetError(const char * func)
+			{
+				_errorMsg = TINY_STR_FORMAT("{} failed: {}", func, strerror(errno));
+			}
+
+		protected:
+			int _eventFd{ -1 };
+			int _listenFd{ -1 };
+
+			uint16_t _port{ 0 };
+
+			std::size_t _maxValueSize{ TINY_MB };
+
+			std::string _errorMsg{ };
+
+			std::atomic<bool> _isRunning{ false };
+
+			std::atomic<uint64_t> _casId{ 0 };
+
+			std::vector<std::unique_ptr<Worker>> _workers{ };
+
+			ConcurrentHashMap<std::string, Item> _items{ };
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__CONTAINER__MEMCACHED_SERVER__H__
@@ -41,6 +41,14 @@ namespace tinyCore
 
 			}
 
+			// 接管已有存储, 可读区间为 [readPos, writePos)
+			Message(ByteVector && storage, const std::size_t readPos, const std::size_t writePos) : _readPos(readPos),
+																								   _writePos(writePos),
+																								   _storage(std::move(storage))
+			{
+				TINY_ASSERT(_readPos <= _writePos && _writePos <= _storage.size(), "wtf");
+			}
+
 			Message(Message && rhs) noexcept : _readPos(rhs._readPos), _writePos(rhs._writePos), _storage(rhs.Move())
 			{
 
@@ -124,7 +132,7 @@ namespace tinyCore
 			{
 				if (UnWriteSize() < bytes)
 				{
-					_storage.resize(Size() + bytes - UnWriteSize());
+					_storage.resize(_writePos + bytes);
 				}
 			}
 
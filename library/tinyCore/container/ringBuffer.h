@@ -0,0 +1,295 @@
+#ifndef __TINY_CORE__CONTAINER__RING_BUFFER__H__
+#define __TINY_CORE__CONTAINER__RING_BUFFER__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 镜像环形字节缓冲区
+ *
+ *  同一块memfd内存在虚拟地址上连续映射两次, 越过末尾的访问落到第二份映射上, 即回到开头,
+ *  因此任意可读或可写区间都是连续的, 可以直接交给read/write系统调用或就地解析, 无需处理回绕
+ *
+ *  AtomicT为NullAtomic时用于单线程, 为std::atomic时支持单生产者单消费者无锁访问
+ *
+ */
+
+
+#include <tinyCore/lock/atomic.h>
+#include <tinyCore/debug/trace.h>
+
+
+namespace tinyCore
+{
+	namespace container
+	{
+		template <typename AtomicT>
+		class RingBuffer
+		{
+		public:
+			// 容量向上取整为页大小的2次幂倍
+			explicit RingBuffer(const std::size_t capacity = 64 * TINY_KB)
+			{
+				auto pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+
+				_capacity = pageSize;
+
+				while (_capacity < capacity)
+				{
+					_capacity <<= 1;
+				}
+
+				_mask = _capacity - 1;
+
+				Map();
+			}
+
+			~RingBuffer()
+			{
+				if (_buffer)
+				{
+					munmap(_buffer, _capacity * 2);
+				}
+			}
+
+			RingBuffer(const RingBuffer &) = delete;
+			RingBuffer & operator=(const RingBuffer &) = delete;
+
+			////////////////////////////////////////////////////////////////////////////////////////////////////
+			// 生产者
+
+			// 返回可写区间起始地址, 长度为UnWriteSize
+			Byte * WritePointer()
+			{
+				return _buffer + (_writePos.load(std::memory_order_relaxed) & _mask);
+			}
+
+			std::size_t UnWriteSize()
+			{
+				_readCache = _readPos.load(std::memory_order_acquire);
+
+				return _capacity - static_cast<std::size_t>(_writePos.load(std::memory_order_relaxed) - _readCache);
+			}
+
+			void WriteCompleted(const std::size_t bytes)
+			{
+				TINY_ASSERT(bytes <= _capacity - (_writePos.load(std::memory_order_relaxed) - _readPos.load(std::memory_order_relaxed)), "size out of range");
+
+				_writePos.store(_writePos.load(std::memory_order_relaxed) + bytes, std::memory_order_release);
+			}
+
+			// 空间不足时不写入任何数据, 返回false
+			bool Write(const void * data, const std::size_t size)
+			{
+				TINY_ASSERT(data || size == 0, "data is nullptr");
+
+				if (size == 0)
+				{
+					return true;
+				}
+
+				if (CachedUnWriteSize() < size && UnWriteSize() < size)
+				{
+					return false;
+				}
+
+				memcpy(WritePointer(), data, size);
+
+				WriteCompleted(size);
+
+				return true;
+			}
+
+			// 从描述符直接读入可写区间, 返回值同read
+			ssize_t ReadFrom(const int fd)
+			{
+				std::size_t size = UnWriteSize();
+
+				if (size == 0)
+				{
+					errno = ENOBUFS;
+
+					return -1;
+				}
+
+				ssize_t len = ::read(fd, WritePointer(), size);
+
+				if (len > 0)
+				{
+					WriteCompleted(static_cast<std::size_t>(len));
+				}
+
+				return len;
+			}
+
+			////////////////////////////////////////////////////////////////////////////////////////////////////
+			// 消费者
+
+			// 返回可读区间起始地址, 长度为UnReadSize
+			const Byte * ReadPointer()
+			{
+				return _buffer + (_readPos.load(std::memory_order_relaxed) & _mask);
+			}
+
+			std::size_t UnReadSize()
+			{
+				_writeCache = _writePos.load(std::memory_order_acquire);
+
+				return static_cast<std::size_t>(_writeCache - _readPos.load(std::memory_order_relaxed));
+			}
+
+			void ReadCompleted(const std::size_t bytes)
+			{
+				TINY_ASSERT(bytes <= _writePos.load(std::memory_order_relaxed) - _readPos.load(std::memory_order_relaxed), "size out of range");
+
+				_readPos.store(_readPos.load(std::memory_order_relaxed) + bytes, std::memory_order_release);
+			}
+
+			// 数据不足时不读取, 返回false
+			bool Read(void * data, const std::size_t size)
+			{
+				if (!Peek(data, size))
+				{
+					return false;
+				}
+
+				ReadCompleted(size);
+
+				return true;
+			}
+
+			bool Peek(void * data, const std::size_t size)
+			{
+				TINY_ASSERT(data || size == 0, "data is nullptr");
+
+				if (size == 0)
+				{
+					return true;
+				}
+
+				if (CachedUnReadSize() < size && UnReadSize() < size)
+				{
+					return false;
+				}
+
+				memcpy(data, ReadPointer(), size);
+
+				return true;
+			}
+
+			// 将可读区间直接写到描述符, 返回值同write
+			ssize_t WriteTo(const int fd)
+			{
+				std::size_t size = UnReadSize();
+
+				if (size == 0)
+				{
+					return 0;
+				}
+
+				ssize_t len = ::write(fd, ReadPointer(), size);
+
+				if (len > 0)
+				{
+					ReadCompleted(static_cast<std::size_t>(len));
+				}
+
+				return len;
+			}
+
+			////////////////////////////////////////////////////////////////////////////////////////////////////
+
+			std::size_t Capacity() const
+			{
+				return _capacity;
+			}
+
+			// 两端都可调用, 结果只是某一时刻的近似值
+			std::size_t Size() const
+			{
+				return static_cast<std::size_t>(_writePos.load(std::memory_order_acquire) - _readPos.load(std::memory_order_acquire));
+			}
+
+			bool Empty() const
+			{
+				return Size() == 0;
+			}
+
+		protected:
+			// 使用缓存的对端位置, 结果偏小但不会越界, 不足时再读取对端最新位置
+			std::size_t CachedUnWriteSize() const
+			{
+				return _capacity - static_cast<std::size_t>(_writePos.load(std::memory_order_relaxed) - _readCache);
+			}
+
+			std::size_t CachedUnReadSize() const
+			{
+				return static_cast<std::size_t>(_writeCache - _readPos.load(std::memory_order_relaxed));
+			}
+
+			void Map()
+			{
+				int fd = static_cast<int>(syscall(SYS_memfd_create, "tinyCore_ring_buffer", 1u /* MFD_CLOEXEC */));
+
+				TINY_THROW_EXCEPTION_IF(fd == -1, debug::MemoryError, TINY_STR_FORMAT("memfd_create failed: {}", strerror(errno)))
+
+				if (ftruncate(fd, static_cast<off_t>(_capacity)) == -1)
+				{
+					close(fd);
+
+					TINY_THROW_EXCEPTION(debug::MemoryError, TINY_STR_FORMAT("ftruncate failed: {}", strerror(errno)));
+				}
+
+				// 先保留两倍大小的连续地址空间, 再把同一文件固定映射到前后两半
+				void * base = mmap(nullptr, _capacity * 2, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+				if (base == MAP_FAILED)
+				{
+					close(fd);
+
+					TINY_THROW_EXCEPTION(debug::MemoryError, TINY_STR_FORMAT("mmap reserve failed: {}", strerror(errno)));
+				}
+
+				auto * first = static_cast<Byte *>(base);
+
+				if (mmap(first, _capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED ||
+					mmap(first + _capacity, _capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+				{
+					int error = errno;
+
+					munmap(base, _capacity * 2);
+
+					close(fd);
+
+					TINY_THROW_EXCEPTION(debug::MemoryError, TINY_STR_FORMAT("mmap mirror failed: {}", strerror(error)));
+				}
+
+				// 映射会保持文件引用
+				close(fd);
+
+				_buffer = first;
+			}
+
+		protected:
+			Byte * _buffer{ nullptr };
+
+			std::size_t _mask{ 0 };
+			std::size_t _capacity{ 0 };
+
+			// 读写位置单调递增, 取模后得到偏移, 两端各自缓存对端位置以减少缓存行争用
+			alignas(64) AtomicT _readPos{ 0 };
+			uint64_t _writeCache{ 0 };
+
+			alignas(64) AtomicT _writePos{ 0 };
+			uint64_t _readCache{ 0 };
+		};
+	}
+}
+
+
+using RingBufferSync = tinyCore::container::RingBuffer<tinyCore::lock::NullAtomic<uint64_t>>;
+using RingBufferAsync = tinyCore::container::RingBuffer<std::atomic<uint64_t>>;
+
+
+#endif // __TINY_CORE__CONTAINER__RING_BUFFER__H__
@@ -0,0 +1,238 @@
+#ifndef __TINY_CORE__CONTAINER__SHARED_MESSAGE__H__
+#define __TINY_CORE__CONTAINER__SHARED_MESSAGE__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 共享只读数据缓冲区
+ *
+ *  多个视图共享同一份存储, 拷贝与切片只增加引用计数,
+ *  用于将一份序列化数据分发给多个消费者
+ *
+ */
+
+
+#include <tinyCore/lock/atomic.h>
+#include <tinyCore/container/message.h>
+
+
+namespace tinyCore
+{
+	namespace container
+	{
+		template <typename AtomicT>
+		class SharedMessage
+		{
+			struct Storage
+			{
+				explicit Storage(ByteVector && value) : data(std::move(value)), ref(1)
+				{
+
+				}
+
+				ByteVector data;
+
+				AtomicT ref;
+			};
+
+		public:
+			SharedMessage() = default;
+
+			explicit SharedMessage(ByteVector && data) : _size(data.size()), _storage(new Storage(std::move(data)))
+			{
+
+			}
+
+			// 接管消息的存储, 视图为消息中未读的部分
+			explicit SharedMessage(Message && message)
+			{
+				_offset = static_cast<std::size_t>(message.ReadPointer() - message.BasePointer());
+				_size   = message.UnReadSize();
+
+				_storage = new Storage(message.Move());
+			}
+
+			explicit SharedMessage(const std::string & data) : SharedMessage(ByteVector(data.begin(), data.end()))
+			{
+
+			}
+
+			SharedMessage(const SharedMessage & rhs) : _size(rhs._size), _offset(rhs._offset), _storage(rhs._storage)
+			{
+				Retain();
+			}
+
+			SharedMessage(SharedMessage && rhs) noexcept : _size(rhs._size), _offset(rhs._offset), _storage(rhs._storage)
+			{
+				rhs._size    = 0;
+				rhs._offset  = 0;
+				rhs._storage = nullptr;
+			}
+
+			~SharedMessage()
+			{
+				Release();
+			}
+
+			SharedMessage & operator=(const SharedMessage & rhs)
+			{
+				if (this == &rhs)
+				{
+					return *this;
+				}
+
+				Release();
+
+				_size    = rhs._size;
+				_offset  = rhs._offset;
+				_storage = rhs._storage;
+
+				Retain();
+
+				return *this;
+			}
+
+			SharedMessage & operator=(SharedMessage && rhs) noexcept
+			{
+				if (this == &rhs)
+				{
+					return *this;
+				}
+
+				Release();
+
+				_size    = rhs._size;
+				_offset  = rhs._offset;
+				_storage = rhs._storage;
+
+				rhs._size    = 0;
+				rhs._offset  = 0;
+				rhs._storage = nullptr;
+
+				return *this;
+			}
+
+			// 共享同一份存储的子视图
+			SharedMessage Slice(const std::size_t offset, const std::size_t length) const
+			{
+				TINY_THROW_EXCEPTION_IF(offset + length > _size, debug::IndexError, "Slice Out Of Range")
+
+				SharedMessage slice(*this);
+
+				slice._offset += offset;
+				slice._size    = length;
+
+				return slice;
+			}
+
+			// 唯一持有时直接移交存储, 否则拷贝当前视图
+			Message ToMessage() &&
+			{
+				if (_storage == nullptr)
+				{
+					return Message(static_cast<std::size_t>(0));
+				}
+
+				if (UseCount() == 1)
+				{
+					Message message(std::move(_storage->data), _offset, _offset + _size);
+
+					Reset();
+
+					return message;
+				}
+
+				Message message(_size);
+
+				if (_size > 0)
+				{
+					message.Write(Data(), _size);
+				}
+
+				Reset();
+
+				return message;
+			}
+
+			Message ToMessage() const &
+			{
+				Message message(_size);
+
+				if (_size > 0)
+				{
+					message.Write(Data(), _size);
+				}
+
+				return message;
+			}
+
+			std::string ToString() const
+			{
+				return std::string((const char *)Data(), _size);
+			}
+
+			void Reset()
+			{
+				Release();
+
+				_size    = 0;
+				_offset  = 0;
+				_storage = nullptr;
+			}
+
+			const Byte * Data() const
+			{
+				return _storage ? _storage->data.data() + _offset : nullptr;
+			}
+
+			std::size_t Size() const
+			{
+				return _size;
+			}
+
+			std::size_t UseCount() const
+			{
+				return _storage ? _storage->ref.load(std::memory_order_acquire) : 0;
+			}
+
+			bool Empty() const
+			{
+				return _size == 0;
+			}
+
+		protected:
+			void Retain()
+			{
+				if (_storage)
+				{
+					_storage->ref.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+
+			void Release()
+			{
+				if (_storage && _storage->ref.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					delete _storage;
+				}
+
+				_storage = nullptr;
+			}
+
+		protected:
+			std::size_t _size{ 0 };
+			std::size_t _offset{ 0 };
+
+			Storage * _storage{ nullptr };
+		};
+	}
+}
+
+
+using SharedMessageSync = tinyCore::container::SharedMessage<tinyCore::lock::NullAtomic<std::size_t>>;
+using SharedMessageAsync = tinyCore::container::SharedMessage<std::atomic<std::size_t>>;
+
+
+#endif // __TINY_CORE__CONTAINER__SHARED_MESSAGE__H__
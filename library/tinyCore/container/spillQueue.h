@@ -0,0 +1,495 @@
+#ifndef __TINY_CORE__CONTAINER__SPILL_QUEUE__H__
+#define __TINY_CORE__CONTAINER__SPILL_QUEUE__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 溢出到磁盘的有界队列
+ *
+ *  内存队列 (BoundedQueue) 写满后, 后续数据顺序追加到磁盘分段文件, 分段文件以共享映射方式写入, 由内核批量回写
+ *
+ *  一旦开始溢出, 所有写入都进入磁盘, 直到消费者把磁盘中的数据全部读完, 因此每个生产者写入的数据在内存与磁盘之间保持先进先出
+ *
+ *  读完的分段文件立即删除, 分段头部记录读取位置, 进程重启后从未读完的位置继续 (内存中的数据不会持久化)
+ *
+ *  数据通过SerializerT与字节互相转换, 默认支持平凡可复制类型与std::string
+ *
+ */
+
+
+#include <dirent.h>
+
+#include <tinyCore/container/queue.h>
+#include <tinyCore/system/mappedFile.h>
+
+
+namespace tinyCore
+{
+	namespace container
+	{
+		// 自定义类型需要特化, 提供Size/Write/Read
+		template <typename TypeT, typename EnableT = void>
+		struct SpillSerializer;
+
+		template <typename TypeT>
+		struct SpillSerializer<TypeT, typename std::enable_if<std::is_trivially_copyable<TypeT>::value>::type>
+		{
+			static std::size_t Size(const TypeT &)
+			{
+				return sizeof(TypeT);
+			}
+
+			static void Write(const TypeT & value, Byte * buffer)
+			{
+				memcpy(buffer, &value, sizeof(TypeT));
+			}
+
+			static bool Read(const Byte * buffer, const std::size_t size, TypeT & value)
+			{
+				if (size != sizeof(TypeT))
+				{
+					return false;
+				}
+
+				memcpy(&value, buffer, sizeof(TypeT));
+
+				return true;
+			}
+		};
+
+		template <>
+		struct SpillSerializer<std::string>
+		{
+			static std::size_t Size(const std::string & value)
+			{
+				return value.size();
+			}
+
+			static void Write(const std::string & value, Byte * buffer)
+			{
+				memcpy(buffer, value.data(), value.size());
+			}
+
+			static bool Read(const Byte * buffer, const std::size_t size, std::string & value)
+			{
+				value.assign(reinterpret_cast<const char *>(buffer), size);
+
+				return true;
+			}
+		};
+
+		template <typename TypeT, typename SerializerT = SpillSerializer<TypeT>>
+		class SpillQueue
+		{
+			static const uint32_t VERSION = 1;
+
+			// 分段头部64字节, 之后为 [4字节长度+1][数据] 依次排列, 0表示结束, 因此允许空数据
+			struct Header
+			{
+				char magic[8];
+
+				uint32_t version;
+				uint32_t reserved0;
+
+				uint64_t readOffset;
+
+				uint8_t reserved[40];
+			};
+
+			static_assert(sizeof(Header) == 64, "header must be one cache line");
+
+			struct Segment
+			{
+				uint64_t id{ 0 };
+
+				std::size_t readOffset{ 0 };
+				std::size_t writeOffset{ 0 };
+
+				std::string path{ };
+
+				system::MappedFile file{ };
+
+				Header * GetHeader()
+				{
+					return reinterpret_cast<Header *>(file.Data());
+				}
+			};
+
+		public:
+			// directory不存在时自动创建, 已有的分段文件在构造时恢复
+			SpillQueue(const std::string & directory, const std::size_t memorySize = TINY_KB, const std::size_t segmentSize = 64 * TINY_MB)
+			: _memory(memorySize),
+			  _directory(directory),
+			  _segmentSize(segmentSize)
+			{
+				TINY_THROW_EXCEPTION_IF(segmentSize <= sizeof(Header) + sizeof(uint32_t) * 2, debug::SizeError, "Segment Size Too Small")
+
+				TINY_THROW_EXCEPTION_IF(::mkdir(directory.c_str(), 0755) == -1 && errno != EEXIST, debug::IOError,
+										TINY_STR_FORMAT("mkdir {} failed: {}", directory, strerror(errno)))
+
+				Recover();
+			}
+
+			~SpillQueue()
+			{
+				for (auto &iter : _segments)
+				{
+					iter.file.Sync();
+				}
+			}
+
+			SpillQueue(const SpillQueue &) = delete;
+			SpillQueue & operator=(const SpillQueue &) = delete;
+
+			// 只有单条数据超过分段大小时才会抛出异常, 其他情况总是成功
+			void Write(const TypeT & data)
+			{
+				if (!_isSpilling.load(std::memory_order_acquire) && _memory.Write(data))
+				{
+					return;
+				}
+
+				std::lock_guard<std::mutex> lock(_lock);
+
+				// 消费者可能刚好读完磁盘, 此时可以回到内存
+				if (!_isSpilling.load(std::memory_order_relaxed) && _memory.Write(data))
+				{
+					return;
+				}
+
+				Spill(data);
+			}
+
+			void WriteMove(TypeT && data)
+			{
+				// BoundedQueue写入失败时不会移动数据
+				if (!_isSpilling.load(std::memory_order_acquire) && _memory.WriteMove(std::move(data)))
+				{
+					return;
+				}
+
+				std::lock_guard<std::mutex> lock(_lock);
+
+				if (!_isSpilling.load(std::memory_order_relaxed) && _memory.WriteMove(std::move(data)))
+				{
+					return;
+				}
+
+				Spill(data);
+			}
+
+			// 先读内存, 内存为空时按顺序回放磁盘
+			bool Read(TypeT & data)
+			{
+				if (_memory.ReadMove(data))
+				{
+					return true;
+				}
+
+				if (!_isSpilling.load(std::memory_order_acquire))
+				{
+					return false;
+				}
+
+				std::lock_guard<std::mutex> lock(_lock);
+
+				// 开始溢出前的生产者可能仍在写内存
+				if (_memory.ReadMove(data))
+				{
+					return true;
+				}
+
+				return ReadDisk(data);
+			}
+
+			bool Empty()
+			{
+				return _memory.Empty() && _diskCount.load(std::memory_order_acquire) == 0;
+			}
+
+			bool IsSpilling() const
+			{
+				return _isSpilling.load(std::memory_order_acquire);
+			}
+
+			// 当前磁盘中未读取的数量
+			std::size_t DiskCount() const
+			{
+				return _diskCount.load(std::memory_order_acquire);
+			}
+
+			// 累计溢出到磁盘的数量
+			std::size_t SpillCount() const
+			{
+				return _spillCount.load(std::memory_order_relaxed);
+			}
+
+			std::size_t SegmentCount()
+			{
+				std::lock_guard<std::mutex> lock(_lock);
+
+				return _segments.size();
+			}
+
+			// 将已写入磁盘的数据同步写回
+			void Sync()
+			{
+				std::lock_guard<std::mutex> lock(_lock);
+
+				for (auto &iter : _segments)
+				{
+					iter.file.Sync(false);
+				}
+			}
+
+		protected:
+			void Spill(const TypeT & data)
+			{
+				std::size_t size = SerializerT::Size(data);
+
+				TINY_THROW_EXCEPTION_IF(sizeof(Header) + sizeof(uint32_t) * 2 + size > _segmentSize || size >= UINT32_MAX,
+										debug::SizeError, "Record Larger Than Segment")
+
+				// 保留一个长度字段作为结束标记
+				if (_segments.empty() || _segments.back().writeOffset + sizeof(uint32_t) * 2 + size > _segmentSize)
+				{
+					if (!_segments.empty())
+					{
+						_segments.back().file.Sync();
+					}
+
+					AddSegment();
+				}
+
+				Segment & segment = _segments.back();
+
+				Byte * pointer = segment.file.Data() + segment.writeOffset;
+
+				auto length = static_cast<uint32_t>(size + 1);
+
+				SerializerT::Write(data, pointer + sizeof(uint32_t));
+
+				memcpy(pointer, &length, sizeof(uint32_t));
+
+				segment.writeOffset += sizeof(uint32_t) + size;
+
+				_isSpilling.store(true, std::memory_order_release);
+
+				_diskCount.fetch_add(1, std::memory_order_release);
+				_spillCount.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			bool ReadDisk(TypeT & data)
+			{
+				while (!_segments.empty())
+				{
+					Segment & segment = _segments.front();
+
+					if (segment.readOffset < segment.writeOffset)
+					{
+						const Byte * pointer = segment.file.Data() + segment.readOffset;
+
+						uint32_t length = 0;
+
+						memcpy(&length, pointer, sizeof(uint32_t));
+
+						bool isValid = SerializerT::Read(pointer + sizeof(uint32_t), length - 1, data);
+
+						segment.readOffset += sizeof(uint32_t) + length - 1;
+
+						segment.GetHeader()->readOffset = segment.readOffset;
+
+						_diskCount.fetch_sub(1, std::memory_order_release);
+
+						TINY_THROW_EXCEPTION_IF(!isValid, debug::ParsingError, TINY_STR_FORMAT("invalid record in {}", segment.path))
+
+						ReclaimIfDone();
+
+						return true;
+					}
+
+					if (_segments.size() == 1)
+					{
+						break;
+					}
+
+					RemoveFront();
+				}
+
+				ReclaimIfDone();
+
+				return false;
+			}
+
+			// 磁盘读空后删除全部分段并回到内存模式
+			void ReclaimIfDone()
+			{
+				if (_diskCount.load(std::memory_order_relaxed) != 0)
+				{
+					// 读完的旧分段立即删除
+					while (_segments.size() > 1 && _segments.front().readOffset >= _segments.front().writeOffset)
+					{
+						RemoveFront();
+					}
+
+					return;
+				}
+
+				while (!_segments.empty())
+				{
+					RemoveFront();
+				}
+
+				_isSpilling.store(false, std::memory_order_release);
+			}
+
+			void RemoveFront()
+			{
+				::unlink(_segments.front().path.c_str());
+
+				_segments.pop_front();
+			}
+
+			void AddSegment()
+			{
+				Segment segment;
+
+				segment.id   = _nextID++;
+				segment.path = SegmentPath(segment.id);
+
+				segment.file.Create(segment.path, _segmentSize);
+
+				Header * header = segment.GetHeader();
+
+				memcpy(header->magic, "TCSPILL", 8);
+
+				header->version    = VERSION;
+				header->readOffset = sizeof(Header);
+
+				segment.readOffset  = sizeof(Header);
+				segment.writeOffset = sizeof(Header);
+
+				_segments.push_back(std::move(segment));
+			}
+
+			std::string SegmentPath(const uint64_t id) const
+			{
+				return TINY_STR_FORMAT("{}/{:020}.spill", _directory, id);
+			}
+
+			// 按编号顺序恢复目录中已有的分段
+			void Recover()
+			{
+				std::vector<uint64_t> ids;
+
+				DIR * dir = opendir(_directory.c_str());
+
+				TINY_THROW_EXCEPTION_IF(dir == nullptr, debug::IOError, TINY_STR_FORMAT("opendir {} failed: {}", _directory, strerror(errno)))
+
+				while (struct dirent * entry = readdir(dir))
+				{
+					std::string name = entry->d_name;
+
+					if (name.size() == 26 && name.compare(20, 6, ".spill") == 0 && std::all_of(name.begin(), name.begin() + 20, ::isdigit))
+					{
+						ids.push_back(std::stoull(name.substr(0, 20)));
+					}
+				}
+
+				closedir(dir);
+
+				std::sort(ids.begin(), ids.end());
+
+				std::size_t count = 0;
+
+				for (auto id : ids)
+				{
+					Segment segment;
+
+					segment.id   = id;
+					segment.path = SegmentPath(id);
+
+					segment.file.Open(segment.path, system::MappedFile::MODE::READ_WRITE);
+
+					Header * header = segment.GetHeader();
+
+					TINY_THROW_EXCEPTION_IF(segment.file.Size() < sizeof(Header) + sizeof(uint32_t) ||
+											memcmp(header->magic, "TCSPILL", 8) != 0 || header->version != VERSION ||
+											header->readOffset < sizeof(Header) || header->readOffset > segment.file.Size(),
+											debug::FileError, TINY_STR_FORMAT("{} is not a valid spill segment", segment.path))
+
+					segment.readOffset = header->readOffset;
+
+					// 从头扫描确定写入位置, 同时统计未读取的数量
+					std::size_t offset = sizeof(Header);
+
+					while (offset + sizeof(uint32_t) <= segment.file.Size())
+					{
+						uint32_t length = 0;
+
+						memcpy(&length, segment.file.Data() + offset, sizeof(uint32_t));
+
+						if (length == 0 || offset + sizeof(uint32_t) + length - 1 > segment.file.Size())
+						{
+							break;
+						}
+
+						if (offset >= segment.readOffset)
+						{
+							++count;
+						}
+
+						offset += sizeof(uint32_t) + length - 1;
+					}
+
+					// 恢复的分段只读取不再追加, 新数据写入新的分段
+					segment.writeOffset = offset;
+					segment.readOffset  = std::min(segment.readOffset, offset);
+
+					_segments.push_back(std::move(segment));
+
+					_nextID = id + 1;
+				}
+
+				_diskCount.store(count, std::memory_order_release);
+
+				if (count == 0)
+				{
+					while (!_segments.empty())
+					{
+						RemoveFront();
+					}
+				}
+				else
+				{
+					AddSegment();
+
+					_isSpilling.store(true, std::memory_order_release);
+				}
+			}
+
+		protected:
+			BoundedQueue<TypeT> _memory;
+
+			std::string _directory{ };
+
+			std::size_t _segmentSize{ 0 };
+
+			uint64_t _nextID{ 0 };
+
+			std::mutex _lock{ };
+
+			std::deque<Segment> _segments{ };
+
+			std::atomic<bool> _isSpilling{ false };
+
+			std::atomic<std::size_t> _diskCount{ 0 };
+			std::atomic<std::size_t> _spillCount{ 0 };
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__CONTAINER__SPILL_QUEUE__H__
@@ -0,0 +1,424 @@
+#ifndef __TINY_CORE__CONTAINER__TIMER_WHEEL__H__
+#define __TINY_CORE__CONTAINER__TIMER_WHEEL__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 分层时间轮
+ *
+ *  4层, 第0层256个槽, 其余每层64个槽, 共覆盖2^26个tick (1ms精度约18.6小时), 更远的定时器放在最高层, 到期前重新分配
+ *
+ *  插入与取消均为O(1), 推进时每个tick只检查第0层的一个槽, 低层转完一圈时将上一层对应槽的定时器下放
+ *
+ *  定时器节点存放在连续数组中, 通过下标组成双向链表, 定时器ID由下标与代数组成, 节点复用后旧ID自动失效
+ *
+ *  到期的回调在锁外批量执行, 回调中可以再添加或取消定时器
+ *
+ */
+
+
+#include <tinyCore/lock/mutex.h>
+#include <tinyCore/pool/threadPool.h>
+#include <tinyCore/utilities/time.h>
+
+
+namespace tinyCore
+{
+	namespace container
+	{
+		template <typename MutexT, typename CallbackT = std::function<void()>>
+		class TimerWheel
+		{
+			static const uint32_t NIL = 0xFFFFFFFF;
+
+			static const std::size_t ROOT_BITS = 8;
+			static const std::size_t LEVEL_BITS = 6;
+			static const std::size_t LEVEL_COUNT = 4;
+
+			static const std::size_t ROOT_SIZE = std::size_t(1) << ROOT_BITS;
+			static const std::size_t LEVEL_SIZE = std::size_t(1) << LEVEL_BITS;
+			static const std::size_t SLOT_COUNT = ROOT_SIZE + LEVEL_SIZE * (LEVEL_COUNT - 1);
+
+			static const uint64_t MAX_SPAN = uint64_t(1) << (ROOT_BITS + LEVEL_BITS * (LEVEL_COUNT - 1));
+
+			struct Node
+			{
+				uint64_t expire{ 0 };
+
+				uint32_t prev{ NIL };
+				uint32_t next{ NIL };
+				uint32_t slot{ NIL };
+				uint32_t generation{ 1 };
+
+				CallbackT callback{ };
+			};
+
+		public:
+			// 0为无效ID
+			using TimerID = uint64_t;
+
+		public:
+			explicit TimerWheel(const SteadyClockDuration & tick = std::chrono::milliseconds(1), const std::size_t reserve = 0)
+			: _tick(tick),
+			  _start(TINY_TIME_STEADY_POINT())
+			{
+				TINY_THROW_EXCEPTION_IF(tick <= SteadyClockDuration::zero(), debug::SizeError, "Tick Must Be Greater Than Zero")
+
+				_slots.fill(static_cast<uint32_t>(NIL));
+
+				_nodes.reserve(reserve);
+			}
+
+			TimerWheel(const TimerWheel &) = delete;
+			TimerWheel & operator=(const TimerWheel &) = delete;
+
+			// 相对当前tick延迟触发, 精度为一个tick, 至少延迟一个tick
+			TimerID Add(const SteadyClockDuration & delay, CallbackT callback)
+			{
+				uint64_t ticks = delay <= SteadyClockDuration::zero() ? 0 : static_cast<uint64_t>((delay + _tick - SteadyClockDuration(1)) / _tick);
+
+				std::lock_guard<MutexT> lock(_lock);
+
+				return Insert(_currentTick + ticks, std::move(callback));
+			}
+
+			// 在指定时间点触发
+			TimerID AddAt(const SteadyClockTimesPoint & when, CallbackT callback)
+			{
+				uint64_t expire = when <= _start ? 0 : static_cast<uint64_t>((when - _start + _tick - SteadyClockDuration(1)) / _tick);
+
+				std::lock_guard<MutexT> lock(_lock);
+
+				return Insert(expire, std::move(callback));
+			}
+
+			// 返回是否取消成功, 已触发或已取消的定时器返回false
+			bool Cancel(const TimerID id)
+			{
+				auto index      = static_cast<uint32_t>(id & 0xFFFFFFFF);
+				auto generation = static_cast<uint32_t>(id >> 32);
+
+				std::lock_guard<MutexT> lock(_lock);
+
+				if (index >= _nodes.size() || _nodes[index].generation != generation || _nodes[index].slot == NIL)
+				{
+					return false;
+				}
+
+				Unlink(index);
+
+				Free(index);
+
+				return true;
+			}
+
+			// 推进到now, 在锁外依次执行到期回调, 返回到期数量
+			std::size_t Advance(const SteadyClockTimesPoint & now = TINY_TIME_STEADY_POINT())
+			{
+				std::vector<CallbackT> expired;
+
+				Advance(now, expired);
+
+				for (auto &iter : expired)
+				{
+					iter();
+				}
+
+				return expired.size();
+			}
+
+			// 推进到now, 到期回调追加到expired中由调用方处理
+			std::size_t Advance(const SteadyClockTimesPoint & now, std::vector<CallbackT> & expired)
+			{
+				uint64_t target = now <= _start ? 0 : static_cast<uint64_t>((now - _start) / _tick);
+
+				std::lock_guard<MutexT> lock(_lock);
+
+				return AdvanceTo(target, expired);
+			}
+
+			// 按tick数推进, 不读取时钟, 用于模拟与测试
+			std::size_t AdvanceTicks(const uint64_t ticks, std::vector<CallbackT> & expired)
+			{
+				std::lock_guard<MutexT> lock(_lock);
+
+				return AdvanceTo(_currentTick + ticks, expired);
+			}
+
+			// 推进到now, 到期回调按batchSize分批提交到线程池执行
+			std::size_t Dispatch(pool::ThreadPool & pool, const std::size_t batchSize = 64, const SteadyClockTimesPoint & now = TINY_TIME_STEADY_POINT())
+			{
+				TINY_ASSERT(batchSize > 0, "batch size must be greater than zero");
+
+				std::vector<CallbackT> expired;
+
+				Advance(now, expired);
+
+				for (std::size_t i = 0; i < expired.size(); i += batchSize)
+				{
+					std::vector<CallbackT> batch
+					(
+						std::make_move_iterator(expired.begin() + i),
+						std::make_move_iterator(expired.begin() + std::min(i + batchSize, expired.size()))
+					);
+
+					pool.Post
+					(
+						[batch = std::move(batch)]() mutable
+						{
+							for (auto &iter : batch)
+							{
+								iter();
+							}
+						}
+					);
+				}
+
+				return expired.size();
+			}
+
+			std::size_t Size() const
+			{
+				std::lock_guard<MutexT> lock(_lock);
+
+				return _size;
+			}
+
+			bool Empty() const
+			{
+				return Size() == 0;
+			}
+
+			uint64_t CurrentTick() const
+			{
+				std::lock_guard<MutexT> lock(_lock);
+
+				return _currentTick;
+			}
+
+			const SteadyClockDuration & Tick() const
+			{
+				return _tick;
+			}
+
+		protected:
+			TimerID Insert(uint64_t expire, CallbackT && callback)
+			{
+				uint32_t index = Allocate();
+
+				Node & node = _nodes[index];
+
+				node.expire   = std::max(expire, _currentTick + 1);
+				node.callback = std::move(callback);
+
+				Place(index);
+
+				++_size;
+
+				return (static_cast<uint64_t>(node.generation) << 32) | index;
+			}
+
+			std::size_t AdvanceTo(const uint64_t target, std::vector<CallbackT> & expired)
+			{
+				std::size_t count = expired.size();
+
+				while (_currentTick < target)
+				{
+					// 没有定时器时直接跳到目标tick
+					if (_size == 0)
+					{
+						_currentTick = target;
+
+						break;
+					}
+
+					++_currentTick;
+
+					std::size_t index = _currentTick & (ROOT_SIZE - 1);
+
+					if (index == 0)
+					{
+						for (std::size_t level = 1; level < LEVEL_COUNT; ++level)
+						{
+							std::size_t slot = (_currentTick >> (ROOT_BITS + LEVEL_BITS * (level - 1))) & (LEVEL_SIZE - 1);
+
+							Cascade(ROOT_SIZE + (level - 1) * LEVEL_SIZE + slot);
+
+							if (slot != 0)
+							{
+								break;
+							}
+						}
+					}
+
+					Expire(index, expired);
+				}
+
+				return expired.size() - count;
+			}
+
+			void Expire(const std::size_t slot, std::vector<CallbackT> & expired)
+			{
+				uint32_t index = _slots[slot];
+
+				_slots[slot] = NIL;
+
+				while (index != NIL)
+				{
+					Node & node = _nodes[index];
+
+					uint32_t next = node.next;
+
+					expired.push_back(std::move(node.callback));
+
+					Free(index);
+
+					--_size;
+
+					index = next;
+				}
+			}
+
+			void Cascade(const std::size_t slot)
+			{
+				uint32_t index = _slots[slot];
+
+				_slots[slot] = NIL;
+
+				while (index != NIL)
+				{
+					uint32_t next = _nodes[index].next;
+
+					Place(index);
+
+					index = next;
+				}
+			}
+
+			void Place(const uint32_t index)
+			{
+				Node & node = _nodes[index];
+
+				uint64_t expire = node.expire;
+				uint64_t diff   = expire > _currentTick ? expire - _currentTick : 0;
+
+				// 超出范围的先放在最远处, 下放时按真实到期时间重新分配
+				if (diff >= MAX_SPAN)
+				{
+					diff   = MAX_SPAN - 1;
+					expire = _currentTick + diff;
+				}
+
+				std::size_t slot = expire & (ROOT_SIZE - 1);
+
+				if (diff >= ROOT_SIZE)
+				{
+					for (std::size_t level = 1; level < LEVEL_COUNT; ++level)
+					{
+						if (diff < (uint64_t(1) << (ROOT_BITS + LEVEL_BITS * level)))
+						{
+							slot = ROOT_SIZE + (level - 1) * LEVEL_SIZE + ((expire >> (ROOT_BITS + LEVEL_BITS * (level - 1))) & (LEVEL_SIZE - 1));
+
+							break;
+						}
+					}
+				}
+
+				node.slot = static_cast<uint32_t>(slot);
+				node.prev = NIL;
+				node.next = _slots[slot];
+
+				if (node.next != NIL)
+				{
+					_nodes[node.next].prev = index;
+				}
+
+				_slots[slot] = index;
+			}
+
+			void Unlink(const uint32_t index)
+			{
+				Node & node = _nodes[index];
+
+				if (node.prev != NIL)
+				{
+					_nodes[node.prev].next = node.next;
+				}
+				else
+				{
+					_slots[node.slot] = node.next;
+				}
+
+				if (node.next != NIL)
+				{
+					_nodes[node.next].prev = node.prev;
+				}
+
+				--_size;
+			}
+
+			uint32_t Allocate()
+			{
+				if (_freeHead != NIL)
+				{
+					uint32_t index = _freeHead;
+
+					_freeHead = _nodes[index].next;
+
+					return index;
+				}
+
+				TINY_THROW_EXCEPTION_IF(_nodes.size() >= NIL, debug::SizeError, "Too Many Timers")
+
+				_nodes.emplace_back();
+
+				return static_cast<uint32_t>(_nodes.size() - 1);
+			}
+
+			void Free(const uint32_t index)
+			{
+				Node & node = _nodes[index];
+
+				node.callback = CallbackT();
+
+				node.slot = NIL;
+				node.prev = NIL;
+				node.next = _freeHead;
+
+				// 代数跳过0, 保证ID不为0
+				if (++node.generation == 0)
+				{
+					node.generation = 1;
+				}
+
+				_freeHead = index;
+			}
+
+		protected:
+			SteadyClockDuration _tick{ };
+
+			SteadyClockTimesPoint _start{ };
+
+			uint64_t _currentTick{ 0 };
+
+			std::size_t _size{ 0 };
+
+			uint32_t _freeHead{ NIL };
+
+			mutable MutexT _lock{ };
+
+			std::vector<Node> _nodes{ };
+
+			std::array<uint32_t, SLOT_COUNT> _slots{ };
+		};
+	}
+}
+
+
+using TimerWheelSync = tinyCore::container::TimerWheel<tinyCore::lock::NullMutex>;
+using TimerWheelAsync = tinyCore::container::TimerWheel<tinyCore::lock::SystemMutex>;
+
+
+#endif // __TINY_CORE__CONTAINER__TIMER_WHEEL__H__
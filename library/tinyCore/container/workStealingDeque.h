@@ -0,0 +1,211 @@
+#ifndef __TINY_CORE__CONTAINER__WORK_STEALING_DEQUE__H__
+#define __TINY_CORE__CONTAINER__WORK_STEALING_DEQUE__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 工作窃取双端队列 (Chase-Lev)
+ *
+ *  拥有者线程在底部 Push/Pop, 其他线程在顶部 Steal
+ *
+ *  环形数组写满时倍增扩容, 旧数组可能仍被窃取线程读取,
+ *  因此挂入回收链表, 在析构时统一释放 (总量不超过当前容量)
+ *
+ */
+
+
+#include <tinyCore/debug/trace.h>
+
+
+namespace tinyCore
+{
+	namespace container
+	{
+		template <typename TypeT>
+		class WorkStealingDeque
+		{
+			static_assert(std::is_trivially_copyable<TypeT>::value, "TypeT must be trivially copyable");
+
+			struct Array
+			{
+				explicit Array(int64_t size) : capacity(size), mask(size - 1), data(new std::atomic<TypeT>[size])
+				{
+
+				}
+
+				~Array()
+				{
+					delete[] data;
+				}
+
+				void Put(int64_t index, const TypeT & value)
+				{
+					data[index & mask].store(value, std::memory_order_relaxed);
+				}
+
+				TypeT Get(int64_t index) const
+				{
+					return data[index & mask].load(std::memory_order_relaxed);
+				}
+
+				Array * Grow(int64_t bottom, int64_t top) const
+				{
+					auto * array = new Array(capacity * 2);
+
+					for (int64_t i = top; i != bottom; ++i)
+					{
+						array->Put(i, Get(i));
+					}
+
+					return array;
+				}
+
+				int64_t capacity{ 0 };
+				int64_t mask{ 0 };
+
+				std::atomic<TypeT> * data{ nullptr };
+			};
+
+		public:
+			explicit WorkStealingDeque(std::size_t size = TINY_KB)
+			{
+				if ((size < 2) || ((size & (size - 1)) != 0))
+				{
+					TINY_THROW_EXCEPTION(debug::SizeError, "Size Must Be Power Of Two")
+				}
+
+				_top.store(0, std::memory_order_relaxed);
+				_bottom.store(0, std::memory_order_relaxed);
+				_array.store(new Array(static_cast<int64_t>(size)), std::memory_order_relaxed);
+			}
+
+			~WorkStealingDeque()
+			{
+				for (auto &iter : _garbage)
+				{
+					delete iter;
+				}
+
+				delete _array.load(std::memory_order_relaxed);
+			}
+
+			WorkStealingDeque(const WorkStealingDeque &) = delete;
+			WorkStealingDeque & operator=(const WorkStealingDeque &) = delete;
+
+			// 仅拥有者线程调用
+			void Push(const TypeT & value)
+			{
+				int64_t bottom = _bottom.load(std::memory_order_relaxed);
+				int64_t top    = _top.load(std::memory_order_acquire);
+
+				Array * array = _array.load(std::memory_order_relaxed);
+
+				if (bottom - top > array->capacity - 1)
+				{
+					Array * temp = array->Grow(bottom, top);
+
+					_garbage.push_back(array);
+
+					array = temp;
+
+					_array.store(array, std::memory_order_release);
+				}
+
+				array->Put(bottom, value);
+
+				_bottom.store(bottom + 1, std::memory_order_release);
+			}
+
+			// 仅拥有者线程调用, 后进先出
+			bool Pop(TypeT & value)
+			{
+				int64_t bottom = _bottom.load(std::memory_order_relaxed) - 1;
+
+				Array * array = _array.load(std::memory_order_relaxed);
+
+				_bottom.store(bottom, std::memory_order_relaxed);
+
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				int64_t top = _top.load(std::memory_order_relaxed);
+
+				if (top > bottom)
+				{
+					_bottom.store(bottom + 1, std::memory_order_relaxed);
+
+					return false;
+				}
+
+				value = array->Get(bottom);
+
+				if (top == bottom)
+				{
+					// 只剩最后一个元素, 与窃取线程竞争
+					bool success = _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+																			  std::memory_order_relaxed);
+
+					_bottom.store(bottom + 1, std::memory_order_relaxed);
+
+					return success;
+				}
+
+				return true;
+			}
+
+			// 任意线程调用, 先进先出, 竞争失败时返回false
+			bool Steal(TypeT & value)
+			{
+				int64_t top = _top.load(std::memory_order_acquire);
+
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				int64_t bottom = _bottom.load(std::memory_order_acquire);
+
+				if (top >= bottom)
+				{
+					return false;
+				}
+
+				Array * array = _array.load(std::memory_order_acquire);
+
+				value = array->Get(top);
+
+				return _top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+																  std::memory_order_relaxed);
+			}
+
+			bool Empty() const
+			{
+				int64_t bottom = _bottom.load(std::memory_order_relaxed);
+				int64_t top    = _top.load(std::memory_order_relaxed);
+
+				return bottom <= top;
+			}
+
+			std::size_t Size() const
+			{
+				int64_t bottom = _bottom.load(std::memory_order_relaxed);
+				int64_t top    = _top.load(std::memory_order_relaxed);
+
+				return static_cast<std::size_t>(bottom >= top ? bottom - top : 0);
+			}
+
+			std::size_t Capacity() const
+			{
+				return static_cast<std::size_t>(_array.load(std::memory_order_relaxed)->capacity);
+			}
+
+		protected:
+			alignas(64) std::atomic<int64_t> _top;
+			alignas(64) std::atomic<int64_t> _bottom;
+			alignas(64) std::atomic<Array *> _array;
+
+			std::vector<Array *> _garbage{ };
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__CONTAINER__WORK_STEALING_DEQUE__H__
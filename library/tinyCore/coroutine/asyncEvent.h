@@ -0,0 +1,137 @@
+#ifndef __TINY_CORE__COROUTINE__ASYNC_EVENT__H__
+#define __TINY_CORE__COROUTINE__ASYNC_EVENT__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 协程事件 (需要 C++20, 定义 TINY_CORE_COROUTINE 后启用)
+ *
+ *  手动复位: Set 之后所有 co_await 立即返回, 直到 Reset
+ *
+ *  Set 在调用线程上依次恢复所有等待方, 传入线程池时改为逐个投递到线程池
+ *
+ */
+
+
+#if defined(TINY_CORE_COROUTINE)
+#
+#  include <coroutine>
+#
+#endif
+
+#include <tinyCore/pool/threadPool.h>
+
+
+#if defined(TINY_CORE_COROUTINE)
+
+
+namespace tinyCore
+{
+	namespace coroutine
+	{
+		class AsyncEvent
+		{
+			struct Awaiter
+			{
+				bool await_ready() const
+				{
+					return event.IsSet();
+				}
+
+				bool await_suspend(std::coroutine_handle<> handle)
+				{
+					std::lock_guard<std::mutex> lock(event._lock);
+
+					if (event._isSet)
+					{
+						return false;
+					}
+
+					event._waiters.push_back(handle);
+
+					return true;
+				}
+
+				void await_resume() const noexcept
+				{
+
+				}
+
+				AsyncEvent & event;
+			};
+
+		public:
+			explicit AsyncEvent(const bool isSet = false) : _isSet(isSet)
+			{
+
+			}
+
+			AsyncEvent(const AsyncEvent &) = delete;
+			AsyncEvent & operator=(const AsyncEvent &) = delete;
+
+			bool IsSet() const
+			{
+				std::lock_guard<std::mutex> lock(_lock);
+
+				return _isSet;
+			}
+
+			void Set()
+			{
+				for (auto &iter : Take())
+				{
+					iter.resume();
+				}
+			}
+
+			void Set(pool::ThreadPool & pool)
+			{
+				for (auto &iter : Take())
+				{
+					pool.Post([iter]() { iter.resume(); });
+				}
+			}
+
+			void Reset()
+			{
+				std::lock_guard<std::mutex> lock(_lock);
+
+				_isSet = false;
+			}
+
+			Awaiter operator co_await()
+			{
+				return Awaiter{ *this };
+			}
+
+		protected:
+			std::vector<std::coroutine_handle<>> Take()
+			{
+				std::vector<std::coroutine_handle<>> waiters;
+
+				std::lock_guard<std::mutex> lock(_lock);
+
+				_isSet = true;
+
+				waiters.swap(_waiters);
+
+				return waiters;
+			}
+
+		protected:
+			bool _isSet{ false };
+
+			mutable std::mutex _lock{ };
+
+			std::vector<std::coroutine_handle<>> _waiters{ };
+		};
+	}
+}
+
+
+#endif // TINY_CORE_COROUTINE
+
+
+#endif // __TINY_CORE__COROUTINE__ASYNC_EVENT__H__
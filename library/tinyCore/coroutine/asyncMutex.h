@@ -0,0 +1,220 @@
+#ifndef __TINY_CORE__COROUTINE__ASYNC_MUTEX__H__
+#define __TINY_CORE__COROUTINE__ASYNC_MUTEX__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 协程互斥锁 (需要 C++20, 定义 TINY_CORE_COROUTINE 后启用)
+ *
+ *  锁被占用时协程挂起而不是阻塞线程, 等待方按先进先出排队,
+ *  解锁时锁的所有权直接交给队首的等待方, 并在解锁的线程上恢复它
+ *
+ *  {
+ *      auto guard = co_await mutex.ScopedLock();
+ *
+ *      ...
+ *  }
+ *
+ */
+
+
+#if defined(TINY_CORE_COROUTINE)
+#
+#  include <coroutine>
+#
+#endif
+
+#include <tinyCore/debug/trace.h>
+
+
+#if defined(TINY_CORE_COROUTINE)
+
+
+namespace tinyCore
+{
+	namespace coroutine
+	{
+		class AsyncMutex
+		{
+			struct Waiter
+			{
+				std::coroutine_handle<> handle{ };
+
+				Waiter * next{ nullptr };
+			};
+
+			struct LockAwaiter
+			{
+				bool await_ready()
+				{
+					return mutex.TryLock();
+				}
+
+				bool await_suspend(std::coroutine_handle<> handle)
+				{
+					waiter.handle = handle;
+
+					return mutex.Enqueue(&waiter);
+				}
+
+				void await_resume() const noexcept
+				{
+
+				}
+
+				AsyncMutex & mutex;
+
+				Waiter waiter{ };
+			};
+
+		public:
+			// 离开作用域时解锁
+			class Guard
+			{
+			public:
+				explicit Guard(AsyncMutex & mutex) : _mutex(&mutex)
+				{
+
+				}
+
+				Guard(Guard && rhs) noexcept : _mutex(std::exchange(rhs._mutex, nullptr))
+				{
+
+				}
+
+				~Guard()
+				{
+					if (_mutex)
+					{
+						_mutex->Unlock();
+					}
+				}
+
+				Guard(const Guard &) = delete;
+				Guard & operator=(const Guard &) = delete;
+				Guard & operator=(Guard &&) = delete;
+
+			protected:
+				AsyncMutex * _mutex{ nullptr };
+			};
+
+			struct ScopedLockAwaiter : public LockAwaiter
+			{
+				Guard await_resume() const noexcept
+				{
+					return Guard(mutex);
+				}
+			};
+
+		public:
+			AsyncMutex() = default;
+
+			~AsyncMutex()
+			{
+				TINY_ASSERT(_head == nullptr, "AsyncMutex destroyed with waiters");
+			}
+
+			AsyncMutex(const AsyncMutex &) = delete;
+			AsyncMutex & operator=(const AsyncMutex &) = delete;
+
+			bool TryLock()
+			{
+				std::lock_guard<std::mutex> lock(_lock);
+
+				if (_isLocked)
+				{
+					return false;
+				}
+
+				_isLocked = true;
+
+				return true;
+			}
+
+			// co_await mutex.Lock(), 之后需要调用 Unlock
+			LockAwaiter Lock()
+			{
+				return LockAwaiter{ *this };
+			}
+
+			// co_await mutex.ScopedLock() 返回 Guard
+			ScopedLockAwaiter ScopedLock()
+			{
+				return ScopedLockAwaiter{ { *this } };
+			}
+
+			void Unlock()
+			{
+				Waiter * waiter = nullptr;
+
+				{
+					std::lock_guard<std::mutex> lock(_lock);
+
+					TINY_ASSERT(_isLocked, "unlock on AsyncMutex is not locked");
+
+					if (_head == nullptr)
+					{
+						_isLocked = false;
+
+						return;
+					}
+
+					waiter = _head;
+
+					_head = waiter->next;
+
+					if (_head == nullptr)
+					{
+						_tail = nullptr;
+					}
+				}
+
+				// 锁保持占用状态, 直接转交
+				waiter->handle.resume();
+			}
+
+		protected:
+			// 锁已被释放时直接获得锁, 返回 false 表示不挂起
+			bool Enqueue(Waiter * waiter)
+			{
+				std::lock_guard<std::mutex> lock(_lock);
+
+				if (!_isLocked)
+				{
+					_isLocked = true;
+
+					return false;
+				}
+
+				if (_tail)
+				{
+					_tail->next = waiter;
+				}
+				else
+				{
+					_head = waiter;
+				}
+
+				_tail = waiter;
+
+				return true;
+			}
+
+		protected:
+			bool _isLocked{ false };
+
+			Waiter * _head{ nullptr };
+			Waiter * _tail{ nullptr };
+
+			std::mutex _lock{ };
+		};
+	}
+}
+
+
+#endif // TINY_CORE_COROUTINE
+
+
+#endif // __TINY_CORE__COROUTINE__ASYNC_MUTEX__H__
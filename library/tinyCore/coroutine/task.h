@@ -0,0 +1,294 @@
+#ifndef __TINY_CORE__COROUTINE__TASK__H__
+#define __TINY_CORE__COROUTINE__TASK__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 协程任务 (需要 C++20, 定义 TINY_CORE_COROUTINE 后启用)
+ *
+ *  Task 是惰性的, 创建后不执行, 被 co_await 时才开始, 结束时通过对称转移直接恢复等待方, 不增加调用栈深度
+ *
+ *  Spawn 在当前线程启动任务, 运行到第一个挂起点后返回 pool::Future, 可以 Get, Then 或再次 co_await
+ *
+ *  Task<int> Handle(ThreadPool & pool)
+ *  {
+ *      co_await pool.Schedule();             // 转移到线程池
+ *
+ *      int value = co_await pool.Async(Load); // 等待期间不占用工作线程
+ *
+ *      co_return value + 1;
+ *  }
+ *
+ */
+
+
+#if defined(TINY_CORE_COROUTINE)
+#
+#  include <coroutine>
+#
+#endif
+
+#include <tinyCore/pool/future.h>
+
+
+#if defined(TINY_CORE_COROUTINE)
+
+
+namespace tinyCore
+{
+	namespace coroutine
+	{
+		template <typename TypeT>
+		struct TaskResult
+		{
+			template <typename ValueT>
+			void return_value(ValueT && value)
+			{
+				result.emplace(std::forward<ValueT>(value));
+			}
+
+			TypeT Take()
+			{
+				return std::move(*result);
+			}
+
+			std::optional<TypeT> result{ };
+		};
+
+		template <>
+		struct TaskResult<void>
+		{
+			void return_void()
+			{
+
+			}
+
+			void Take()
+			{
+
+			}
+		};
+
+		template <typename TypeT = void>
+		class Task
+		{
+		public:
+			struct promise_type : public TaskResult<TypeT>
+			{
+				// 结束时恢复等待方, 没有等待方时停在终点, 由 Task 析构时销毁
+				struct FinalAwaiter
+				{
+					bool await_ready() const noexcept
+					{
+						return false;
+					}
+
+					std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+					{
+						auto continuation = handle.promise().continuation;
+
+						return continuation ? continuation : std::noop_coroutine();
+					}
+
+					void await_resume() const noexcept
+					{
+
+					}
+				};
+
+				Task get_return_object()
+				{
+					return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+				}
+
+				std::suspend_always initial_suspend() const noexcept
+				{
+					return { };
+				}
+
+				FinalAwaiter final_suspend() const noexcept
+				{
+					return { };
+				}
+
+				void unhandled_exception()
+				{
+					exception = std::current_exception();
+				}
+
+				std::coroutine_handle<> continuation{ };
+
+				std::exception_ptr exception{ };
+			};
+
+			using HandleT = std::coroutine_handle<promise_type>;
+
+		public:
+			Task() = default;
+
+			Task(Task && rhs) noexcept : _handle(std::exchange(rhs._handle, nullptr))
+			{
+
+			}
+
+			Task & operator=(Task && rhs) noexcept
+			{
+				if (this != &rhs)
+				{
+					Destroy();
+
+					_handle = std::exchange(rhs._handle, nullptr);
+				}
+
+				return *this;
+			}
+
+			~Task()
+			{
+				Destroy();
+			}
+
+			Task(const Task &) = delete;
+			Task & operator=(const Task &) = delete;
+
+			bool Valid() const
+			{
+				return static_cast<bool>(_handle);
+			}
+
+			bool IsDone() const
+			{
+				return _handle && _handle.done();
+			}
+
+			// 启动任务并在结束后恢复等待方, 结果或异常在恢复后取出
+			auto operator co_await() &&
+			{
+				TINY_ASSERT(_handle, "task is invalid");
+
+				struct Awaiter
+				{
+					bool await_ready() const noexcept
+					{
+						return handle.done();
+					}
+
+					std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+					{
+						handle.promise().continuation = awaiting;
+
+						return handle;
+					}
+
+					TypeT await_resume()
+					{
+						if (handle.promise().exception)
+						{
+							std::rethrow_exception(handle.promise().exception);
+						}
+
+						return handle.promise().Take();
+					}
+
+					HandleT handle;
+				};
+
+				return Awaiter{ _handle };
+			}
+
+		protected:
+			explicit Task(HandleT handle) : _handle(handle)
+			{
+
+			}
+
+			void Destroy()
+			{
+				if (_handle)
+				{
+					_handle.destroy();
+
+					_handle = nullptr;
+				}
+			}
+
+		protected:
+			HandleT _handle{ };
+		};
+
+		// 立即开始, 结束后自行销毁的协程, 只用于驱动 Spawn
+		struct DetachedTask
+		{
+			struct promise_type
+			{
+				DetachedTask get_return_object() const noexcept
+				{
+					return { };
+				}
+
+				std::suspend_never initial_suspend() const noexcept
+				{
+					return { };
+				}
+
+				std::suspend_never final_suspend() const noexcept
+				{
+					return { };
+				}
+
+				void return_void() const noexcept
+				{
+
+				}
+
+				void unhandled_exception() const noexcept
+				{
+					std::terminate();
+				}
+			};
+		};
+
+		template <typename TypeT>
+		DetachedTask Drive(Task<TypeT> task, pool::Promise<TypeT> promise)
+		{
+			try
+			{
+				if constexpr (std::is_void<TypeT>::value)
+				{
+					co_await std::move(task);
+
+					promise.SetValue();
+				}
+				else
+				{
+					promise.SetValue(co_await std::move(task));
+				}
+			}
+			catch (...)
+			{
+				promise.SetException(std::current_exception());
+			}
+		}
+
+		// 在当前线程启动任务, 返回任务结果的 Future
+		template <typename TypeT>
+		pool::Future<TypeT> Spawn(Task<TypeT> task)
+		{
+			pool::Promise<TypeT> promise;
+
+			pool::Future<TypeT> future = promise.GetFuture();
+
+			Drive(std::move(task), std::move(promise));
+
+			return future;
+		}
+	}
+}
+
+
+#endif // TINY_CORE_COROUTINE
+
+
+#endif // __TINY_CORE__COROUTINE__TASK__H__
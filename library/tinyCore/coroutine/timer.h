@@ -0,0 +1,87 @@
+#ifndef __TINY_CORE__COROUTINE__TIMER__H__
+#define __TINY_CORE__COROUTINE__TIMER__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 协程定时等待 (需要 C++20, 定义 TINY_CORE_COROUTINE 后启用)
+ *
+ *  co_await Sleep(wheel, delay) 向时间轮注册定时器后挂起, 不占用线程,
+ *  到期后在推进时间轮的线程上恢复 (Advance), 或由 Dispatch 投递到线程池恢复
+ *
+ */
+
+
+#if defined(TINY_CORE_COROUTINE)
+#
+#  include <coroutine>
+#
+#endif
+
+#include <tinyCore/container/timerWheel.h>
+
+
+#if defined(TINY_CORE_COROUTINE)
+
+
+namespace tinyCore
+{
+	namespace coroutine
+	{
+		template <typename WheelT>
+		struct SleepAwaiter
+		{
+			bool await_ready() const noexcept
+			{
+				return false;
+			}
+
+			void await_suspend(std::coroutine_handle<> handle)
+			{
+				if (isAt)
+				{
+					wheel.AddAt(when, [handle]() { handle.resume(); });
+				}
+				else
+				{
+					wheel.Add(delay, [handle]() { handle.resume(); });
+				}
+			}
+
+			void await_resume() const noexcept
+			{
+
+			}
+
+			WheelT & wheel;
+
+			bool isAt{ false };
+
+			SteadyClockDuration delay{ };
+
+			SteadyClockTimesPoint when{ };
+		};
+
+		// 挂起 delay 后恢复, 精度为时间轮的 tick
+		template <typename WheelT>
+		SleepAwaiter<WheelT> Sleep(WheelT & wheel, const SteadyClockDuration & delay)
+		{
+			return SleepAwaiter<WheelT>{ wheel, false, delay, { } };
+		}
+
+		// 挂起到 when 后恢复
+		template <typename WheelT>
+		SleepAwaiter<WheelT> SleepUntil(WheelT & wheel, const SteadyClockTimesPoint & when)
+		{
+			return SleepAwaiter<WheelT>{ wheel, true, { }, when };
+		}
+	}
+}
+
+
+#endif // TINY_CORE_COROUTINE
+
+
+#endif // __TINY_CORE__COROUTINE__TIMER__H__
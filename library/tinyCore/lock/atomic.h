@@ -31,16 +31,34 @@ namespace tinyCore
 
 			}
 
-			void store(TypeT val)
+			void store(TypeT val, std::memory_order = std::memory_order_seq_cst)
 			{
 				value = val;
 			}
 
-			TypeT load(std::memory_order) const
+			TypeT load(std::memory_order = std::memory_order_seq_cst) const
 			{
 				return value;
 			}
 
+			TypeT fetch_add(TypeT val, std::memory_order = std::memory_order_seq_cst)
+			{
+				TypeT old = value;
+
+				value += val;
+
+				return old;
+			}
+
+			TypeT fetch_sub(TypeT val, std::memory_order = std::memory_order_seq_cst)
+			{
+				TypeT old = value;
+
+				value -= val;
+
+				return old;
+			}
+
 		public:
 			TypeT value{ };
 		};
@@ -0,0 +1,359 @@
+#ifndef __TINY_CORE__LOCK__EPOCH__H__
+#define __TINY_CORE__LOCK__EPOCH__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 基于纪元的内存回收 (epoch based reclamation)
+ *
+ *  读线程访问共享节点前调用Pin进入当前纪元, 删除方摘除节点后调用Retire延迟释放,
+ *  当所有活跃线程都已进入新的纪元后, 两个纪元之前退休的节点不可能再被访问, 此时才真正释放
+ *
+ *  每个线程在每个域中占用一条记录, 线程退出时记录归还给域供其他线程复用, 记录中未释放的节点由接手的线程继续回收
+ *
+ */
+
+
+#include <tinyCore/common/common.h>
+
+
+namespace tinyCore
+{
+	namespace lock
+	{
+		class EpochDomain
+		{
+			static const uint64_t IDLE = UINT64_MAX;
+
+			// 每退休若干个节点尝试推进纪元并回收一次
+			static const std::size_t COLLECT_INTERVAL = 64;
+
+			struct Retired
+			{
+				void * pointer{ nullptr };
+
+				void (*deleter)(void *){ nullptr };
+
+				uint64_t epoch{ 0 };
+			};
+
+			struct alignas(64) Record
+			{
+				std::atomic<uint64_t> epoch{ IDLE };
+
+				std::atomic<bool> isOwned{ false };
+
+				uint32_t depth{ 0 };
+
+				std::size_t retireCount{ 0 };
+
+				std::vector<Retired> retired{ };
+
+				Record * next{ nullptr };
+			};
+
+			// 线程缓存的记录, 线程退出时归还仍然存活的域
+			struct LocalCache
+			{
+				~LocalCache()
+				{
+					std::lock_guard<std::mutex> lock(RegistryLock());
+
+					for (auto &iter : entries)
+					{
+						if (Registry().count(iter.first))
+						{
+							iter.second->isOwned.store(false, std::memory_order_release);
+						}
+					}
+				}
+
+				std::vector<std::pair<uint64_t, Record *>> entries{ };
+			};
+
+		public:
+			// 作用域内当前线程处于活跃状态, 可以嵌套
+			class Guard
+			{
+				friend class EpochDomain;
+
+			public:
+				Guard(Guard && rhs) noexcept : _domain(rhs._domain), _record(rhs._record)
+				{
+					rhs._domain = nullptr;
+					rhs._record = nullptr;
+				}
+
+				Guard & operator=(Guard && rhs) noexcept
+				{
+					if (this != &rhs)
+					{
+						Release();
+
+						std::swap(_domain, rhs._domain);
+						std::swap(_record, rhs._record);
+					}
+
+					return *this;
+				}
+
+				~Guard()
+				{
+					Release();
+				}
+
+				Guard(const Guard &) = delete;
+				Guard & operator=(const Guard &) = delete;
+
+			protected:
+				Guard(EpochDomain * domain, Record * record) : _domain(domain), _record(record)
+				{
+
+				}
+
+				void Release()
+				{
+					if (_domain)
+					{
+						_domain->Exit(_record);
+
+						_domain = nullptr;
+						_record = nullptr;
+					}
+				}
+
+			protected:
+				EpochDomain * _domain{ nullptr };
+
+				Record * _record{ nullptr };
+			};
+
+		public:
+			EpochDomain() : _id(NextID())
+			{
+				std::lock_guard<std::mutex> lock(RegistryLock());
+
+				Registry().insert(_id);
+			}
+
+			// 析构时不允许再有线程访问, 未回收的节点全部释放
+			~EpochDomain()
+			{
+				{
+					std::lock_guard<std::mutex> lock(RegistryLock());
+
+					Registry().erase(_id);
+				}
+
+				Record * record = _head.load(std::memory_order_acquire);
+
+				while (record)
+				{
+					Record * next = record->next;
+
+					for (auto &iter : record->retired)
+					{
+						iter.deleter(iter.pointer);
+					}
+
+					delete record;
+
+					record = next;
+				}
+			}
+
+			EpochDomain(const EpochDomain &) = delete;
+			EpochDomain & operator=(const EpochDomain &) = delete;
+
+			Guard Pin()
+			{
+				Record * record = LocalRecord();
+
+				if (record->depth++ == 0)
+				{
+					record->epoch.store(_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+					// 必须在读取任何共享节点之前对推进纪元的线程可见
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+				}
+
+				return Guard(this, record);
+			}
+
+			// 节点必须已从数据结构中摘除
+			template <typename TypeT>
+			void Retire(TypeT * pointer)
+			{
+				Retire(pointer, [](void * value) { delete static_cast<TypeT *>(value); });
+			}
+
+			void Retire(void * pointer, void (*deleter)(void *))
+			{
+				Record * record = LocalRecord();
+
+				record->retired.push_back(Retired{ pointer, deleter, _epoch.load(std::memory_order_acquire) });
+
+				if (++record->retireCount % COLLECT_INTERVAL == 0)
+				{
+					Collect(record);
+				}
+			}
+
+			// 尝试推进纪元并回收当前线程可回收的节点
+			void Flush()
+			{
+				Record * record = LocalRecord();
+
+				TryAdvance();
+
+				Collect(record);
+			}
+
+			uint64_t Epoch() const
+			{
+				return _epoch.load(std::memory_order_acquire);
+			}
+
+			// 当前线程尚未释放的节点数量
+			std::size_t PendingCount()
+			{
+				return LocalRecord()->retired.size();
+			}
+
+		protected:
+			void Exit(Record * record)
+			{
+				if (--record->depth == 0)
+				{
+					record->epoch.store(IDLE, std::memory_order_release);
+				}
+			}
+
+			// 所有活跃线程都处于当前纪元时推进一次
+			bool TryAdvance()
+			{
+				uint64_t epoch = _epoch.load(std::memory_order_relaxed);
+
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				for (Record * record = _head.load(std::memory_order_acquire); record; record = record->next)
+				{
+					// 与退出时的release配对, 保证其读取发生在回收之前
+					uint64_t local = record->epoch.load(std::memory_order_acquire);
+
+					if (local != IDLE && local != epoch)
+					{
+						return false;
+					}
+				}
+
+				return _epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_acq_rel);
+			}
+
+			void Collect(Record * record)
+			{
+				TryAdvance();
+
+				uint64_t epoch = _epoch.load(std::memory_order_acquire);
+
+				auto & retired = record->retired;
+
+				std::size_t keep = 0;
+
+				for (std::size_t i = 0; i < retired.size(); ++i)
+				{
+					if (retired[i].epoch + 2 <= epoch)
+					{
+						retired[i].deleter(retired[i].pointer);
+					}
+					else
+					{
+						retired[keep++] = retired[i];
+					}
+				}
+
+				retired.resize(keep);
+			}
+
+			Record * LocalRecord()
+			{
+				static thread_local LocalCache cache;
+
+				for (auto &iter : cache.entries)
+				{
+					if (iter.first == _id)
+					{
+						return iter.second;
+					}
+				}
+
+				Record * record = AcquireRecord();
+
+				cache.entries.emplace_back(_id, record);
+
+				return record;
+			}
+
+			Record * AcquireRecord()
+			{
+				for (Record * record = _head.load(std::memory_order_acquire); record; record = record->next)
+				{
+					bool isOwned = false;
+
+					if (!record->isOwned.load(std::memory_order_relaxed) &&
+						record->isOwned.compare_exchange_strong(isOwned, true, std::memory_order_acquire))
+					{
+						return record;
+					}
+				}
+
+				auto * record = new Record();
+
+				record->isOwned.store(true, std::memory_order_relaxed);
+
+				record->next = _head.load(std::memory_order_relaxed);
+
+				while (!_head.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed))
+				{
+
+				}
+
+				return record;
+			}
+
+			static uint64_t NextID()
+			{
+				static std::atomic<uint64_t> id{ 0 };
+
+				return ++id;
+			}
+
+			// 不析构, 避免线程退出晚于静态对象析构
+			static std::unordered_set<uint64_t> & Registry()
+			{
+				static auto * registry = new std::unordered_set<uint64_t>();
+
+				return *registry;
+			}
+
+			static std::mutex & RegistryLock()
+			{
+				static auto * lock = new std::mutex();
+
+				return *lock;
+			}
+
+		protected:
+			uint64_t _id{ 0 };
+
+			alignas(64) std::atomic<uint64_t> _epoch{ 0 };
+
+			std::atomic<Record *> _head{ nullptr };
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__LOCK__EPOCH__H__
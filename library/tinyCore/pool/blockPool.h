@@ -0,0 +1,260 @@
+#ifndef __TINY_CORE__POOL__BLOCK_POOL__H__
+#define __TINY_CORE__POOL__BLOCK_POOL__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 小块内存池
+ *
+ *  按16字节分级 (16 ~ 256字节), 每个线程为每一级缓存一条空闲链表, 分配与释放不加锁,
+ *  本地链表过长时整批归还到全局, 为空时从全局整批取回, 全局也没有时一次切出一批新块,
+ *  跨线程释放 (A线程分配, B线程释放) 经由全局批次流转, 稳定运行后不再向系统申请内存
+ *
+ *  内存只在池内复用, 不归还系统, 超过256字节的请求直接使用 operator new
+ *
+ */
+
+
+#include <tinyCore/debug/trace.h>
+
+
+namespace tinyCore
+{
+	namespace pool
+	{
+		class BlockPool
+		{
+			static const std::size_t ALIGN_SIZE  = 16;
+			static const std::size_t CLASS_COUNT = 16;
+			static const std::size_t BATCH_COUNT = 64;
+
+			struct Block
+			{
+				Block * next;
+			};
+
+			struct Central
+			{
+				std::mutex lock{ };
+
+				std::vector<std::pair<Block *, std::size_t>> batches{ };
+			};
+
+			// 线程退出时把缓存的块全部归还
+			struct Local
+			{
+				~Local()
+				{
+					for (std::size_t i = 0; i < CLASS_COUNT; ++i)
+					{
+						if (head[i])
+						{
+							Instance().Release(i, head[i], count[i]);
+
+							head[i]  = nullptr;
+							count[i] = 0;
+						}
+					}
+				}
+
+				Block * head[CLASS_COUNT]{ };
+
+				std::size_t count[CLASS_COUNT]{ };
+			};
+
+		public:
+			static const std::size_t MAX_SIZE = ALIGN_SIZE * CLASS_COUNT;
+
+			static void * Allocate(const std::size_t size)
+			{
+				if (size > MAX_SIZE)
+				{
+					return ::operator new(size);
+				}
+
+				std::size_t index = ClassIndex(size);
+
+				Local & local = Cache();
+
+				if (local.head[index] == nullptr)
+				{
+					local.count[index] = Instance().Acquire(index, local.head[index]);
+				}
+
+				Block * block = local.head[index];
+
+				local.head[index] = block->next;
+
+				--local.count[index];
+
+				return block;
+			}
+
+			static void Free(void * pointer, const std::size_t size)
+			{
+				if (pointer == nullptr)
+				{
+					return;
+				}
+
+				if (size > MAX_SIZE)
+				{
+					::operator delete(pointer);
+
+					return;
+				}
+
+				std::size_t index = ClassIndex(size);
+
+				Local & local = Cache();
+
+				auto * block = static_cast<Block *>(pointer);
+
+				block->next = local.head[index];
+
+				local.head[index] = block;
+
+				// 保留一批, 多出的一批归还全局
+				if (++local.count[index] >= BATCH_COUNT * 2)
+				{
+					Block * tail = local.head[index];
+
+					for (std::size_t i = 1; i < BATCH_COUNT; ++i)
+					{
+						tail = tail->next;
+					}
+
+					Block * batch = local.head[index];
+
+					local.head[index] = tail->next;
+
+					tail->next = nullptr;
+
+					local.count[index] -= BATCH_COUNT;
+
+					Instance().Release(index, batch, BATCH_COUNT);
+				}
+			}
+
+		protected:
+			BlockPool() = default;
+
+			// 进程内唯一, 不析构, 保证线程退出与静态析构的先后顺序不影响归还
+			static BlockPool & Instance()
+			{
+				static auto * instance = new BlockPool();
+
+				return *instance;
+			}
+
+			static Local & Cache()
+			{
+				static thread_local Local local{ };
+
+				return local;
+			}
+
+			static std::size_t ClassIndex(const std::size_t size)
+			{
+				return size == 0 ? 0 : (size - 1) / ALIGN_SIZE;
+			}
+
+			void Release(const std::size_t index, Block * head, const std::size_t count)
+			{
+				std::lock_guard<std::mutex> lock(_central[index].lock);
+
+				_central[index].batches.emplace_back(head, count);
+			}
+
+			std::size_t Acquire(const std::size_t index, Block *& head)
+			{
+				{
+					std::lock_guard<std::mutex> lock(_central[index].lock);
+
+					auto & batches = _central[index].batches;
+
+					if (!batches.empty())
+					{
+						head = batches.back().first;
+
+						std::size_t count = batches.back().second;
+
+						batches.pop_back();
+
+						return count;
+					}
+				}
+
+				std::size_t size = (index + 1) * ALIGN_SIZE;
+
+				auto * chunk = static_cast<char *>(::operator new(size * BATCH_COUNT));
+
+				for (std::size_t i = 0; i < BATCH_COUNT; ++i)
+				{
+					reinterpret_cast<Block *>(chunk + i * size)->next = i + 1 < BATCH_COUNT ? reinterpret_cast<Block *>(chunk + (i + 1) * size) : nullptr;
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(_chunkLock);
+
+					_chunks.push_back(chunk);
+				}
+
+				head = reinterpret_cast<Block *>(chunk);
+
+				return BATCH_COUNT;
+			}
+
+		protected:
+			Central _central[CLASS_COUNT]{ };
+
+			std::mutex _chunkLock{ };
+
+			std::vector<char *> _chunks{ };
+		};
+
+		// 标准分配器接口, 可用于 std::promise, std::allocate_shared 等
+		template <typename TypeT>
+		struct BlockAllocator
+		{
+			static_assert(alignof(TypeT) <= 16, "TypeT alignment must not exceed 16");
+
+			using value_type = TypeT;
+
+			BlockAllocator() = default;
+
+			template <typename OtherT>
+			BlockAllocator(const BlockAllocator<OtherT> &) noexcept
+			{
+
+			}
+
+			TypeT * allocate(const std::size_t count)
+			{
+				return static_cast<TypeT *>(BlockPool::Allocate(count * sizeof(TypeT)));
+			}
+
+			void deallocate(TypeT * pointer, const std::size_t count) noexcept
+			{
+				BlockPool::Free(pointer, count * sizeof(TypeT));
+			}
+
+			template <typename OtherT>
+			bool operator == (const BlockAllocator<OtherT> &) const noexcept
+			{
+				return true;
+			}
+
+			template <typename OtherT>
+			bool operator != (const BlockAllocator<OtherT> &) const noexcept
+			{
+				return false;
+			}
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__POOL__BLOCK_POOL__H__
@@ -0,0 +1,461 @@
+#ifndef __TINY_CORE__POOL__FUTURE__H__
+#define __TINY_CORE__POOL__FUTURE__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 支持后续任务的 Future / Promise
+ *
+ *  Then 不阻塞任何线程: 结果就绪时由设置结果的线程把后续任务投递到线程池,
+ *  注册时结果已经就绪则立即投递, 前一步抛出的异常沿链条传递, 跳过后续的函数
+ *
+ *  Future 只能被消费一次 (Get, Then 或 co_await), 共享状态从 BlockPool 分配
+ *
+ */
+
+
+#if defined(TINY_CORE_COROUTINE)
+#
+#  include <coroutine>
+#
+#endif
+
+#include <optional>
+
+#include <tinyCore/pool/blockPool.h>
+#include <tinyCore/pool/inlineTask.h>
+
+
+namespace tinyCore
+{
+	namespace pool
+	{
+		template <typename TypeT>
+		class Future;
+
+		template <typename TypeT>
+		class Promise;
+
+		template <typename TypeT>
+		struct FutureState
+		{
+			struct Unit
+			{
+
+			};
+
+			using ValueT = typename std::conditional<std::is_void<TypeT>::value, Unit, TypeT>::type;
+
+			// 设置结果后取出后续任务, 在锁外执行
+			template <typename... Args>
+			void SetValue(Args &&... args)
+			{
+				InlineTask continuation;
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+
+					TINY_THROW_EXCEPTION_IF(isReady, debug::ThreadError, "promise already satisfied")
+
+					value.emplace(std::forward<Args>(args)...);
+
+					isReady = true;
+
+					continuation = std::move(next);
+				}
+
+				condition.notify_all();
+
+				if (continuation)
+				{
+					continuation();
+				}
+			}
+
+			void SetException(std::exception_ptr pointer)
+			{
+				InlineTask continuation;
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+
+					TINY_THROW_EXCEPTION_IF(isReady, debug::ThreadError, "promise already satisfied")
+
+					exception = std::move(pointer);
+
+					isReady = true;
+
+					continuation = std::move(next);
+				}
+
+				condition.notify_all();
+
+				if (continuation)
+				{
+					continuation();
+				}
+			}
+
+			void SetContinuation(InlineTask && continuation)
+			{
+				if (!TrySetContinuation(continuation))
+				{
+					continuation();
+				}
+			}
+
+			// 结果已就绪时不取走 continuation, 返回 false
+			bool TrySetContinuation(InlineTask & continuation)
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				if (isReady)
+				{
+					return false;
+				}
+
+				next = std::move(continuation);
+
+				return true;
+			}
+
+			void Wait()
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+
+				condition.wait(lock, [this]() { return isReady; });
+			}
+
+			bool isReady{ false };
+
+			std::mutex mutex{ };
+
+			std::condition_variable condition{ };
+
+			std::exception_ptr exception{ };
+
+			std::optional<ValueT> value{ };
+
+			InlineTask next{ };
+		};
+
+		template <typename TypeT>
+		class Future
+		{
+			template <typename FuncT, typename ValueT>
+			struct Result
+			{
+				using type = decltype(std::declval<FuncT &>()(std::declval<ValueT>()));
+			};
+
+			template <typename FuncT>
+			struct Result<FuncT, void>
+			{
+				using type = decltype(std::declval<FuncT &>()());
+			};
+
+			using StateT = FutureState<TypeT>;
+
+			friend class Promise<TypeT>;
+
+		public:
+			Future() = default;
+
+			Future(Future &&) noexcept = default;
+			Future & operator=(Future &&) noexcept = default;
+
+			Future(const Future &) = delete;
+			Future & operator=(const Future &) = delete;
+
+			bool Valid() const
+			{
+				return _state != nullptr;
+			}
+
+			bool IsReady() const
+			{
+				TINY_ASSERT(_state, "future is invalid");
+
+				std::lock_guard<std::mutex> lock(_state->mutex);
+
+				return _state->isReady;
+			}
+
+			void Wait() const
+			{
+				TINY_ASSERT(_state, "future is invalid");
+
+				_state->Wait();
+			}
+
+			// 阻塞等待结果, 调用后 Future 失效
+			TypeT Get()
+			{
+				TINY_ASSERT(_state, "future is invalid");
+
+				auto state = std::move(_state);
+
+				state->Wait();
+
+				if (state->exception)
+				{
+					std::rethrow_exception(state->exception);
+				}
+
+				return Take(*state);
+			}
+
+			// 结果就绪后把 func(结果) 投递到 pool, 返回 func 返回值的 Future, 调用后当前 Future 失效
+			template <typename PoolT, typename FuncT>
+			auto Then(PoolT & pool, FuncT && func) -> Future<typename Result<typename std::decay<FuncT>::type, TypeT>::type>
+			{
+				TINY_ASSERT(_state, "future is invalid");
+
+				using RetType = typename Result<typename std::decay<FuncT>::type, TypeT>::type;
+
+				Promise<RetType> promise;
+
+				Future<RetType> future = promise.GetFuture();
+
+				std::shared_ptr<StateT> state = std::move(_state);
+
+				StateT * source = state.get();
+
+				source->SetContinuation
+				(
+					[pool = &pool, state = std::move(state), function = std::forward<FuncT>(func), promise = std::move(promise)]() mutable
+					{
+						// 线程池已停止时投递失败, 任务连同 promise 一起析构, 后续的 Future 收到 broken_promise
+						try
+						{
+							pool->Post
+							(
+								[state = std::move(state), function = std::move(function), promise = std::move(promise)]() mutable
+								{
+									if (state->exception)
+									{
+										promise.SetException(state->exception);
+
+										return;
+									}
+
+									promise.Run
+									(
+										[&]()
+										{
+											return Invoke(function, *state);
+										}
+									);
+								}
+							);
+						}
+						catch (...)
+						{
+
+						}
+					}
+				);
+
+				return future;
+			}
+
+		#if defined(TINY_CORE_COROUTINE)
+
+			// co_await 等待结果, 协程在设置结果的线程上恢复, 调用后 Future 失效
+			auto operator co_await() &&
+			{
+				TINY_ASSERT(_state, "future is invalid");
+
+				struct Awaiter
+				{
+					bool await_ready() const
+					{
+						std::lock_guard<std::mutex> lock(state->mutex);
+
+						return state->isReady;
+					}
+
+					bool await_suspend(std::coroutine_handle<> handle)
+					{
+						InlineTask continuation([handle]() { handle.resume(); });
+
+						return state->TrySetContinuation(continuation);
+					}
+
+					TypeT await_resume()
+					{
+						if (state->exception)
+						{
+							std::rethrow_exception(state->exception);
+						}
+
+						return Take(*state);
+					}
+
+					std::shared_ptr<StateT> state;
+				};
+
+				return Awaiter{ std::move(_state) };
+			}
+
+		#endif
+
+		protected:
+			explicit Future(std::shared_ptr<StateT> state) : _state(std::move(state))
+			{
+
+			}
+
+			template <typename ValueT = TypeT>
+			static typename std::enable_if<std::is_void<ValueT>::value>::type Take(StateT &)
+			{
+
+			}
+
+			template <typename ValueT = TypeT>
+			static typename std::enable_if<!std::is_void<ValueT>::value, ValueT>::type Take(StateT & state)
+			{
+				return std::move(*state.value);
+			}
+
+			template <typename FuncT, typename ValueT = TypeT>
+			static auto Invoke(FuncT & func, StateT &) -> typename std::enable_if<std::is_void<ValueT>::value, decltype(func())>::type
+			{
+				return func();
+			}
+
+			template <typename FuncT, typename ValueT = TypeT>
+			static auto Invoke(FuncT & func, StateT & state) -> typename std::enable_if<!std::is_void<ValueT>::value, decltype(func(std::declval<ValueT>()))>::type
+			{
+				return func(std::move(*state.value));
+			}
+
+		protected:
+			std::shared_ptr<StateT> _state{ };
+		};
+
+		template <typename TypeT>
+		class Promise
+		{
+			using StateT = FutureState<TypeT>;
+
+			// 共享状态按分配器对齐要求选择内存池或默认分配器
+			using AllocatorT = typename std::conditional<alignof(StateT) <= 16, BlockAllocator<char>, std::allocator<char>>::type;
+
+		public:
+			Promise() : _state(std::allocate_shared<StateT>(AllocatorT()))
+			{
+
+			}
+
+			Promise(Promise &&) noexcept = default;
+
+			Promise & operator=(Promise && rhs) noexcept
+			{
+				if (this != &rhs)
+				{
+					Abandon();
+
+					_state = std::move(rhs._state);
+				}
+
+				return *this;
+			}
+
+			// 未设置结果就析构时, 等待方收到 broken_promise
+			~Promise()
+			{
+				Abandon();
+			}
+
+			Promise(const Promise &) = delete;
+			Promise & operator=(const Promise &) = delete;
+
+			Future<TypeT> GetFuture()
+			{
+				TINY_ASSERT(_state, "promise is invalid");
+
+				return Future<TypeT>(_state);
+			}
+
+			template <typename... Args>
+			void SetValue(Args &&... args)
+			{
+				TINY_ASSERT(_state, "promise is invalid");
+
+				_state->SetValue(std::forward<Args>(args)...);
+
+				_state.reset();
+			}
+
+			void SetException(std::exception_ptr pointer)
+			{
+				TINY_ASSERT(_state, "promise is invalid");
+
+				_state->SetException(std::move(pointer));
+
+				_state.reset();
+			}
+
+			// 执行 func, 用返回值或抛出的异常设置结果
+			template <typename FuncT>
+			void Run(FuncT && func)
+			{
+				try
+				{
+					Fulfill(func, std::is_void<TypeT>());
+				}
+				catch (...)
+				{
+					SetException(std::current_exception());
+				}
+			}
+
+		protected:
+			template <typename FuncT>
+			void Fulfill(FuncT & func, std::true_type)
+			{
+				func();
+
+				SetValue();
+			}
+
+			template <typename FuncT>
+			void Fulfill(FuncT & func, std::false_type)
+			{
+				SetValue(func());
+			}
+
+			void Abandon()
+			{
+				if (_state == nullptr)
+				{
+					return;
+				}
+
+				bool isReady = false;
+
+				{
+					std::lock_guard<std::mutex> lock(_state->mutex);
+
+					isReady = _state->isReady;
+				}
+
+				if (!isReady)
+				{
+					_state->SetException(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+				}
+
+				_state.reset();
+			}
+
+		protected:
+			std::shared_ptr<StateT> _state{ };
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__POOL__FUTURE__H__
@@ -0,0 +1,182 @@
+#ifndef __TINY_CORE__POOL__INLINE_TASK__H__
+#define __TINY_CORE__POOL__INLINE_TASK__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 小对象内联的任务
+ *
+ *  只可移动的 void() 可调用对象, 不超过64字节且移动不抛异常的可调用对象直接存放在内部, 不申请内存,
+ *  超过时退化为堆上存放, 与 std::function 相比不要求可复制, 可以捕获 std::promise, std::unique_ptr 等
+ *
+ */
+
+
+#include <tinyCore/debug/trace.h>
+
+
+namespace tinyCore
+{
+	namespace pool
+	{
+		class InlineTask
+		{
+			struct Operation
+			{
+				void (* invoke)(void *);
+				void (* move)(void *, void *);
+				void (* destroy)(void *);
+			};
+
+		public:
+			static const std::size_t INLINE_SIZE = 64;
+
+			template <typename FuncT>
+			static constexpr bool IsInline()
+			{
+				return sizeof(FuncT) <= INLINE_SIZE &&
+					   alignof(FuncT) <= alignof(std::max_align_t) &&
+					   std::is_nothrow_move_constructible<FuncT>::value;
+			}
+
+		public:
+			InlineTask() = default;
+
+			template <typename FuncT, typename = typename std::enable_if<!std::is_same<typename std::decay<FuncT>::type, InlineTask>::value>::type>
+			InlineTask(FuncT && func)
+			{
+				using Type = typename std::decay<FuncT>::type;
+
+				Construct<Type>(std::forward<FuncT>(func), std::integral_constant<bool, IsInline<Type>()>());
+			}
+
+			InlineTask(InlineTask && rhs) noexcept
+			{
+				MoveFrom(rhs);
+			}
+
+			InlineTask & operator=(InlineTask && rhs) noexcept
+			{
+				if (this != &rhs)
+				{
+					Reset();
+
+					MoveFrom(rhs);
+				}
+
+				return *this;
+			}
+
+			~InlineTask()
+			{
+				Reset();
+			}
+
+			InlineTask(const InlineTask &) = delete;
+			InlineTask & operator=(const InlineTask &) = delete;
+
+			void operator() ()
+			{
+				TINY_ASSERT(_operation, "task is empty");
+
+				_operation->invoke(_storage);
+			}
+
+			explicit operator bool() const
+			{
+				return _operation != nullptr;
+			}
+
+			void Reset()
+			{
+				if (_operation)
+				{
+					_operation->destroy(_storage);
+
+					_operation = nullptr;
+				}
+			}
+
+		protected:
+			template <typename FuncT>
+			static void InlineInvoke(void * storage)
+			{
+				(*static_cast<FuncT *>(storage))();
+			}
+
+			template <typename FuncT>
+			static void InlineMove(void * from, void * to)
+			{
+				new(to) FuncT(std::move(*static_cast<FuncT *>(from)));
+
+				static_cast<FuncT *>(from)->~FuncT();
+			}
+
+			template <typename FuncT>
+			static void InlineDestroy(void * storage)
+			{
+				static_cast<FuncT *>(storage)->~FuncT();
+			}
+
+			template <typename FuncT>
+			static void HeapInvoke(void * storage)
+			{
+				(**static_cast<FuncT **>(storage))();
+			}
+
+			template <typename FuncT>
+			static void HeapMove(void * from, void * to)
+			{
+				*static_cast<FuncT **>(to) = *static_cast<FuncT **>(from);
+			}
+
+			template <typename FuncT>
+			static void HeapDestroy(void * storage)
+			{
+				delete *static_cast<FuncT **>(storage);
+			}
+
+			template <typename FuncT, typename ArgT>
+			void Construct(ArgT && func, std::true_type)
+			{
+				static const Operation operation{ &InlineInvoke<FuncT>, &InlineMove<FuncT>, &InlineDestroy<FuncT> };
+
+				new(_storage) FuncT(std::forward<ArgT>(func));
+
+				_operation = &operation;
+			}
+
+			template <typename FuncT, typename ArgT>
+			void Construct(ArgT && func, std::false_type)
+			{
+				static const Operation operation{ &HeapInvoke<FuncT>, &HeapMove<FuncT>, &HeapDestroy<FuncT> };
+
+				*reinterpret_cast<FuncT **>(_storage) = new FuncT(std::forward<ArgT>(func));
+
+				_operation = &operation;
+			}
+
+			void MoveFrom(InlineTask & rhs) noexcept
+			{
+				if (rhs._operation)
+				{
+					rhs._operation->move(rhs._storage, _storage);
+
+					_operation = rhs._operation;
+
+					rhs._operation = nullptr;
+				}
+			}
+
+		protected:
+			alignas(std::max_align_t) unsigned char _storage[INLINE_SIZE]{ };
+
+			const Operation * _operation{ nullptr };
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__POOL__INLINE_TASK__H__
@@ -0,0 +1,748 @@
+#ifndef __TINY_CORE__POOL__METRICS__H__
+#define __TINY_CORE__POOL__METRICS__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 线程池任务统计
+ *
+ *  每个工作线程独占一个记录器, 只由本线程写入 (relaxed 读写, 不加锁, 也不用原子加),
+ *  读取时合并所有记录器, 退出的线程在退出前把数据并入汇总, 重置时记录基线, 之后的快照减去基线
+ *
+ *  任务数与标签计数是精确的, 等待与执行时间按提交线程每 sampleRate 个任务抽样一个,
+ *  读取三次时钟 (虚拟机中 TSC 可能需要数十纳秒) 摊到每个任务上只有几纳秒, sampleRate 为1时记录全部任务
+ *
+ *  直方图按对数分段, 每段16个线性子桶, 相对误差不超过 1/16, 与 HdrHistogram 的思路相同
+ *
+ *  计时使用 TSC (x86), 首次启用时与 steady_clock 校准, 其他平台退回 steady_clock
+ *
+ */
+
+
+#if defined(__x86_64__) || defined(__i386__)
+#
+#  include <x86intrin.h>
+#
+#endif
+
+#include <tinyCore/log/logger.h>
+
+
+namespace tinyCore
+{
+	namespace pool
+	{
+		class Cycle
+		{
+		public:
+			static uint64_t Now()
+			{
+			#if defined(__x86_64__) || defined(__i386__)
+
+				return __rdtsc();
+
+			#else
+
+				return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(TINY_TIME_STEADY_POINT().time_since_epoch()).count());
+
+			#endif
+			}
+
+			// 每个计数对应的纳秒数, 首次调用时校准 (约10毫秒)
+			static double Nanosecond()
+			{
+				static const double value = Calibrate();
+
+				return value;
+			}
+
+			static uint64_t ToNanosecond(const uint64_t count)
+			{
+				return static_cast<uint64_t>(static_cast<double>(count) * Nanosecond());
+			}
+
+		protected:
+			static double Calibrate()
+			{
+			#if defined(__x86_64__) || defined(__i386__)
+
+				auto start = TINY_TIME_STEADY_POINT();
+
+				uint64_t begin = Now();
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+				uint64_t end = Now();
+
+				double elapsed = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(TINY_TIME_STEADY_POINT() - start).count());
+
+				return end > begin ? elapsed / static_cast<double>(end - begin) : 1.0;
+
+			#else
+
+				return 1.0;
+
+			#endif
+			}
+		};
+
+		// 数值直方图 (单位由使用方决定, 线程池中为纳秒)
+		class Histogram
+		{
+			friend class HistogramRecorder;
+
+		public:
+			static const std::size_t SUB_BITS     = 4;
+			static const std::size_t SUB_COUNT    = 1 << SUB_BITS;
+			static const std::size_t MAX_BITS     = 40;
+			static const std::size_t BUCKET_COUNT = (MAX_BITS - SUB_BITS + 1) * SUB_COUNT;
+
+			// 小于16的值各占一个桶, 之后每翻一倍分为16个桶, 超过 2^40 的值计入最后一个桶
+			static std::size_t Index(const uint64_t value)
+			{
+				if (value < SUB_COUNT)
+				{
+					return static_cast<std::size_t>(value);
+				}
+
+				std::size_t bits = HighestBit(value);
+
+				if (bits >= MAX_BITS)
+				{
+					return BUCKET_COUNT - 1;
+				}
+
+				return (bits - SUB_BITS + 1) * SUB_COUNT + static_cast<std::size_t>((value >> (bits - SUB_BITS)) & (SUB_COUNT - 1));
+			}
+
+			// 桶的下界
+			static uint64_t Lower(const std::size_t index)
+			{
+				if (index < SUB_COUNT)
+				{
+					return index;
+				}
+
+				return static_cast<uint64_t>(SUB_COUNT + index % SUB_COUNT) << (index / SUB_COUNT - 1);
+			}
+
+			// 桶的上界 (包含)
+			static uint64_t Upper(const std::size_t index)
+			{
+				return index + 1 < BUCKET_COUNT ? Lower(index + 1) - 1 : std::numeric_limits<uint64_t>::max();
+			}
+
+			Histogram() : _counts(BUCKET_COUNT, 0)
+			{
+
+			}
+
+			void Record(const uint64_t value, const uint64_t count = 1)
+			{
+				_counts[Index(value)] += count;
+
+				_count += count;
+				_sum   += value * count;
+			}
+
+			void Merge(const Histogram & rhs)
+			{
+				for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+				{
+					_counts[i] += rhs._counts[i];
+				}
+
+				_count += rhs._count;
+				_sum   += rhs._sum;
+			}
+
+			// 减去之前的快照 (rhs 必须是本直方图更早的状态)
+			void Subtract(const Histogram & rhs)
+			{
+				for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+				{
+					_counts[i] -= rhs._counts[i];
+				}
+
+				_count -= rhs._count;
+				_sum   -= rhs._sum;
+			}
+
+			void Clear()
+			{
+				std::fill(_counts.begin(), _counts.end(), 0);
+
+				_count = 0;
+				_sum   = 0;
+			}
+
+			uint64_t Count() const
+			{
+				return _count;
+			}
+
+			uint64_t Sum() const
+			{
+				return _sum;
+			}
+
+			double Mean() const
+			{
+				return _count ? static_cast<double>(_sum) / static_cast<double>(_count) : 0.0;
+			}
+
+			// 返回所在桶的上界, 与 Max 取较小值
+			uint64_t Percentile(const double percent) const
+			{
+				if (_count == 0)
+				{
+					return 0;
+				}
+
+				auto rank = static_cast<uint64_t>(std::ceil(std::min(std::max(percent, 0.0), 100.0) / 100.0 * static_cast<double>(_count)));
+
+				rank = std::max<uint64_t>(rank, 1);
+
+				uint64_t total = 0;
+
+				for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+				{
+					total += _counts[i];
+
+					if (total >= rank)
+					{
+						return std::min(Upper(i), Max());
+					}
+				}
+
+				return Max();
+			}
+
+			uint64_t Min() const
+			{
+				for (std::size_t i = 0; i < BUCKET_COUNT; ++i)
+				{
+					if (_counts[i])
+					{
+						return Lower(i);
+					}
+				}
+
+				return 0;
+			}
+
+			// 最后一个桶没有上界, 以其下界为准
+			uint64_t Max() const
+			{
+				for (std::size_t i = BUCKET_COUNT; i > 0; --i)
+				{
+					if (_counts[i - 1])
+					{
+						return i == BUCKET_COUNT ? Lower(i - 1) : Upper(i - 1);
+					}
+				}
+
+				return 0;
+			}
+
+			const std::vector<uint64_t> & Counts() const
+			{
+				return _counts;
+			}
+
+		protected:
+			static std::size_t HighestBit(const uint64_t value)
+			{
+			#if defined(__GNUC__)
+
+				return static_cast<std::size_t>(63 - __builtin_clzll(value));
+
+			#else
+
+				std::size_t bits = 0;
+
+				for (uint64_t v = value; v >>= 1; )
+				{
+					++bits;
+				}
+
+				return bits;
+
+			#endif
+			}
+
+		protected:
+			uint64_t _count{ 0 };
+			uint64_t _sum{ 0 };
+
+			std::vector<uint64_t> _counts;
+		};
+
+		// 只由一个线程写入, 其他线程随时可读
+		class HistogramRecorder
+		{
+		public:
+			void Record(const uint64_t value)
+			{
+				Add(_counts[Histogram::Index(value)], 1);
+
+				Add(_count, 1);
+				Add(_sum, value);
+			}
+
+			// 累加到 histogram 中, 与写入并发时各计数之间可能略有出入
+			void Load(Histogram & histogram) const
+			{
+				for (std::size_t i = 0; i < Histogram::BUCKET_COUNT; ++i)
+				{
+					histogram._counts[i] += _counts[i].load(std::memory_order_relaxed);
+				}
+
+				histogram._count += _count.load(std::memory_order_relaxed);
+				histogram._sum   += _sum.load(std::memory_order_relaxed);
+			}
+
+			static void Add(std::atomic<uint64_t> & counter, const uint64_t value)
+			{
+				counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+			}
+
+		protected:
+			std::atomic<uint64_t> _count{ 0 };
+			std::atomic<uint64_t> _sum{ 0 };
+
+			std::atomic<uint64_t> _counts[Histogram::BUCKET_COUNT]{ };
+		};
+
+		struct TagMetrics
+		{
+			std::size_t tag{ 0 };
+
+			std::string name{ };
+
+			uint64_t count{ 0 };
+
+			// 以下为抽样任务的统计
+			uint64_t sampled{ 0 };
+
+			SteadyClockDuration totalWait{ 0 };
+			SteadyClockDuration totalRun{ 0 };
+		};
+
+		// 线程池统计快照, 直方图单位为纳秒
+		struct MetricsSnapshot
+		{
+			std::vector<std::string> Lines() const
+			{
+				std::vector<std::string> lines;
+
+				lines.push_back
+				(
+					TINY_STR_FORMAT
+					(
+						"thread pool: threads {} free {} queued {}, {} tasks in {:.3f} s, {:.1f} tasks/s, sampled 1/{}",
+						threads, free, queued, tasks, TINY_TIME_DOUBLE(elapsed), throughput, sampleRate
+					)
+				);
+
+				lines.push_back(Line("wait", wait));
+				lines.push_back(Line("run ", run));
+
+				for (auto &iter : tags)
+				{
+					lines.push_back
+					(
+						TINY_STR_FORMAT
+						(
+							"  tag {:<16} count {:>10} avg wait {:>10.2f} us avg run {:>10.2f} us",
+							iter.name, iter.count,
+							iter.sampled ? TINY_TIME_DOUBLE(iter.totalWait) * 1e6 / static_cast<double>(iter.sampled) : 0.0,
+							iter.sampled ? TINY_TIME_DOUBLE(iter.totalRun)  * 1e6 / static_cast<double>(iter.sampled) : 0.0
+						)
+					);
+				}
+
+				return lines;
+			}
+
+			std::string ToString() const
+			{
+				std::string value;
+
+				for (auto &iter : Lines())
+				{
+					value += iter;
+					value += '\n';
+				}
+
+				return value;
+			}
+
+			void Dump(log::ILogger * logger) const
+			{
+				for (auto &iter : Lines())
+				{
+					TINY_LOG_INFO(logger, iter)
+				}
+			}
+
+			std::size_t threads{ 0 };
+			std::size_t free{ 0 };
+			std::size_t queued{ 0 };
+
+			uint64_t tasks{ 0 };
+
+			std::size_t sampleRate{ 0 };
+
+			// 自重置以来的时长, 以及距上一次快照的吞吐量
+			SteadyClockDuration elapsed{ 0 };
+
+			double throughput{ 0.0 };
+
+			Histogram wait{ };
+			Histogram run{ };
+
+			std::vector<TagMetrics> tags{ };
+
+		protected:
+			static std::string Line(const char * name, const Histogram & histogram)
+			{
+				return TINY_STR_FORMAT
+				(
+					"  {} us: mean {:.2f} p50 {:.2f} p90 {:.2f} p99 {:.2f} p99.9 {:.2f} max {:.2f}",
+					name,
+					histogram.Mean() / 1e3,
+					static_cast<double>(histogram.Percentile(50))   / 1e3,
+					static_cast<double>(histogram.Percentile(90))   / 1e3,
+					static_cast<double>(histogram.Percentile(99))   / 1e3,
+					static_cast<double>(histogram.Percentile(99.9)) / 1e3,
+					static_cast<double>(histogram.Max())            / 1e3
+				);
+			}
+		};
+
+		// 工作线程的记录器
+		class alignas(64) MetricsRecorder
+		{
+		public:
+			static const std::size_t MAX_TAG_COUNT = 32;
+
+			struct Tag
+			{
+				std::atomic<uint64_t> count{ 0 };
+				std::atomic<uint64_t> sampled{ 0 };
+				std::atomic<uint64_t> wait{ 0 };
+				std::atomic<uint64_t> run{ 0 };
+			};
+
+			// 未抽样的任务只计数
+			void Count(const std::size_t tag)
+			{
+				HistogramRecorder::Add(tasks, 1);
+
+				if (tag)
+				{
+					HistogramRecorder::Add(tags[tag].count, 1);
+				}
+			}
+
+			// wait 与 run 为 Cycle 计数
+			void Record(const std::size_t tag, const uint64_t wait, const uint64_t run)
+			{
+				uint64_t waitNs = Cycle::ToNanosecond(wait);
+				uint64_t runNs  = Cycle::ToNanosecond(run);
+
+				Count(tag);
+
+				this->wait.Record(waitNs);
+				this->run.Record(runNs);
+
+				if (tag)
+				{
+					HistogramRecorder::Add(tags[tag].sampled, 1);
+					HistogramRecorder::Add(tags[tag].wait, waitNs);
+					HistogramRecorder::Add(tags[tag].run, runNs);
+				}
+			}
+
+			std::atomic<uint64_t> tasks{ 0 };
+
+			HistogramRecorder wait{ };
+			HistogramRecorder run{ };
+
+			Tag tags[MAX_TAG_COUNT]{ };
+		};
+
+		// 管理所有工作线程的记录器
+		class TaskMetrics
+		{
+			struct Total
+			{
+				Total() : tags(MetricsRecorder::MAX_TAG_COUNT)
+				{
+
+				}
+
+				void Load(const MetricsRecorder & recorder)
+				{
+					tasks += recorder.tasks.load(std::memory_order_relaxed);
+
+					recorder.wait.Load(wait);
+					recorder.run.Load(run);
+
+					for (std::size_t i = 0; i < tags.size(); ++i)
+					{
+						tags[i].count   += recorder.tags[i].count.load(std::memory_order_relaxed);
+						tags[i].sampled += recorder.tags[i].sampled.load(std::memory_order_relaxed);
+						tags[i].wait    += recorder.tags[i].wait.load(std::memory_order_relaxed);
+						tags[i].run     += recorder.tags[i].run.load(std::memory_order_relaxed);
+					}
+				}
+
+				void Subtract(const Total & rhs)
+				{
+					tasks -= rhs.tasks;
+
+					wait.Subtract(rhs.wait);
+					run.Subtract(rhs.run);
+
+					for (std::size_t i = 0; i < tags.size(); ++i)
+					{
+						tags[i].count   -= rhs.tags[i].count;
+						tags[i].sampled -= rhs.tags[i].sampled;
+						tags[i].wait    -= rhs.tags[i].wait;
+						tags[i].run     -= rhs.tags[i].run;
+					}
+				}
+
+				uint64_t tasks{ 0 };
+
+				Histogram wait{ };
+				Histogram run{ };
+
+				struct Tag
+				{
+					uint64_t count{ 0 };
+					uint64_t sampled{ 0 };
+					uint64_t wait{ 0 };
+					uint64_t run{ 0 };
+				};
+
+				std::vector<Tag> tags;
+			};
+
+		public:
+			// 记录器在工作线程内注册与注销
+			class Scope
+			{
+			public:
+				Scope(TaskMetrics & metrics, MetricsRecorder *& slot) : _slot(slot), _metrics(metrics)
+				{
+					_slot = _metrics.Register();
+				}
+
+				~Scope()
+				{
+					_metrics.Unregister(_slot);
+
+					_slot = nullptr;
+				}
+
+				Scope(const Scope &) = delete;
+				Scope & operator=(const Scope &) = delete;
+
+			protected:
+				MetricsRecorder *& _slot;
+
+				TaskMetrics & _metrics;
+			};
+
+		public:
+			// 只计数不计时的任务节点标记, 真实的 Cycle 计数不会是1
+			static const uint64_t UNSAMPLED = 1;
+
+			TaskMetrics()
+			{
+				_names.emplace_back();
+
+				_resetTime = TINY_TIME_STEADY_POINT();
+				_lastTime  = _resetTime;
+			}
+
+			// 启用前先完成时钟校准, 避免在任务路径上校准; sampleRate 为0表示停用
+			void Enable(const std::size_t sampleRate)
+			{
+				if (sampleRate)
+				{
+					Cycle::Nanosecond();
+				}
+
+				_sampleRate.store(sampleRate, std::memory_order_relaxed);
+			}
+
+			bool IsEnable() const
+			{
+				return _sampleRate.load(std::memory_order_relaxed) != 0;
+			}
+
+			// 提交时调用, 返回节点的 stamp: 0 不统计, UNSAMPLED 只计数, 其他为入队时刻
+			uint64_t Stamp() const
+			{
+				std::size_t rate = _sampleRate.load(std::memory_order_relaxed);
+
+				if (rate == 0)
+				{
+					return 0;
+				}
+
+				// 每个提交线程独立倒数, 避免共享计数器
+				static thread_local std::size_t countdown = 0;
+
+				if (countdown == 0)
+				{
+					countdown = rate - 1;
+
+					return Cycle::Now();
+				}
+
+				--countdown;
+
+				return UNSAMPLED;
+			}
+
+			// 注册标签, 返回标签号 (从1开始, 0表示不带标签)
+			std::size_t AddTag(const std::string & name)
+			{
+				std::lock_guard<std::mutex> lock(_lock);
+
+				TINY_THROW_EXCEPTION_IF(_names.size() >= MetricsRecorder::MAX_TAG_COUNT, debug::SizeError,
+										TINY_STR_FORMAT("tag count must be less than {}", static_cast<std::size_t>(MetricsRecorder::MAX_TAG_COUNT)))
+
+				_names.push_back(name);
+
+				return _names.size() - 1;
+			}
+
+			MetricsRecorder * Register()
+			{
+				std::lock_guard<std::mutex> lock(_lock);
+
+				_recorders.emplace_back(new MetricsRecorder());
+
+				return _recorders.back().get();
+			}
+
+			// 由记录器所属的线程调用, 数据并入汇总
+			void Unregister(MetricsRecorder * recorder)
+			{
+				std::lock_guard<std::mutex> lock(_lock);
+
+				for (auto iter = _recorders.begin(); iter != _recorders.end(); ++iter)
+				{
+					if (iter->get() == recorder)
+					{
+						_retired.Load(*recorder);
+
+						_recorders.erase(iter);
+
+						break;
+					}
+				}
+			}
+
+			MetricsSnapshot Snapshot()
+			{
+				MetricsSnapshot snapshot;
+
+				std::lock_guard<std::mutex> lock(_lock);
+
+				Total total = Collect();
+
+				auto now = TINY_TIME_STEADY_POINT();
+
+				snapshot.tasks      = total.tasks;
+				snapshot.elapsed    = now - _resetTime;
+				snapshot.sampleRate = _sampleRate.load(std::memory_order_relaxed);
+
+				if (now > _lastTime)
+				{
+					snapshot.throughput = static_cast<double>(total.tasks - _lastTasks) / TINY_TIME_DOUBLE(now - _lastTime);
+				}
+
+				_lastTime  = now;
+				_lastTasks = total.tasks;
+
+				for (std::size_t i = 1; i < _names.size(); ++i)
+				{
+					TagMetrics tag;
+
+					tag.tag       = i;
+					tag.name      = _names[i];
+					tag.count     = total.tags[i].count;
+					tag.sampled   = total.tags[i].sampled;
+					tag.totalWait = std::chrono::duration_cast<SteadyClockDuration>(std::chrono::nanoseconds(total.tags[i].wait));
+					tag.totalRun  = std::chrono::duration_cast<SteadyClockDuration>(std::chrono::nanoseconds(total.tags[i].run));
+
+					snapshot.tags.push_back(tag);
+				}
+
+				snapshot.wait = std::move(total.wait);
+				snapshot.run  = std::move(total.run);
+
+				return snapshot;
+			}
+
+			void Reset()
+			{
+				std::lock_guard<std::mutex> lock(_lock);
+
+				// 先清空基线, Collect 返回的即是当前的累计值
+				_baseline = Total();
+
+				_baseline = Collect();
+
+				_resetTime = TINY_TIME_STEADY_POINT();
+				_lastTime  = _resetTime;
+				_lastTasks = 0;
+			}
+
+		protected:
+			// 需持有 _lock, 返回减去基线后的汇总
+			Total Collect() const
+			{
+				Total total = _retired;
+
+				for (auto &iter : _recorders)
+				{
+					total.Load(*iter);
+				}
+
+				total.Subtract(_baseline);
+
+				return total;
+			}
+
+		protected:
+			std::atomic<std::size_t> _sampleRate{ 0 };
+
+			std::mutex _lock{ };
+
+			std::vector<std::string> _names{ };
+
+			std::vector<std::unique_ptr<MetricsRecorder>> _recorders{ };
+
+			Total _retired{ };
+			Total _baseline{ };
+
+			uint64_t _lastTasks{ 0 };
+
+			SteadyClockTimesPoint _resetTime{ };
+			SteadyClockTimesPoint _lastTime{ };
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__POOL__METRICS__H__
@@ -0,0 +1,438 @@
+#ifndef __TINY_CORE__POOL__PARALLEL__H__
+#define __TINY_CORE__POOL__PARALLEL__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 基于线程池的数据并行算法
+ *
+ *  区间按递减的块大小动态领取 (剩余量 / (2 * 参与线程数), 不小于粒度), 开始时块大, 减少领取次数,
+ *  结束时块小, 各线程几乎同时完成; 调用线程也参与执行, 只在全部块都被领取后才等待未完成的块,
+ *  因此可以在工作线程内嵌套调用, 不会因等待而死锁
+ *
+ *  粒度为0时自动选择, 任一块抛出异常时其余未开始的块不再执行, 等待结束后在调用线程重新抛出
+ *
+ */
+
+
+#include <tinyCore/pool/threadPool.h>
+
+
+namespace tinyCore
+{
+	namespace pool
+	{
+		class Parallel
+		{
+			template <typename FuncT>
+			struct Job
+			{
+				Job(FuncT & f, const std::size_t s, const std::size_t g, const std::size_t w) : func(f), size(s), grain(g), divisor(w * 2)
+				{
+
+				}
+
+				// 领取一块, 块大小随剩余量递减
+				bool Claim(std::size_t & begin, std::size_t & end)
+				{
+					begin = next.load(std::memory_order_relaxed);
+
+					while (begin < size)
+					{
+						end = std::min(size, begin + std::max(grain, (size - begin) / divisor));
+
+						if (next.compare_exchange_weak(begin, end, std::memory_order_relaxed))
+						{
+							return true;
+						}
+					}
+
+					return false;
+				}
+
+				void Run()
+				{
+					std::size_t begin = 0;
+					std::size_t end   = 0;
+
+					while (Claim(begin, end))
+					{
+						if (!isCancel.load(std::memory_order_relaxed))
+						{
+							try
+							{
+								func(begin, end);
+							}
+							catch (...)
+							{
+								std::lock_guard<std::mutex> lock(exceptionLock);
+
+								if (!exception)
+								{
+									exception = std::current_exception();
+								}
+
+								isCancel.store(true, std::memory_order_relaxed);
+							}
+						}
+
+						completed.fetch_add(end - begin, std::memory_order_release);
+					}
+				}
+
+				// 全部块都已领取, 等待其他线程完成手上的块
+				void Wait()
+				{
+					for (std::size_t spin = 0; completed.load(std::memory_order_acquire) < size; ++spin)
+					{
+						if (spin < 64)
+						{
+						#if defined(__SSE2__)
+
+							_mm_pause();
+
+						#endif
+						}
+						else
+						{
+							std::this_thread::yield();
+						}
+					}
+				}
+
+				FuncT & func;
+
+				const std::size_t size;
+				const std::size_t grain;
+				const std::size_t divisor;
+
+				alignas(64) std::atomic<std::size_t> next{ 0 };
+				alignas(64) std::atomic<std::size_t> completed{ 0 };
+
+				std::atomic<bool> isCancel{ false };
+
+				std::mutex exceptionLock{ };
+
+				std::exception_ptr exception{ };
+			};
+
+		public:
+			// 对 [0, size) 分块并行执行 func(begin, end)
+			template <typename FuncT>
+			static void Chunk(ThreadPool & pool, const std::size_t size, std::size_t grain, FuncT && func)
+			{
+				if (size == 0)
+				{
+					return;
+				}
+
+				std::size_t workers = pool.ThreadCount() + 1;
+
+				if (grain == 0)
+				{
+					grain = std::max<std::size_t>(size / (workers * 64), 1);
+				}
+
+				std::size_t helpers = std::min(pool.ThreadCount(), (size + grain - 1) / grain - 1);
+
+				if (helpers == 0)
+				{
+					func(std::size_t(0), size);
+
+					return;
+				}
+
+				using JobType = Job<typename std::remove_reference<FuncT>::type>;
+
+				auto job = std::make_shared<JobType>(func, size, grain, helpers + 1);
+
+				// 晚到的协助任务只会发现区间已领取完, 不会再访问 func
+				for (std::size_t i = 0; i < helpers; ++i)
+				{
+					pool.Post
+					(
+						[job]()
+						{
+							job->Run();
+						}
+					);
+				}
+
+				job->Run();
+				job->Wait();
+
+				if (job->exception)
+				{
+					std::rethrow_exception(job->exception);
+				}
+			}
+
+			// 对 [first, last) 中每个下标执行 func(i)
+			template <typename IndexT, typename FuncT>
+			static void For(ThreadPool & pool, const IndexT first, const IndexT last, const std::size_t grain, FuncT && func)
+			{
+				if (last <= first)
+				{
+					return;
+				}
+
+				Chunk
+				(
+					pool,
+
+					static_cast<std::size_t>(last - first),
+
+					grain,
+
+					[first, &func](const std::size_t begin, const std::size_t end)
+					{
+						for (std::size_t i = begin; i < end; ++i)
+						{
+							func(static_cast<IndexT>(first + i));
+						}
+					}
+				);
+			}
+
+			// 对 [first, last) 计算 reduce(..., map(i)), 各块先在本地归约, 再合并到结果
+			// 块的合并顺序不确定, reduce 需满足结合律与交换律, identity 为 reduce 的单位元
+			template <typename IndexT, typename ValueT, typename MapT, typename ReduceT>
+			static ValueT Reduce(ThreadPool & pool, const IndexT first, const IndexT last, const std::size_t grain, const ValueT & identity, MapT && map, ReduceT && reduce)
+			{
+				ValueT result = identity;
+
+				if (last <= first)
+				{
+					return result;
+				}
+
+				std::mutex lock;
+
+				Chunk
+				(
+					pool,
+
+					static_cast<std::size_t>(last - first),
+
+					grain,
+
+					[&](const std::size_t begin, const std::size_t end)
+					{
+						ValueT local = identity;
+
+						for (std::size_t i = begin; i < end; ++i)
+						{
+							local = reduce(std::move(local), map(static_cast<IndexT>(first + i)));
+						}
+
+						std::lock_guard<std::mutex> guard(lock);
+
+						result = reduce(std::move(result), std::move(local));
+					}
+				);
+
+				return result;
+			}
+
+			// out[i] = func(first[i]), 返回输出区间的末尾, 输入与输出都按下标分块, 需为随机访问迭代器
+			template <typename RandomIt, typename OutRandomIt, typename FuncT>
+			static OutRandomIt Transform(ThreadPool & pool, RandomIt first, RandomIt last, OutRandomIt out, FuncT && func, const std::size_t grain = 0)
+			{
+				static_assert(std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<RandomIt>::iterator_category>::value,
+							  "input must be a random access iterator");
+				static_assert(std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<OutRandomIt>::iterator_category>::value,
+							  "output must be a random access iterator");
+
+				auto size = static_cast<std::size_t>(std::distance(first, last));
+
+				Chunk
+				(
+					pool,
+
+					size,
+
+					grain,
+
+					[&](const std::size_t begin, const std::size_t end)
+					{
+						std::transform(first + begin, first + end, out + begin, func);
+					}
+				);
+
+				return out + size;
+			}
+
+			// 并行归并排序 (不稳定): 各段用 std::sort 排序, 再逐轮两两归并,
+			// 段数较少时每对归并按输出位置切分给多个线程, 元素需可默认构造与移动
+			template <typename RandomIt, typename CompareT = std::less<>>
+			static void Sort(ThreadPool & pool, RandomIt first, RandomIt last, CompareT compare = CompareT(), std::size_t grain = 0)
+			{
+				using ValueT = typename std::iterator_traits<RandomIt>::value_type;
+
+				auto size = static_cast<std::size_t>(last - first);
+
+				std::size_t workers = pool.ThreadCount() + 1;
+
+				if (grain == 0)
+				{
+					grain = std::max<std::size_t>(size / (workers * 4), 2048);
+				}
+
+				if (size <= grain || workers == 1)
+				{
+					std::sort(first, last, compare);
+
+					return;
+				}
+
+				std::size_t runs = (size + grain - 1) / grain;
+
+				Chunk
+				(
+					pool,
+
+					runs,
+
+					1,
+
+					[&](const std::size_t begin, const std::size_t end)
+					{
+						for (std::size_t i = begin; i < end; ++i)
+						{
+							std::sort(first + i * grain, first + std::min(size, (i + 1) * grain), compare);
+						}
+					}
+				);
+
+				std::vector<ValueT> buffer(size);
+
+				bool isInBuffer = false;
+
+				for (std::size_t width = grain; width < size; width *= 2)
+				{
+					if (isInBuffer)
+					{
+						MergeRound(pool, buffer.begin(), first, size, width, compare);
+					}
+					else
+					{
+						MergeRound(pool, first, buffer.begin(), size, width, compare);
+					}
+
+					isInBuffer = !isInBuffer;
+				}
+
+				if (isInBuffer)
+				{
+					Chunk
+					(
+						pool,
+
+						size,
+
+						0,
+
+						[&](const std::size_t begin, const std::size_t end)
+						{
+							std::move(buffer.begin() + begin, buffer.begin() + end, first + begin);
+						}
+					);
+				}
+			}
+
+		protected:
+			// 归并结果中前 k 个元素里来自 a 的个数, 相等时 a 在前
+			template <typename IteratorT, typename CompareT>
+			static std::size_t CoRank(IteratorT a, const std::size_t sizeA, IteratorT b, const std::size_t sizeB, const std::size_t k, CompareT & compare)
+			{
+				std::size_t low  = k > sizeB ? k - sizeB : 0;
+				std::size_t high = std::min(k, sizeA);
+
+				while (low < high)
+				{
+					std::size_t i = low + (high - low) / 2;
+					std::size_t j = k - i;
+
+					if (j > 0 && !compare(b[j - 1], a[i]))
+					{
+						low = i + 1;
+					}
+					else
+					{
+						high = i;
+					}
+				}
+
+				return low;
+			}
+
+			// 把 src 中长度为 width 的有序段两两归并到 dst
+			// 切分点在移动任何元素之前全部算好, 避免读到已被其他块移走的元素
+			template <typename SourceIt, typename TargetIt, typename CompareT>
+			static void MergeRound(ThreadPool & pool, SourceIt src, TargetIt dst, const std::size_t size, const std::size_t width, CompareT & compare)
+			{
+				std::size_t pairs  = (size + width * 2 - 1) / (width * 2);
+				std::size_t pieces = std::max<std::size_t>((pool.ThreadCount() + 1) * 2 / pairs, 1);
+
+				std::vector<std::size_t> splits(pairs * (pieces + 1));
+
+				for (std::size_t pair = 0; pair < pairs; ++pair)
+				{
+					std::size_t low    = pair * width * 2;
+					std::size_t middle = std::min(low + width, size);
+					std::size_t high   = std::min(low + width * 2, size);
+
+					for (std::size_t piece = 0; piece <= pieces; ++piece)
+					{
+						std::size_t k = (high - low) * piece / pieces;
+
+						splits[pair * (pieces + 1) + piece] = CoRank(src + low, middle - low, src + middle, high - middle, k, compare);
+					}
+				}
+
+				Chunk
+				(
+					pool,
+
+					pairs * pieces,
+
+					1,
+
+					[&](const std::size_t begin, const std::size_t end)
+					{
+						for (std::size_t task = begin; task < end; ++task)
+						{
+							std::size_t pair  = task / pieces;
+							std::size_t piece = task % pieces;
+
+							std::size_t low    = pair * width * 2;
+							std::size_t middle = std::min(low + width, size);
+							std::size_t high   = std::min(low + width * 2, size);
+
+							std::size_t k0 = (high - low) * piece / pieces;
+							std::size_t k1 = (high - low) * (piece + 1) / pieces;
+
+							std::size_t i0 = splits[pair * (pieces + 1) + piece];
+							std::size_t i1 = splits[pair * (pieces + 1) + piece + 1];
+
+							std::merge
+							(
+								std::make_move_iterator(src + low + i0),
+								std::make_move_iterator(src + low + i1),
+								std::make_move_iterator(src + middle + (k0 - i0)),
+								std::make_move_iterator(src + middle + (k1 - i1)),
+								dst + low + k0,
+								compare
+							);
+						}
+					}
+				);
+			}
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__POOL__PARALLEL__H__
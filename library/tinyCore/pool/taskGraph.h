@@ -0,0 +1,264 @@
+#ifndef __TINY_CORE__POOL__TASK_GRAPH__H__
+#define __TINY_CORE__POOL__TASK_GRAPH__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 有依赖关系的任务图
+ *
+ *  任务添加时声明前驱 (只能是已添加的任务, 因此图天然无环), 执行时每个任务的计数器初始化为前驱个数,
+ *  任务完成后递减后继的计数器, 减到0的后继中第一个在当前线程继续执行, 其余投递到线程池,
+ *  任何线程都不会阻塞等待依赖
+ *
+ *  任一任务抛出异常后尚未开始的任务不再执行, Run 返回的 Future 收到第一个异常
+ *
+ *  执行期间不能修改或析构任务图, Future 就绪后可以再次 Run
+ *
+ */
+
+
+#include <tinyCore/pool/threadPool.h>
+
+
+namespace tinyCore
+{
+	namespace pool
+	{
+		class TaskGraph
+		{
+			struct Node
+			{
+				template <typename FuncT>
+				explicit Node(FuncT && func) : task(std::forward<FuncT>(func))
+				{
+
+				}
+
+				InlineTask task;
+
+				std::vector<std::size_t> successors{ };
+
+				std::size_t predecessorCount{ 0 };
+
+				std::atomic<std::size_t> pending{ 0 };
+			};
+
+		public:
+			TaskGraph() = default;
+
+			TaskGraph(const TaskGraph &) = delete;
+			TaskGraph & operator=(const TaskGraph &) = delete;
+
+			// 添加任务, 返回任务编号
+			template <typename FuncT>
+			std::size_t Add(FuncT && func, std::initializer_list<std::size_t> predecessors = { })
+			{
+				return Add(std::forward<FuncT>(func), predecessors.begin(), predecessors.end());
+			}
+
+			template <typename FuncT>
+			std::size_t Add(FuncT && func, const std::vector<std::size_t> & predecessors)
+			{
+				return Add(std::forward<FuncT>(func), predecessors.begin(), predecessors.end());
+			}
+
+			// 开始执行, 所有任务完成后 Future 就绪
+			Future<void> Run(ThreadPool & pool)
+			{
+				TINY_THROW_EXCEPTION_IF(_isRunning.exchange(true), debug::ThreadError, "TaskGraph is running")
+
+				_promise = Promise<void>();
+
+				Future<void> future = _promise.GetFuture();
+
+				_exception = nullptr;
+
+				_isCancel.store(false, std::memory_order_relaxed);
+
+				_remaining.store(_nodes.size(), std::memory_order_relaxed);
+
+				if (_nodes.empty())
+				{
+					Complete();
+
+					return future;
+				}
+
+				std::vector<std::size_t> roots;
+
+				for (std::size_t i = 0; i < _nodes.size(); ++i)
+				{
+					_nodes[i]->pending.store(_nodes[i]->predecessorCount, std::memory_order_relaxed);
+
+					if (_nodes[i]->predecessorCount == 0)
+					{
+						roots.push_back(i);
+					}
+				}
+
+				for (auto index : roots)
+				{
+					Dispatch(pool, index);
+				}
+
+				return future;
+			}
+
+			void Clear()
+			{
+				TINY_THROW_EXCEPTION_IF(_isRunning.load(), debug::ThreadError, "clear on TaskGraph is running")
+
+				_nodes.clear();
+			}
+
+			std::size_t Size() const
+			{
+				return _nodes.size();
+			}
+
+		protected:
+			template <typename FuncT, typename IteratorT>
+			std::size_t Add(FuncT && func, IteratorT first, IteratorT last)
+			{
+				TINY_THROW_EXCEPTION_IF(_isRunning.load(), debug::ThreadError, "add on TaskGraph is running")
+
+				std::size_t index = _nodes.size();
+
+				for (auto iter = first; iter != last; ++iter)
+				{
+					TINY_THROW_EXCEPTION_IF(*iter >= index, debug::IndexError, TINY_STR_FORMAT("predecessor {} does not exist", *iter))
+				}
+
+				_nodes.push_back(std::make_unique<Node>(std::forward<FuncT>(func)));
+
+				for (auto iter = first; iter != last; ++iter)
+				{
+					_nodes[*iter]->successors.push_back(index);
+
+					++_nodes.back()->predecessorCount;
+				}
+
+				return index;
+			}
+
+			// 线程池已停止时在当前线程执行, 保证计数最终归零
+			void Dispatch(ThreadPool & pool, const std::size_t index)
+			{
+				try
+				{
+					pool.Post
+					(
+						[this, &pool, index]()
+						{
+							Execute(pool, index);
+						}
+					);
+				}
+				catch (...)
+				{
+					Execute(pool, index);
+				}
+			}
+
+			void Execute(ThreadPool & pool, std::size_t index)
+			{
+				while (true)
+				{
+					Node & node = *_nodes[index];
+
+					if (!_isCancel.load(std::memory_order_relaxed))
+					{
+						try
+						{
+							node.task();
+						}
+						catch (...)
+						{
+							std::lock_guard<std::mutex> lock(_lock);
+
+							if (!_exception)
+							{
+								_exception = std::current_exception();
+							}
+
+							_isCancel.store(true, std::memory_order_relaxed);
+						}
+					}
+
+					bool hasNext = false;
+
+					std::size_t next = 0;
+
+					for (auto successor : node.successors)
+					{
+						if (_nodes[successor]->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+						{
+							if (!hasNext)
+							{
+								hasNext = true;
+
+								next = successor;
+							}
+							else
+							{
+								Dispatch(pool, successor);
+							}
+						}
+					}
+
+					// 递减之后只有持有就绪后继的线程才能继续访问 this
+					if (_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+					{
+						Complete();
+
+						return;
+					}
+
+					if (!hasNext)
+					{
+						return;
+					}
+
+					index = next;
+				}
+			}
+
+			void Complete()
+			{
+				auto promise = std::move(_promise);
+
+				auto exception = std::move(_exception);
+
+				_isRunning.store(false);
+
+				if (exception)
+				{
+					promise.SetException(exception);
+				}
+				else
+				{
+					promise.SetValue();
+				}
+			}
+
+		protected:
+			std::vector<std::unique_ptr<Node>> _nodes{ };
+
+			std::atomic<bool> _isRunning{ false };
+			std::atomic<bool> _isCancel{ false };
+
+			std::atomic<std::size_t> _remaining{ 0 };
+
+			std::mutex _lock{ };
+
+			std::exception_ptr _exception{ };
+
+			Promise<void> _promise{ };
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__POOL__TASK_GRAPH__H__
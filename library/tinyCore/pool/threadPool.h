@@ -8,10 +8,57 @@
  *
  *  说明: 线程池
  *
+ *  SHARED_QUEUE 模式下所有任务进入同一个队列, 由一把锁和一个条件变量保护
+ *
+ *  WORK_STEALING 模式下每个工作线程拥有一个本地双端队列, 工作线程内提交的任务进入本地队列 (后进先出, 缓存友好),
+ *  外部线程提交的任务进入全局注入队列, 本地队列为空时先从注入队列批量获取, 再随机选择其他线程窃取,
+ *  仍然没有任务时先自旋, 再让出, 最后休眠, 提交方只在有线程休眠时才加锁唤醒
+ *
+ *  任务节点与 Commit 的 future 共享状态都从 BlockPool 分配, 任务本身内联存放在节点中,
+ *  Post 与 Commit (可调用对象与参数不超过内联大小时) 稳定运行后不申请内存
+ *
+ *  共享队列 (窃取模式下为注入队列) 可以划分为多个通道, 通道之间按权重做平滑加权轮询,
+ *  积压的后台任务不会让高权重通道的任务排在整个积压之后, 通道内部为先进先出或按截止时间最早优先 (EDF),
+ *  默认只有0号通道, 行为与单一队列相同; 通道记录队列深度与排队等待时间
+ *
+ *  LaunchOption 为每个工作线程指定名字, CPU 亲和, NUMA 节点, 栈大小与调度策略,
+ *  窃取模式下每个工作线程在设置好亲和与内存策略后自行创建本地队列, 使其内存落在所在节点
+ *
+ *  LaunchElastic 启动弹性线程池 (仅共享队列模式): 线程数在 [minSize, maxSize] 之间变化,
+ *  监控线程发现所有线程都在忙且最早的任务等待超过阈值或队列深度超过阈值时增加一个线程,
+ *  线程空闲超过 keepAlive 时退出, 相邻两次增减至少间隔 cooldown, 避免来回抖动
+ *
+ *  EnableMetrics 之后提交的任务按标签计数, 并抽样记录排队等待与执行时间 (直方图), 读取时合并各线程的记录,
+ *  未启用时每个任务只多一次判断
+ *
+ *  ScheduleAfter / ScheduleAt / ScheduleEvery 由一个定时线程 (首次调用时创建) 到期后投递到线程池执行,
+ *  周期任务没有累积漂移, 返回的 TimerHandle 可以取消
+ *
  */
 
 
-#include <tinyCore/debug/trace.h>
+#if defined(__SSE2__)
+#
+#  include <emmintrin.h>
+#
+#endif
+
+#if defined(TINY_CORE_COROUTINE)
+#
+#  include <coroutine>
+#
+#endif
+
+#include <random>
+
+#include <tinyCore/pool/future.h>
+#include <tinyCore/pool/metrics.h>
+#include <tinyCore/pool/blockPool.h>
+#include <tinyCore/pool/inlineTask.h>
+#include <tinyCore/pool/timerQueue.h>
+#include <tinyCore/utilities/time.h>
+#include <tinyCore/thread/threadAttribute.h>
+#include <tinyCore/container/workStealingDeque.h>
 
 
 namespace tinyCore
@@ -20,37 +67,302 @@ namespace tinyCore
 	{
 		class ThreadPool
 		{
-			using Task = std::function<void()>;
+			static const std::size_t SPIN_COUNT  = 64;
+			static const std::size_t YIELD_COUNT = 16;
+			static const std::size_t BATCH_COUNT = 32;
+
+			// 队列中的任务节点, 共享队列与注入队列通过next串成链表
+			struct Node
+			{
+				template <typename FuncT>
+				explicit Node(FuncT && func) : task(std::forward<FuncT>(func))
+				{
+
+				}
+
+				InlineTask task;
+
+				Node * next{ nullptr };
+
+				std::size_t lane{ 0 };
+				std::size_t tag{ 0 };
+
+				// 见 TaskMetrics::Stamp
+				uint64_t stamp{ 0 };
+
+				SteadyClockTimesPoint deadline{ SteadyClockTimesPoint::max() };
+				SteadyClockTimesPoint enqueue{ };
+			};
+
+			// 截止时间早的在堆顶
+			struct Later
+			{
+				bool operator()(const Node * lhs, const Node * rhs) const
+				{
+					return lhs->deadline > rhs->deadline;
+				}
+			};
+
+			struct alignas(64) Worker
+			{
+				explicit Worker(const std::size_t seed) : random(static_cast<uint32_t>(seed + 1))
+				{
+
+				}
+
+				~Worker()
+				{
+					Node * node = nullptr;
+
+					while (deque.Pop(node))
+					{
+						DeleteNode(node);
+					}
+				}
+
+				std::minstd_rand random;
+
+				container::WorkStealingDeque<Node *> deque{ };
+			};
+
+			// 当前线程所属的线程池与工作线程序号
+			struct Context
+			{
+				ThreadPool * pool{ nullptr };
+
+				std::size_t index{ 0 };
+
+				MetricsRecorder * recorder{ nullptr };
+			};
+
+		public:
+			enum class MODE : uint8_t
+			{
+				SHARED_QUEUE,
+				WORK_STEALING,
+			};
+
+			enum class ORDER : uint8_t
+			{
+				FIFO,
+				DEADLINE,
+			};
+
+			// 提交选项, 截止时间只在 DEADLINE 通道中生效, 没有截止时间的任务排在最后
+			struct TaskOption
+			{
+				std::size_t lane{ 0 };
+
+				SteadyClockTimesPoint deadline{ SteadyClockTimesPoint::max() };
+
+				// AddTag 返回的标签号, 0表示不带标签
+				std::size_t tag{ 0 };
+			};
+
+			// 列表按工作线程序号循环使用, 为空表示不设置
+			struct LaunchOption
+			{
+				MODE mode{ MODE::SHARED_QUEUE };
+
+				// 线程名为 name + 序号
+				std::string name{ };
+
+				std::vector<std::vector<std::size_t>> cpus{ };
+
+				std::vector<int> nodes{ };
+
+				std::size_t stackSize{ 0 };
+
+				int policy{ thread::ThreadAttribute::INHERIT };
+				int priority{ 0 };
+			};
+
+			struct ElasticOption
+			{
+				std::size_t minSize{ 1 };
+				std::size_t maxSize{ std::max<std::size_t>(std::thread::hardware_concurrency(), 1) * 4 };
+
+				// 队列深度超过该值时扩容
+				std::size_t depthThreshold{ 64 };
+
+				// 最早的任务等待超过该值时扩容
+				SteadyClockDuration waitThreshold{ std::chrono::milliseconds(10) };
+
+				// 空闲超过该值的线程退出
+				SteadyClockDuration keepAlive{ std::chrono::seconds(60) };
+
+				// 相邻两次增减的最小间隔
+				SteadyClockDuration cooldown{ std::chrono::milliseconds(20) };
+
+				// 监控线程的检查周期
+				SteadyClockDuration interval{ std::chrono::milliseconds(2) };
+			};
+
+			struct LaneStats
+			{
+				std::size_t depth{ 0 };
+				std::size_t weight{ 0 };
+
+				uint64_t enqueued{ 0 };
+				uint64_t dequeued{ 0 };
+
+				SteadyClockDuration totalWait{ 0 };
+				SteadyClockDuration maxWait{ 0 };
+
+				ORDER order{ ORDER::FIFO };
+			};
+
+		protected:
+			struct Lane
+			{
+				Lane(const std::size_t w, const ORDER o) : weight(w), order(o)
+				{
+
+				}
+
+				std::size_t weight;
+
+				ORDER order;
+
+				// 平滑加权轮询的当前值
+				int64_t current{ 0 };
+
+				std::size_t size{ 0 };
+
+				Node * head{ nullptr };
+				Node * tail{ nullptr };
+
+				std::vector<Node *> heap{ };
+
+				uint64_t enqueued{ 0 };
+				uint64_t dequeued{ 0 };
+
+				SteadyClockDuration totalWait{ 0 };
+				SteadyClockDuration maxWait{ 0 };
+			};
 
 		public:
 			ThreadPool()
 			{
 				_isStop.store(false);
+
+				_lanes.emplace_back(1, ORDER::FIFO);
 			}
 
 			~ThreadPool()
 			{
-				_isStop.store(true);
+				// 先停止定时线程, 之后不会再有投递
+				if (_timer)
+				{
+					_timer->Stop();
+				}
+
+				{
+					std::unique_lock<std::mutex> lock(_lock);
+
+					_isStop.store(true);
+				}
 
 				_condition.notify_all();
 
-				for (std::thread &thread : _pool)
+				_superviseCondition.notify_all();
+
+				for (auto &thread : _pool)
 				{
-					if (thread.joinable())
-					{
-						thread.join();
-					}
+					thread.Join();
+				}
+
+				if (_supervisor)
+				{
+					_supervisor->Join();
+				}
+
+				// 弹性线程已分离, 等待全部退出
+				{
+					std::unique_lock<std::mutex> lock(_lock);
+
+					_exitCondition.wait(lock, [this]() { return _elasticSize == 0; });
+				}
+
+				while (_queueSize.load() > 0)
+				{
+					DeleteNode(PopNode());
+				}
+			}
+
+			// 增加一个通道, 返回通道号, 0号通道的权重为1, 只能在 Launch 之前调用
+			std::size_t AddLane(const std::size_t weight, const ORDER order = ORDER::FIFO)
+			{
+				TINY_THROW_EXCEPTION_IF(weight == 0, debug::ValueError, "lane weight must be greater than zero")
+
+				std::unique_lock<std::mutex> lock(_lock);
+
+				TINY_THROW_EXCEPTION_IF(IsLaunched(), debug::ThreadError, "add lane on ThreadPool is launched")
+
+				_lanes.emplace_back(weight, order);
+
+				return _lanes.size() - 1;
+			}
+
+			std::size_t LaneCount() const
+			{
+				return _lanes.size();
+			}
+
+			std::vector<LaneStats> LaneStatistics() const
+			{
+				std::vector<LaneStats> stats;
+
+				std::unique_lock<std::mutex> lock(_lock);
+
+				for (auto &iter : _lanes)
+				{
+					LaneStats lane;
+
+					lane.depth     = iter.size;
+					lane.weight    = iter.weight;
+					lane.order     = iter.order;
+					lane.enqueued  = iter.enqueued;
+					lane.dequeued  = iter.dequeued;
+					lane.totalWait = iter.totalWait;
+					lane.maxWait   = iter.maxWait;
+
+					stats.push_back(lane);
 				}
+
+				return stats;
 			}
 
 			std::size_t TaskCount() const
 			{
-				return _tasks.size();
+				std::size_t count = _queueSize.load(std::memory_order_relaxed);
+
+				for (auto &iter : _workers)
+				{
+					count += iter->deque.Size();
+				}
+
+				return count;
 			}
 
 			std::size_t ThreadCount() const
 			{
-				return _pool.size();
+				return _isElastic ? _elasticSize.load() : _pool.size();
+			}
+
+			// 弹性模式下累计增加与退出的线程数
+			std::size_t SpawnCount() const
+			{
+				std::unique_lock<std::mutex> lock(_lock);
+
+				return _spawnSize;
+			}
+
+			std::size_t RetireCount() const
+			{
+				std::unique_lock<std::mutex> lock(_lock);
+
+				return _retireSize;
 			}
 
 			std::size_t FreeCount() const
@@ -58,25 +370,129 @@ namespace tinyCore
 				return _freeSize;
 			}
 
+			MODE Mode() const
+			{
+				return _mode;
+			}
+
+			// 每个提交线程每 sampleRate 个任务计时一个, 1为全部计时
+			void EnableMetrics(const std::size_t sampleRate = 16)
+			{
+				TINY_THROW_EXCEPTION_IF(sampleRate == 0, debug::ValueError, "sample rate must be greater than zero")
+
+				_metrics.Enable(sampleRate);
+			}
+
+			void DisableMetrics()
+			{
+				_metrics.Enable(0);
+			}
+
+			bool IsMetrics() const
+			{
+				return _metrics.IsEnable();
+			}
+
+			std::size_t AddTag(const std::string & name)
+			{
+				return _metrics.AddTag(name);
+			}
+
+			// 吞吐量按距上一次调用的间隔计算
+			MetricsSnapshot Metrics()
+			{
+				MetricsSnapshot snapshot = _metrics.Snapshot();
+
+				snapshot.threads = ThreadCount();
+				snapshot.free    = FreeCount();
+				snapshot.queued  = TaskCount();
+
+				return snapshot;
+			}
+
+			void ResetMetrics()
+			{
+				_metrics.Reset();
+			}
+
+			void DumpMetrics(log::ILogger * logger)
+			{
+				Metrics().Dump(logger);
+			}
+
 			bool IsWork()
 			{
-				return !_tasks.empty() || (_pool.size() != _freeSize);
+				return TaskCount() > 0 || (ThreadCount() != _freeSize);
 			}
 
-			void Launch(const std::size_t size)
+			void Launch(const std::size_t size, const MODE mode = MODE::SHARED_QUEUE)
 			{
-				_freeSize.store(size);
+				LaunchOption option;
+
+				option.mode = mode;
+
+				Launch(size, option);
+			}
+
+			void Launch(const std::size_t size, const LaunchOption & option)
+			{
+				// 窃取模式的本地队列在启动时确定, 不支持追加线程
+				TINY_THROW_EXCEPTION_IF(!_pool.empty() && (_mode == MODE::WORK_STEALING || option.mode == MODE::WORK_STEALING),
+										debug::ThreadError, "work stealing ThreadPool can only be launched once")
+
+				TINY_THROW_EXCEPTION_IF(_isElastic, debug::ThreadError, "elastic ThreadPool can only be launched once")
+
+				_mode = option.mode;
+
+				_freeSize.fetch_add(size);
+
+				if (_mode == MODE::WORK_STEALING)
+				{
+					_workers.resize(size);
+
+					try
+					{
+						for (std::size_t i = 0; i < size; ++i)
+						{
+							_pool.emplace_back(Attribute(option, i), [this, i]() { StealingLoop(i); });
+						}
+					}
+					catch (...)
+					{
+						// 已启动的线程还在等待其他线程就绪, 停止后退出
+						_isStop.store(true);
+
+						_pool.clear();
+						_workers.clear();
+
+						throw;
+					}
+
+					// 所有本地队列创建完成后才能窃取与统计任务数
+					while (_readySize.load(std::memory_order_acquire) < size)
+					{
+						std::this_thread::yield();
+					}
+
+					return;
+				}
+
+				std::size_t base = _pool.size();
 
 				for (std::size_t i = 0; i < size; ++i)
 				{
 					_pool.emplace_back
 					(
+						Attribute(option, base + i),
+
 						[this]
 						{
+							TaskMetrics::Scope scope(this->_metrics, Local().recorder);
+
 							// 工作线程函数
 							while (!this->_isStop)
 							{
-								std::function<void()> task;
+								Node * node = nullptr;
 
 								// 获取一个待执行的 task
 								{
@@ -90,25 +506,19 @@ namespace tinyCore
 
 										[this]
 										{
-											return this->_isStop.load() || !this->_tasks.empty();
+											return this->_isStop.load() || this->_queueSize.load() > 0;
 										}
 									);
 
-									if (this->_isStop && this->_tasks.empty())
+									if (this->_isStop && this->_queueSize.load() == 0)
 									{
 										return false;
 									}
 
-									task = std::move(this->_tasks.front()); // 取一个 task
-
-									this->_tasks.pop();
+									node = this->PopNode(); // 取一个 task
 								}
 
-								--_freeSize;
-
-								task();
-
-								++_freeSize;
+								Run(node);
 							}
 
 							return true;
@@ -117,6 +527,73 @@ namespace tinyCore
 				}
 			}
 
+			void LaunchElastic(const ElasticOption & elastic)
+			{
+				LaunchElastic(elastic, LaunchOption());
+			}
+
+			void LaunchElastic(const ElasticOption & elastic, const LaunchOption & option)
+			{
+				TINY_THROW_EXCEPTION_IF(option.mode != MODE::SHARED_QUEUE, debug::ModeError, "elastic ThreadPool only supports shared queue")
+
+				TINY_THROW_EXCEPTION_IF(elastic.maxSize == 0 || elastic.minSize > elastic.maxSize, debug::SizeError, "elastic size range is invalid")
+
+				TINY_THROW_EXCEPTION_IF(IsLaunched(), debug::ThreadError, "elastic ThreadPool can only be launched once")
+
+				_isElastic = true;
+
+				_elastic = elastic;
+
+				_launchOption = option;
+
+				_lastResize = TINY_TIME_STEADY_POINT();
+
+				for (std::size_t i = 0; i < _elastic.minSize; ++i)
+				{
+					std::unique_lock<std::mutex> lock(_lock);
+
+					TINY_THROW_EXCEPTION_IF(!Spawn(lock), debug::ThreadError, "create elastic worker failed")
+				}
+
+				thread::ThreadAttribute attribute;
+
+				if (!option.name.empty())
+				{
+					attribute.name = option.name + "-monitor";
+				}
+
+				_supervisor.reset(new thread::NativeThread(attribute, [this]() { Supervise(); }));
+			}
+
+			// 提交一个无返回值的任务, 不创建 future
+			// 可调用对象只需可移动, 不超过 InlineTask::INLINE_SIZE 时不申请内存, 任务不应抛出异常
+			template <typename FuncT>
+			void Post(FuncT && func)
+			{
+				TINY_THROW_EXCEPTION_IF(_isStop.load(), debug::ThreadError, "post on ThreadPool is stopped")
+
+				Push(NewNode(std::forward<FuncT>(func)));
+			}
+
+			// 提交到指定通道, 非0号通道的任务在窃取模式下也进入注入队列, 保证按权重调度
+			template <typename FuncT>
+			void PostTo(const TaskOption & option, FuncT && func)
+			{
+				TINY_THROW_EXCEPTION_IF(_isStop.load(), debug::ThreadError, "post on ThreadPool is stopped")
+
+				TINY_THROW_EXCEPTION_IF(option.lane >= _lanes.size(), debug::IndexError, "lane does not exist")
+
+				TINY_THROW_EXCEPTION_IF(option.tag >= MetricsRecorder::MAX_TAG_COUNT, debug::IndexError, "tag does not exist")
+
+				Node * node = NewNode(std::forward<FuncT>(func));
+
+				node->lane     = option.lane;
+				node->tag      = option.tag;
+				node->deadline = option.deadline;
+
+				Push(node);
+			}
+
 			// 提交一个任务
 			// 调用.get()获取返回值会等待任务执行完,获取返回值
 			// 有两种方法可以实现调用类成员
@@ -124,42 +601,809 @@ namespace tinyCore
 			// 一种是使用 mem_fn： .commit(std::mem_fn(&Dog::sayHello), &dog)
 			template<class Func, class... Args>
 			auto Commit(Func && func, Args &&... args) ->std::future<decltype(func(args...))>
+			{
+				return CommitTo(TaskOption(), std::forward<Func>(func), std::forward<Args>(args)...);
+			};
+
+			// 提交到指定通道
+			template<class Func, class... Args>
+			auto CommitTo(const TaskOption & option, Func && func, Args &&... args) ->std::future<decltype(func(args...))>
 			{
 				TINY_THROW_EXCEPTION_IF(_isStop.load(), debug::ThreadError, "commit on ThreadPool is stopped")
 
+				TINY_THROW_EXCEPTION_IF(option.lane >= _lanes.size(), debug::IndexError, "lane does not exist")
+
+				TINY_THROW_EXCEPTION_IF(option.tag >= MetricsRecorder::MAX_TAG_COUNT, debug::IndexError, "tag does not exist")
+
 				using RetType = decltype(func(args...));
 
-				auto task = std::make_shared<std::packaged_task<RetType()>>(std::bind(std::forward<Func>(func),
-																					  std::forward<Args>(args)...));
+				// 共享状态从内存池分配
+				std::promise<RetType> promise(std::allocator_arg, BlockAllocator<char>());
 
-				std::future<RetType> res = task->get_future();
+				std::future<RetType> res = promise.get_future();
 
-				{
-					std::unique_lock<std::mutex> lock(_lock);
+				Node * node = NewNode
+				(
+					[promise = std::move(promise), function = std::bind(std::forward<Func>(func), std::forward<Args>(args)...)]() mutable
+					{
+						Fulfill(promise, function);
+					}
+				);
 
-					_tasks.emplace
-					(
-						[task]()
-						{
-							(*task)();
-						}
-					);
-				}
+				node->lane     = option.lane;
+				node->tag      = option.tag;
+				node->deadline = option.deadline;
 
-				_condition.notify_one();  // 唤醒一个线程执行
+				Push(node);
 
 				return res;
 			};
 
+			// 提交一个任务, 返回支持 Then 的 pool::Future
+			template<class Func, class... Args>
+			auto Async(Func && func, Args &&... args) -> Future<decltype(func(args...))>
+			{
+				TINY_THROW_EXCEPTION_IF(_isStop.load(), debug::ThreadError, "async on ThreadPool is stopped")
+
+				using RetType = decltype(func(args...));
+
+				Promise<RetType> promise;
+
+				Future<RetType> res = promise.GetFuture();
+
+				Push
+				(
+					NewNode
+					(
+						[promise = std::move(promise), function = std::bind(std::forward<Func>(func), std::forward<Args>(args)...)]() mutable
+						{
+							promise.Run(function);
+						}
+					)
+				);
+
+				return res;
+			}
+
+			// delay 之后投递到线程池执行
+			template <typename FuncT>
+			TimerHandle ScheduleAfter(const SteadyClockDuration & delay, FuncT && func)
+			{
+				return ScheduleAt(TINY_TIME_STEADY_POINT() + delay, std::forward<FuncT>(func));
+			}
+
+			template <typename FuncT>
+			TimerHandle ScheduleAt(const SteadyClockTimesPoint & when, FuncT && func)
+			{
+				TINY_THROW_EXCEPTION_IF(_isStop.load(), debug::ThreadError, "schedule on ThreadPool is stopped")
+
+				return Timer().Add(when, SteadyClockDuration::zero(), std::function<void()>(std::forward<FuncT>(func)));
+			}
+
+			// 第一次在 period 之后执行, 此后按 period 的整数倍执行
+			template <typename FuncT>
+			TimerHandle ScheduleEvery(const SteadyClockDuration & period, FuncT && func)
+			{
+				TINY_THROW_EXCEPTION_IF(period <= SteadyClockDuration::zero(), debug::ValueError, "schedule period must be greater than zero")
+
+				TINY_THROW_EXCEPTION_IF(_isStop.load(), debug::ThreadError, "schedule on ThreadPool is stopped")
+
+				return Timer().Add(TINY_TIME_STEADY_POINT() + period, period, std::function<void()>(std::forward<FuncT>(func)));
+			}
+
+			// 尚未到期的定时任务数 (包括已取消的)
+			std::size_t TimerCount() const
+			{
+				std::lock_guard<std::mutex> lock(_timerLock);
+
+				return _timer ? _timer->Size() : 0;
+			}
+
+		#if defined(TINY_CORE_COROUTINE)
+
+			// co_await pool.Schedule() 把协程的剩余部分投递到线程池执行
+			auto Schedule()
+			{
+				struct Awaiter
+				{
+					bool await_ready() const noexcept
+					{
+						return false;
+					}
+
+					void await_suspend(std::coroutine_handle<> handle)
+					{
+						pool.Post([handle]() { handle.resume(); });
+					}
+
+					void await_resume() const noexcept
+					{
+
+					}
+
+					ThreadPool & pool;
+				};
+
+				return Awaiter{ *this };
+			}
+
+		#endif
+
 		protected:
-			std::mutex _lock{ };
+			bool IsLaunched() const
+			{
+				return !_pool.empty() || _isElastic;
+			}
+
+			TimerQueue & Timer()
+			{
+				std::lock_guard<std::mutex> lock(_timerLock);
+
+				if (!_timer)
+				{
+					thread::ThreadAttribute attribute;
+
+					attribute.name = "pool-timer";
+
+					_timer.reset(new TimerQueue([this](std::function<void()> task) { Post(std::move(task)); }, attribute));
+				}
+
+				return *_timer;
+			}
+
+			// 需持有 _lock, 创建线程期间释放锁; 返回是否创建成功
+			bool Spawn(std::unique_lock<std::mutex> & lock)
+			{
+				std::size_t index = _spawnSize++;
+
+				++_elasticSize;
+				++_freeSize;
+
+				lock.unlock();
+
+				bool isSuccess = true;
+
+				try
+				{
+					thread::NativeThread(Attribute(_launchOption, index), [this]() { ElasticLoop(); }).Detach();
+				}
+				catch (...)
+				{
+					isSuccess = false;
+				}
+
+				lock.lock();
+
+				if (!isSuccess)
+				{
+					--_spawnSize;
+					--_elasticSize;
+					--_freeSize;
+
+					_exitCondition.notify_all();
+				}
+
+				return isSuccess;
+			}
+
+			void ElasticLoop()
+			{
+				Local().recorder = _metrics.Register();
+
+				std::unique_lock<std::mutex> lock(_lock);
+
+				SteadyClockDuration timeout = _elastic.keepAlive;
+
+				while (true)
+				{
+					bool isReady = _condition.wait_for
+					(
+						lock,
+
+						timeout,
+
+						[this]
+						{
+							return _isStop.load() || _queueSize.load() > 0;
+						}
+					);
+
+					if (_isStop.load())
+					{
+						break;
+					}
+
+					if (!isReady)
+					{
+						auto now = TINY_TIME_STEADY_POINT();
+
+						// 空闲超时, 高于下限且距上次增减超过冷却时间才退出
+						if (_elasticSize > _elastic.minSize && now - _lastResize >= _elastic.cooldown)
+						{
+							_lastResize = now;
+
+							++_retireSize;
+
+							break;
+						}
+
+						// 仍可退出时冷却结束后再检查, 已到下限则按 keepAlive 等待
+						if (_elasticSize > _elastic.minSize)
+						{
+							timeout = std::max<SteadyClockDuration>(_elastic.cooldown - (now - _lastResize), std::chrono::milliseconds(1));
+						}
+						else
+						{
+							timeout = _elastic.keepAlive;
+						}
+
+						continue;
+					}
+
+					timeout = _elastic.keepAlive;
+
+					Node * node = PopNode();
+
+					lock.unlock();
+
+					Run(node);
+
+					lock.lock();
+				}
+
+				// 退出前注销, 之后不能再访问 _metrics
+				_metrics.Unregister(Local().recorder);
+
+				Local().recorder = nullptr;
+
+				--_elasticSize;
+				--_freeSize;
+
+				// 通知后不再访问 this, 析构函数在拿到锁之后才会继续
+				_exitCondition.notify_all();
+			}
+
+			// 监控线程: 所有线程都在忙且有积压时增加线程
+			void Supervise()
+			{
+				std::unique_lock<std::mutex> lock(_lock);
+
+				while (!_isStop.load())
+				{
+					_superviseCondition.wait_for(lock, _elastic.interval);
+
+					if (_isStop.load() || _queueSize.load() == 0 || _freeSize.load() > 0 || _elasticSize >= _elastic.maxSize)
+					{
+						continue;
+					}
+
+					auto now = TINY_TIME_STEADY_POINT();
+
+					if (now - _lastResize < _elastic.cooldown)
+					{
+						continue;
+					}
+
+					if (_queueSize.load() > _elastic.depthThreshold || now - OldestEnqueue() > _elastic.waitThreshold)
+					{
+						if (Spawn(lock))
+						{
+							_lastResize = TINY_TIME_STEADY_POINT();
+						}
+					}
+				}
+			}
+
+			// 需持有 _lock, 截止时间通道取堆顶, 近似值
+			SteadyClockTimesPoint OldestEnqueue() const
+			{
+				auto oldest = SteadyClockTimesPoint::max();
+
+				for (auto &iter : _lanes)
+				{
+					if (iter.order == ORDER::DEADLINE)
+					{
+						if (!iter.heap.empty())
+						{
+							oldest = std::min(oldest, iter.heap.front()->enqueue);
+						}
+					}
+					else if (iter.head)
+					{
+						oldest = std::min(oldest, iter.head->enqueue);
+					}
+				}
+
+				return oldest;
+			}
+
+			static thread::ThreadAttribute Attribute(const LaunchOption & option, const std::size_t index)
+			{
+				thread::ThreadAttribute attribute;
+
+				if (!option.name.empty())
+				{
+					attribute.name = option.name + std::to_string(index);
+				}
+
+				if (!option.cpus.empty())
+				{
+					attribute.cpus = option.cpus[index % option.cpus.size()];
+				}
+
+				if (!option.nodes.empty())
+				{
+					attribute.node = option.nodes[index % option.nodes.size()];
+				}
+
+				attribute.stackSize = option.stackSize;
+				attribute.policy    = option.policy;
+				attribute.priority  = option.priority;
+
+				return attribute;
+			}
+
+			static Context & Local()
+			{
+				static thread_local Context context{ };
+
+				return context;
+			}
+
+			template <typename FuncT>
+			static Node * NewNode(FuncT && func)
+			{
+				void * memory = BlockPool::Allocate(sizeof(Node));
+
+				try
+				{
+					return new(memory) Node(std::forward<FuncT>(func));
+				}
+				catch (...)
+				{
+					BlockPool::Free(memory, sizeof(Node));
+
+					throw;
+				}
+			}
+
+			static void DeleteNode(Node * node)
+			{
+				node->~Node();
+
+				BlockPool::Free(node, sizeof(Node));
+			}
+
+			template <typename RetT, typename FuncT>
+			static void Fulfill(std::promise<RetT> & promise, FuncT & func)
+			{
+				try
+				{
+					promise.set_value(func());
+				}
+				catch (...)
+				{
+					promise.set_exception(std::current_exception());
+				}
+			}
+
+			template <typename FuncT>
+			static void Fulfill(std::promise<void> & promise, FuncT & func)
+			{
+				try
+				{
+					func();
+
+					promise.set_value();
+				}
+				catch (...)
+				{
+					promise.set_exception(std::current_exception());
+				}
+			}
+
+			// 以下三个函数需持有 _lock
+			void PushNode(Node * node)
+			{
+				Lane & lane = _lanes[node->lane];
+
+				if (lane.order == ORDER::DEADLINE)
+				{
+					lane.heap.push_back(node);
+
+					std::push_heap(lane.heap.begin(), lane.heap.end(), Later());
+				}
+				else if (lane.tail)
+				{
+					lane.tail->next = node;
+					lane.tail       = node;
+				}
+				else
+				{
+					lane.head = node;
+					lane.tail = node;
+				}
 
-			std::queue<Task> _tasks{ };
+				++lane.size;
+				++lane.enqueued;
+
+				_queueSize.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			Node * PopNode()
+			{
+				Lane & lane = _lanes.size() == 1 ? _lanes.front() : SelectLane();
+
+				Node * node = nullptr;
+
+				if (lane.order == ORDER::DEADLINE)
+				{
+					std::pop_heap(lane.heap.begin(), lane.heap.end(), Later());
+
+					node = lane.heap.back();
+
+					lane.heap.pop_back();
+				}
+				else
+				{
+					node = lane.head;
+
+					lane.head = node->next;
+
+					if (lane.head == nullptr)
+					{
+						lane.tail = nullptr;
+					}
+
+					node->next = nullptr;
+				}
+
+				--lane.size;
+				++lane.dequeued;
+
+				auto wait = TINY_TIME_STEADY_POINT() - node->enqueue;
+
+				lane.totalWait += wait;
+				lane.maxWait    = std::max(lane.maxWait, wait);
+
+				_queueSize.fetch_sub(1, std::memory_order_relaxed);
+
+				return node;
+			}
+
+			// 平滑加权轮询: 非空通道的当前值加上权重, 取最大者, 再减去非空通道的权重之和
+			Lane & SelectLane()
+			{
+				Lane * select = nullptr;
+
+				int64_t total = 0;
+
+				for (auto &iter : _lanes)
+				{
+					if (iter.size == 0)
+					{
+						iter.current = 0;
+
+						continue;
+					}
+
+					iter.current += static_cast<int64_t>(iter.weight);
+
+					total += static_cast<int64_t>(iter.weight);
+
+					if (select == nullptr || iter.current > select->current)
+					{
+						select = &iter;
+					}
+				}
+
+				select->current -= total;
+
+				return *select;
+			}
+
+			void Push(Node * node)
+			{
+				node->stamp = _metrics.Stamp();
+
+				if (_mode == MODE::WORK_STEALING)
+				{
+					Context & local = Local();
+
+					// 工作线程内提交的0号通道任务直接进入本地队列, 无需加锁
+					if (local.pool == this && node->lane == 0)
+					{
+						_workers[local.index]->deque.Push(node);
+					}
+					else
+					{
+						node->enqueue = TINY_TIME_STEADY_POINT();
+
+						std::unique_lock<std::mutex> lock(_lock);
+
+						PushNode(node);
+					}
+
+					Notify();
+
+					return;
+				}
+
+				node->enqueue = TINY_TIME_STEADY_POINT();
+
+				{
+					std::unique_lock<std::mutex> lock(_lock);
+
+					PushNode(node);
+				}
+
+				_condition.notify_one();  // 唤醒一个线程执行
+			}
+
+			void Run(Node * node)
+			{
+				--_freeSize;
+
+				MetricsRecorder * recorder = Local().recorder;
+
+				if (node->stamp == TaskMetrics::UNSAMPLED && recorder)
+				{
+					recorder->Count(node->tag);
+
+					node->task();
+				}
+				else if (node->stamp && recorder)
+				{
+					uint64_t start = Cycle::Now();
+
+					node->task();
+
+					// 不同核心的 TSC 可能有微小偏差
+					recorder->Record(node->tag, start > node->stamp ? start - node->stamp : 0, Cycle::Now() - start);
+				}
+				else
+				{
+					node->task();
+				}
+
+				++_freeSize;
+
+				DeleteNode(node);
+			}
+
+			// 与休眠线程的检查构成对称的栅栏, 保证任务入队与休眠计数至少有一方被对方看到
+			void Notify()
+			{
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				if (_sleepSize.load(std::memory_order_relaxed) == 0)
+				{
+					return;
+				}
+
+				{
+					std::unique_lock<std::mutex> lock(_lock);
+				}
+
+				_condition.notify_one();
+			}
+
+			bool HasTask() const
+			{
+				if (_queueSize.load(std::memory_order_relaxed) > 0)
+				{
+					return true;
+				}
+
+				for (auto &iter : _workers)
+				{
+					if (!iter->deque.Empty())
+					{
+						return true;
+					}
+				}
+
+				return false;
+			}
+
+			// 从注入队列批量取出任务, 多余的放入本地队列供其他线程窃取
+			// 有多个通道时每次只取一个, 避免低权重的任务提前进入本地队列
+			Node * Inject(Worker & self)
+			{
+				if (_queueSize.load(std::memory_order_relaxed) == 0)
+				{
+					return nullptr;
+				}
+
+				std::unique_lock<std::mutex> lock(_lock);
+
+				std::size_t size = _queueSize.load(std::memory_order_relaxed);
+
+				if (size == 0)
+				{
+					return nullptr;
+				}
+
+				std::size_t count = _lanes.size() == 1 ? std::min((size + _workers.size() - 1) / _workers.size(), static_cast<std::size_t>(BATCH_COUNT)) : 1;
+
+				Node * node = PopNode();
+
+				for (std::size_t i = 1; i < count; ++i)
+				{
+					self.deque.Push(PopNode());
+				}
+
+				return node;
+			}
+
+			// 从随机位置开始依次尝试窃取其他线程的任务
+			Node * Steal(Worker & self, const std::size_t index)
+			{
+				std::size_t size = _workers.size();
+
+				std::size_t start = self.random() % size;
+
+				for (std::size_t i = 0; i < size; ++i)
+				{
+					std::size_t victim = (start + i) % size;
+
+					Node * node = nullptr;
+
+					if (victim != index && _workers[victim]->deque.Steal(node))
+					{
+						return node;
+					}
+				}
+
+				return nullptr;
+			}
+
+			// 有多个通道时先查看注入队列, 高权重通道的任务不必等本地队列清空
+			Node * Acquire(Worker & self, const std::size_t index)
+			{
+				Node * node = _lanes.size() > 1 ? Inject(self) : nullptr;
+
+				if (node || self.deque.Pop(node))
+				{
+					return node;
+				}
+
+				node = Inject(self);
+
+				return node ? node : Steal(self, index);
+			}
+
+			static void Pause()
+			{
+			#if defined(__SSE2__)
+
+				_mm_pause();
+
+			#endif
+			}
+
+			void StealingLoop(const std::size_t index)
+			{
+				Local().pool  = this;
+				Local().index = index;
+
+				TaskMetrics::Scope scope(_metrics, Local().recorder);
+
+				// 在本线程内创建, 内存按本线程的亲和与内存策略分配
+				_workers[index].reset(new Worker(index));
+
+				_readySize.fetch_add(1, std::memory_order_acq_rel);
+
+				while (_readySize.load(std::memory_order_acquire) < _workers.size())
+				{
+					if (_isStop.load())
+					{
+						Local().pool = nullptr;
+
+						return;
+					}
+
+					std::this_thread::yield();
+				}
+
+				Worker & self = *_workers[index];
+
+				while (true)
+				{
+					Node * node = Acquire(self, index);
+
+					for (std::size_t i = 0; node == nullptr && i < SPIN_COUNT + YIELD_COUNT; ++i)
+					{
+						if (i < SPIN_COUNT)
+						{
+							Pause();
+						}
+						else
+						{
+							std::this_thread::yield();
+						}
+
+						node = Acquire(self, index);
+					}
+
+					if (node)
+					{
+						Run(node);
+
+						continue;
+					}
+
+					{
+						std::unique_lock<std::mutex> lock(_lock);
+
+						_sleepSize.fetch_add(1, std::memory_order_seq_cst);
+
+						std::atomic_thread_fence(std::memory_order_seq_cst);
+
+						_condition.wait
+						(
+							lock,
+
+							[this]
+							{
+								return _isStop.load() || HasTask();
+							}
+						);
+
+						_sleepSize.fetch_sub(1, std::memory_order_relaxed);
+					}
+
+					// 停止后仍然执行完剩余任务, 保证已提交任务的 future 都能就绪
+					if (_isStop.load() && !HasTask())
+					{
+						break;
+					}
+				}
+
+				Local().pool = nullptr;
+			}
+
+		protected:
+			MODE _mode{ MODE::SHARED_QUEUE };
+
+			mutable std::mutex _lock{ };
 
 			std::atomic<bool> _isStop{ };
 			std::atomic<std::size_t> _freeSize{ };
+			std::atomic<std::size_t> _sleepSize{ 0 };
+			std::atomic<std::size_t> _queueSize{ 0 };
+			std::atomic<std::size_t> _readySize{ 0 };
+
+			std::vector<thread::NativeThread> _pool{ };
+
+			bool _isElastic{ false };
+
+			// 以下弹性模式的状态由 _lock 保护, _elasticSize 可无锁读取
+			std::atomic<std::size_t> _elasticSize{ 0 };
+
+			std::size_t _spawnSize{ 0 };
+			std::size_t _retireSize{ 0 };
+
+			SteadyClockTimesPoint _lastResize{ };
+
+			ElasticOption _elastic{ };
+
+			LaunchOption _launchOption{ };
+
+			std::unique_ptr<thread::NativeThread> _supervisor{ };
+
+			std::condition_variable _exitCondition{ };
+			std::condition_variable _superviseCondition{ };
+
+			std::vector<Lane> _lanes{ };
+
+			TaskMetrics _metrics{ };
+
+			mutable std::mutex _timerLock{ };
+
+			std::unique_ptr<TimerQueue> _timer{ };
 
-			std::vector<std::thread> _pool{ };
+			std::vector<std::unique_ptr<Worker>> _workers{ };
 
 			std::condition_variable _condition{ };
 		};
@@ -0,0 +1,300 @@
+#ifndef __TINY_CORE__POOL__TIMER_QUEUE__H__
+#define __TINY_CORE__POOL__TIMER_QUEUE__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 定时任务队列
+ *
+ *  一个定时线程按到期时间维护最小堆, 到期后把任务交给 dispatch (线程池中为 Post), 自身不执行任务
+ *
+ *  周期任务按计划时间累加周期 (下一次 = 上一次的计划时间 + period), 不受执行耗时与唤醒延迟影响, 没有漂移,
+ *  定时线程落后超过一个周期时跳过错过的次数, 不会集中补发; 上一次还在执行时跳过本次, 同一个任务不会并发执行
+ *
+ *  取消只是打标记, 已交出的那一次仍会执行, 堆中的条目在到期时丢弃
+ *
+ */
+
+
+#include <tinyCore/utilities/time.h>
+#include <tinyCore/thread/threadAttribute.h>
+
+
+namespace tinyCore
+{
+	namespace pool
+	{
+		class TimerHandle
+		{
+			friend class TimerQueue;
+
+			struct State
+			{
+				explicit State(std::function<void()> && func) : function(std::move(func))
+				{
+
+				}
+
+				std::function<void()> function;
+
+				// 单次任务交出时也置位
+				std::atomic<bool> isCancel{ false };
+				std::atomic<bool> isRunning{ false };
+			};
+
+		public:
+			TimerHandle() = default;
+
+			// 返回是否由本次调用阻止了后续执行 (单次任务已经交出时返回 false)
+			bool Cancel()
+			{
+				return _state && !_state->isCancel.exchange(true);
+			}
+
+			bool IsActive() const
+			{
+				return _state && !_state->isCancel.load();
+			}
+
+		protected:
+			explicit TimerHandle(std::shared_ptr<State> state) : _state(std::move(state))
+			{
+
+			}
+
+		protected:
+			std::shared_ptr<State> _state{ };
+		};
+
+		class TimerQueue
+		{
+			using State = TimerHandle::State;
+
+			struct Entry
+			{
+				SteadyClockTimesPoint when;
+
+				SteadyClockDuration period;
+
+				// 同一时刻按加入顺序
+				uint64_t sequence;
+
+				std::shared_ptr<State> state;
+			};
+
+			struct Later
+			{
+				bool operator()(const Entry & lhs, const Entry & rhs) const
+				{
+					return lhs.when != rhs.when ? lhs.when > rhs.when : lhs.sequence > rhs.sequence;
+				}
+			};
+
+		public:
+			using Dispatch = std::function<void(std::function<void()>)>;
+
+			explicit TimerQueue(Dispatch dispatch, const thread::ThreadAttribute & attribute = thread::ThreadAttribute()) :
+				_dispatch(std::move(dispatch)),
+				_thread(attribute, [this]() { Loop(); })
+			{
+
+			}
+
+			~TimerQueue()
+			{
+				Stop();
+			}
+
+			TimerQueue(const TimerQueue &) = delete;
+			TimerQueue & operator=(const TimerQueue &) = delete;
+
+			// period 为0表示单次任务
+			TimerHandle Add(const SteadyClockTimesPoint & when, const SteadyClockDuration & period, std::function<void()> func)
+			{
+				TINY_THROW_EXCEPTION_IF(period < SteadyClockDuration::zero(), debug::ValueError, "timer period must not be negative")
+
+				auto state = std::make_shared<State>(std::move(func));
+
+				bool isEarliest = false;
+
+				{
+					std::lock_guard<std::mutex> lock(_lock);
+
+					TINY_THROW_EXCEPTION_IF(_isStop, debug::ThreadError, "add on TimerQueue is stopped")
+
+					isEarliest = _heap.empty() || when < _heap.front().when;
+
+					_heap.push_back(Entry{ when, period, _sequence++, state });
+
+					std::push_heap(_heap.begin(), _heap.end(), Later());
+				}
+
+				// 新的最早到期时间才需要唤醒定时线程重新计算等待时长
+				if (isEarliest)
+				{
+					_condition.notify_one();
+				}
+
+				return TimerHandle(std::move(state));
+			}
+
+			// 包括已取消但尚未到期的条目
+			std::size_t Size() const
+			{
+				std::lock_guard<std::mutex> lock(_lock);
+
+				return _heap.size();
+			}
+
+			// 丢弃尚未到期的任务, 已交出的不受影响
+			void Stop()
+			{
+				{
+					std::lock_guard<std::mutex> lock(_lock);
+
+					_isStop = true;
+				}
+
+				_condition.notify_one();
+
+				_thread.Join();
+
+				_heap.clear();
+			}
+
+		protected:
+			void Loop()
+			{
+				std::unique_lock<std::mutex> lock(_lock);
+
+				while (!_isStop)
+				{
+					if (_heap.empty())
+					{
+						_condition.wait(lock);
+
+						continue;
+					}
+
+					auto now = TINY_TIME_STEADY_POINT();
+
+					// 等待期间 Add 可能使堆重新分配, 不能传引用
+					SteadyClockTimesPoint when = _heap.front().when;
+
+					if (when > now)
+					{
+						_condition.wait_until(lock, when);
+
+						continue;
+					}
+
+					std::pop_heap(_heap.begin(), _heap.end(), Later());
+
+					Entry entry = std::move(_heap.back());
+
+					_heap.pop_back();
+
+					State & state = *entry.state;
+
+					if (entry.period == SteadyClockDuration::zero())
+					{
+						// 与 Cancel 竞争, 只有一方成功
+						if (state.isCancel.exchange(true))
+						{
+							continue;
+						}
+					}
+					else
+					{
+						if (state.isCancel.load())
+						{
+							continue;
+						}
+
+						// 从计划时间累加, 跳过已经错过的次数
+						auto next = entry.when + entry.period;
+
+						if (next <= now)
+						{
+							next += entry.period * ((now - next) / entry.period + 1);
+						}
+
+						_heap.push_back(Entry{ next, entry.period, _sequence++, entry.state });
+
+						std::push_heap(_heap.begin(), _heap.end(), Later());
+
+						// 上一次还没有执行完
+						if (state.isRunning.exchange(true))
+						{
+							continue;
+						}
+					}
+
+					lock.unlock();
+
+					Fire(entry.state, entry.period != SteadyClockDuration::zero());
+
+					lock.lock();
+				}
+			}
+
+			void Fire(const std::shared_ptr<State> & state, const bool isPeriodic)
+			{
+				try
+				{
+					_dispatch
+					(
+						[state, isPeriodic]()
+						{
+							if (!isPeriodic)
+							{
+								state->function();
+
+								return;
+							}
+
+							// 抛出异常时也要允许下一次执行
+							struct Reset
+							{
+								~Reset()
+								{
+									state.isRunning.store(false);
+								}
+
+								State & state;
+							} reset{ *state };
+
+							state->function();
+						}
+					);
+				}
+				catch (...)
+				{
+					// dispatch 失败 (如线程池已停止) 时放弃本次
+					state->isRunning.store(false);
+				}
+			}
+
+		protected:
+			bool _isStop{ false };
+
+			uint64_t _sequence{ 0 };
+
+			mutable std::mutex _lock{ };
+
+			std::condition_variable _condition{ };
+
+			std::vector<Entry> _heap{ };
+
+			Dispatch _dispatch;
+
+			// 最后构造, 线程启动时其他成员均已就绪
+			thread::NativeThread _thread;
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__POOL__TIMER_QUEUE__H__
@@ -0,0 +1,230 @@
+#ifndef __TINY_CORE__SYSTEM__MAPPED_FILE__H__
+#define __TINY_CORE__SYSTEM__MAPPED_FILE__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 内存映射文件
+ *
+ *  只读映射, 私有可写映射 (写时复制, 修改不会写回文件) 或共享可写映射 (修改写回文件), 打开时不读取内容, 按需缺页加载
+ *
+ *  写文件时先写入临时文件再重命名, 保证读取方不会看到写了一半的文件
+ *
+ */
+
+
+#include <tinyCore/debug/trace.h>
+
+
+namespace tinyCore
+{
+	namespace system
+	{
+		class MappedFile
+		{
+		public:
+			enum class MODE : uint8_t
+			{
+				READ_ONLY,
+				COPY_ON_WRITE,
+				READ_WRITE,
+			};
+
+		public:
+			MappedFile() = default;
+
+			explicit MappedFile(const std::string & path, MODE mode = MODE::READ_ONLY)
+			{
+				Open(path, mode);
+			}
+
+			MappedFile(MappedFile && rhs) noexcept : _data(rhs._data), _size(rhs._size)
+			{
+				rhs._data = nullptr;
+				rhs._size = 0;
+			}
+
+			MappedFile & operator=(MappedFile && rhs) noexcept
+			{
+				if (this != &rhs)
+				{
+					Close();
+
+					std::swap(_data, rhs._data);
+					std::swap(_size, rhs._size);
+				}
+
+				return *this;
+			}
+
+			~MappedFile()
+			{
+				Close();
+			}
+
+			MappedFile(const MappedFile &) = delete;
+			MappedFile & operator=(const MappedFile &) = delete;
+
+			void Open(const std::string & path, MODE mode = MODE::READ_ONLY)
+			{
+				Close();
+
+				int fd = ::open(path.c_str(), (mode == MODE::READ_WRITE ? O_RDWR : O_RDONLY) | O_CLOEXEC);
+
+				TINY_THROW_EXCEPTION_IF(fd == -1, debug::IOError, TINY_STR_FORMAT("open {} failed: {}", path, strerror(errno)))
+
+				struct stat info{ };
+
+				if (fstat(fd, &info) == -1 || info.st_size == 0)
+				{
+					int error = errno;
+
+					::close(fd);
+
+					TINY_THROW_EXCEPTION(debug::IOError, TINY_STR_FORMAT("stat {} failed or file is empty: {}", path, strerror(error)));
+				}
+
+				Map(fd, path, static_cast<std::size_t>(info.st_size), mode);
+			}
+
+			// 创建 (或截断) 指定大小的文件并以共享可写方式映射
+			void Create(const std::string & path, const std::size_t size)
+			{
+				Close();
+
+				int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+				TINY_THROW_EXCEPTION_IF(fd == -1, debug::IOError, TINY_STR_FORMAT("create {} failed: {}", path, strerror(errno)))
+
+				if (ftruncate(fd, static_cast<off_t>(size)) == -1)
+				{
+					int error = errno;
+
+					::close(fd);
+
+					TINY_THROW_EXCEPTION(debug::IOError, TINY_STR_FORMAT("truncate {} failed: {}", path, strerror(error)));
+				}
+
+				Map(fd, path, size, MODE::READ_WRITE);
+			}
+
+			// 共享映射的修改写回文件, async为true时只发起写回
+			void Sync(const bool async = true)
+			{
+				if (_data)
+				{
+					msync(_data, _size, async ? MS_ASYNC : MS_SYNC);
+				}
+			}
+
+			void Close()
+			{
+				if (_data)
+				{
+					munmap(_data, _size);
+
+					_data = nullptr;
+					_size = 0;
+				}
+			}
+
+			bool IsOpen() const
+			{
+				return _data != nullptr;
+			}
+
+			Byte * Data()
+			{
+				return _data;
+			}
+
+			const Byte * Data() const
+			{
+				return _data;
+			}
+
+			std::size_t Size() const
+			{
+				return _size;
+			}
+
+			// 依次写入多段数据
+			static void Write(const std::string & path, const std::vector<std::pair<const void *, std::size_t>> & parts)
+			{
+				std::string temp = path + ".tmp";
+
+				int fd = ::open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+				TINY_THROW_EXCEPTION_IF(fd == -1, debug::IOError, TINY_STR_FORMAT("open {} failed: {}", temp, strerror(errno)))
+
+				for (auto &iter : parts)
+				{
+					auto * data = static_cast<const Byte *>(iter.first);
+
+					std::size_t remain = iter.second;
+
+					while (remain > 0)
+					{
+						ssize_t len = ::write(fd, data, remain);
+
+						if (len == -1 && errno == EINTR)
+						{
+							continue;
+						}
+
+						if (len <= 0)
+						{
+							int error = errno;
+
+							::close(fd);
+
+							::unlink(temp.c_str());
+
+							TINY_THROW_EXCEPTION(debug::IOError, TINY_STR_FORMAT("write {} failed: {}", temp, strerror(error)));
+						}
+
+						data   += len;
+						remain -= static_cast<std::size_t>(len);
+					}
+				}
+
+				if (fdatasync(fd) == -1 || ::close(fd) == -1 || ::rename(temp.c_str(), path.c_str()) == -1)
+				{
+					int error = errno;
+
+					::unlink(temp.c_str());
+
+					TINY_THROW_EXCEPTION(debug::IOError, TINY_STR_FORMAT("save {} failed: {}", path, strerror(error)));
+				}
+			}
+
+		protected:
+			void Map(const int fd, const std::string & path, const std::size_t size, const MODE mode)
+			{
+				int protect = mode == MODE::READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE;
+
+				void * data = mmap(nullptr, size, protect, mode == MODE::READ_WRITE ? MAP_SHARED : MAP_PRIVATE, fd, 0);
+
+				int error = errno;
+
+				// 映射会保持文件引用
+				::close(fd);
+
+				TINY_THROW_EXCEPTION_IF(data == MAP_FAILED, debug::IOError, TINY_STR_FORMAT("mmap {} failed: {}", path, strerror(error)))
+
+				_data = static_cast<Byte *>(data);
+				_size = size;
+			}
+
+		protected:
+			Byte * _data{ nullptr };
+
+			std::size_t _size{ 0 };
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__SYSTEM__MAPPED_FILE__H__
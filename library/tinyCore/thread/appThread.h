@@ -8,10 +8,12 @@
  *
  *  说明: 应用线程
  *
+ *  CreateThread 可以传入线程属性 (名字, CPU 亲和, NUMA 节点, 栈大小, 调度策略)
+ *
  */
 
 
-#include <tinyCore/debug/trace.h>
+#include <tinyCore/thread/threadAttribute.h>
 
 
 namespace tinyCore
@@ -42,7 +44,7 @@ namespace tinyCore
 				return _threadStatus == THREAD_STATUS::START;
 			}
 
-			bool CreateThread()
+			bool CreateThread(const ThreadAttribute & attribute = ThreadAttribute())
 			{
 				if (IsStart())
 				{
@@ -51,11 +53,15 @@ namespace tinyCore
 
 				_threadStatus = THREAD_STATUS::START;
 
-				if (pthread_create(&_id, nullptr, ThreadHandle, (void*)this) != 0)
+				_attribute = attribute;
+
+				int code = _attribute.Create(_id, ThreadHandle, (void*)this);
+
+				if (code != 0)
 				{
 					_threadStatus = THREAD_STATUS::UNINITIALIZED;
 
-					TINY_THROW_EXCEPTION(debug::ThreadError, TINY_STR_TO_STRING("pthread_create() : ", strerror(errno)));
+					TINY_THROW_EXCEPTION(debug::ThreadError, TINY_STR_TO_STRING("pthread_create() : ", strerror(code)));
 
 					return false;
 				}
@@ -87,6 +93,8 @@ namespace tinyCore
 
 				auto * handlerPtr = (AppThreadC *)handler;
 
+				handlerPtr->_attribute.Apply();
+
 				handlerPtr->ThreadProcess();
 
 				return handlerPtr;
@@ -95,6 +103,8 @@ namespace tinyCore
 		protected:
 			pthread_t _id{ 0 };
 
+			ThreadAttribute _attribute{ };
+
 			THREAD_STATUS _threadStatus{ THREAD_STATUS::UNINITIALIZED };
 		};
 	}
@@ -0,0 +1,267 @@
+#ifndef __TINY_CORE__THREAD__THREAD_ATTRIBUTE__H__
+#define __TINY_CORE__THREAD__THREAD_ATTRIBUTE__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: 线程属性与原生线程
+ *
+ *  栈大小, 调度策略与优先级, CPU 亲和在创建时通过 pthread_attr 设置,
+ *  线程名与 NUMA 内存策略在新线程开始执行时设置 (只能作用于线程自身)
+ *
+ *  绑定节点时 CPU 亲和为节点的全部 CPU (除非另外指定), 内存优先从该节点分配,
+ *  线程此后首次访问的页面落在本节点, 通过系统调用设置, 不依赖 libnuma
+ *
+ *  亲和, 线程名与内存策略只在 Linux 下生效
+ *
+ */
+
+
+#include <tinyCore/thread/topology.h>
+
+#if TINY_PLATFORM == TINY_PLATFORM_UNIX
+#
+#  include <sched.h>
+#  include <unistd.h>
+#  include <sys/syscall.h>
+#
+#endif
+
+
+namespace tinyCore
+{
+	namespace thread
+	{
+		struct ThreadAttribute
+		{
+			static const int INHERIT = -1;
+
+			// 创建线程, 返回 pthread_create 的错误码
+			int Create(pthread_t & id, void * (* routine)(void *), void * argument) const
+			{
+				pthread_attr_t attribute;
+
+				pthread_attr_init(&attribute);
+
+				int code = Fill(attribute);
+
+				if (code == 0)
+				{
+					code = pthread_create(&id, &attribute, routine, argument);
+				}
+
+				pthread_attr_destroy(&attribute);
+
+				return code;
+			}
+
+			// 在新线程内调用
+			void Apply() const
+			{
+			#if TINY_PLATFORM == TINY_PLATFORM_UNIX
+
+				if (!name.empty())
+				{
+					// 线程名最长15个字符
+					pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+				}
+
+				if (node != INHERIT)
+				{
+					// MPOL_PREFERRED, 节点内存不足时仍可从其他节点分配; 内核不支持 NUMA 时忽略
+					unsigned long mask[16] = { };
+
+					if (static_cast<std::size_t>(node) < sizeof(mask) * 8)
+					{
+						mask[node / (sizeof(unsigned long) * 8)] |= 1UL << (node % (sizeof(unsigned long) * 8));
+
+						syscall(SYS_set_mempolicy, 1, mask, sizeof(mask) * 8 + 1);
+					}
+				}
+
+			#endif
+			}
+
+			std::string name{ };
+
+			// 为空且绑定节点时使用节点的全部 CPU
+			std::vector<std::size_t> cpus{ };
+
+			int node{ INHERIT };
+
+			// 0为系统默认
+			std::size_t stackSize{ 0 };
+
+			// SCHED_OTHER / SCHED_FIFO / SCHED_RR / SCHED_BATCH / SCHED_IDLE, 实时策略需要权限
+			int policy{ INHERIT };
+			int priority{ 0 };
+
+		protected:
+			int Fill(pthread_attr_t & attribute) const
+			{
+				int code = 0;
+
+				if (stackSize > 0)
+				{
+					code = pthread_attr_setstacksize(&attribute, stackSize);
+
+					if (code != 0)
+					{
+						return code;
+					}
+				}
+
+				if (policy != INHERIT)
+				{
+					sched_param param{ };
+
+					param.sched_priority = priority;
+
+					code = pthread_attr_setinheritsched(&attribute, PTHREAD_EXPLICIT_SCHED);
+
+					if (code == 0)
+					{
+						code = pthread_attr_setschedpolicy(&attribute, policy);
+					}
+
+					if (code == 0)
+					{
+						code = pthread_attr_setschedparam(&attribute, &param);
+					}
+
+					if (code != 0)
+					{
+						return code;
+					}
+				}
+
+			#if TINY_PLATFORM == TINY_PLATFORM_UNIX
+
+				auto list = cpus.empty() && node != INHERIT ? Topology::Cpus(static_cast<std::size_t>(node)) : cpus;
+
+				if (!list.empty())
+				{
+					cpu_set_t set;
+
+					CPU_ZERO(&set);
+
+					for (auto cpu : list)
+					{
+						if (cpu < CPU_SETSIZE)
+						{
+							CPU_SET(cpu, &set);
+						}
+					}
+
+					code = pthread_attr_setaffinity_np(&attribute, sizeof(set), &set);
+				}
+
+			#endif
+
+				return code;
+			}
+		};
+
+		// 按属性创建的线程, 析构时等待线程结束
+		class NativeThread
+		{
+			struct Context
+			{
+				ThreadAttribute attribute;
+
+				std::function<void()> function;
+			};
+
+		public:
+			NativeThread(const ThreadAttribute & attribute, std::function<void()> function)
+			{
+				auto * context = new Context{ attribute, std::move(function) };
+
+				int code = attribute.Create(_id, Routine, context);
+
+				if (code != 0)
+				{
+					delete context;
+
+					TINY_THROW_EXCEPTION(debug::ThreadError, TINY_STR_TO_STRING("pthread_create() : ", strerror(code)));
+				}
+
+				_isJoinable = true;
+			}
+
+			NativeThread(NativeThread && rhs) noexcept : _id(rhs._id), _isJoinable(std::exchange(rhs._isJoinable, false))
+			{
+
+			}
+
+			NativeThread & operator=(NativeThread && rhs) noexcept
+			{
+				if (this != &rhs)
+				{
+					Join();
+
+					_id = rhs._id;
+
+					_isJoinable = std::exchange(rhs._isJoinable, false);
+				}
+
+				return *this;
+			}
+
+			~NativeThread()
+			{
+				Join();
+			}
+
+			NativeThread(const NativeThread &) = delete;
+			NativeThread & operator=(const NativeThread &) = delete;
+
+			bool Joinable() const
+			{
+				return _isJoinable;
+			}
+
+			void Join()
+			{
+				if (_isJoinable)
+				{
+					pthread_join(_id, nullptr);
+
+					_isJoinable = false;
+				}
+			}
+
+			void Detach()
+			{
+				if (_isJoinable)
+				{
+					pthread_detach(_id);
+
+					_isJoinable = false;
+				}
+			}
+
+		protected:
+			static void * Routine(void * argument)
+			{
+				std::unique_ptr<Context> context(static_cast<Context *>(argument));
+
+				context->attribute.Apply();
+
+				context->function();
+
+				return nullptr;
+			}
+
+		protected:
+			pthread_t _id{ };
+
+			bool _isJoinable{ false };
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__THREAD__THREAD_ATTRIBUTE__H__
@@ -0,0 +1,121 @@
+#ifndef __TINY_CORE__THREAD__TOPOLOGY__H__
+#define __TINY_CORE__THREAD__TOPOLOGY__H__
+
+
+/**
+ *
+ *  作者: hm
+ *
+ *  说明: CPU 与 NUMA 节点拓扑
+ *
+ *  从 /sys/devices/system/node 读取节点及其 CPU 列表, 不依赖 libnuma,
+ *  读取失败 (非 Linux 或没有挂载 sysfs) 时视为只有0号节点, 包含全部 CPU
+ *
+ */
+
+
+#include <tinyCore/debug/trace.h>
+
+
+namespace tinyCore
+{
+	namespace thread
+	{
+		class Topology
+		{
+		public:
+			// 在线的 NUMA 节点编号
+			static std::vector<std::size_t> Nodes()
+			{
+				auto nodes = ParseList(ReadLine("/sys/devices/system/node/online"));
+
+				if (nodes.empty())
+				{
+					nodes.push_back(0);
+				}
+
+				return nodes;
+			}
+
+			// 节点包含的 CPU 编号
+			static std::vector<std::size_t> Cpus(const std::size_t node)
+			{
+				auto cpus = ParseList(ReadLine(TINY_STR_FORMAT("/sys/devices/system/node/node{}/cpulist", node)));
+
+				if (cpus.empty() && node == 0)
+				{
+					for (std::size_t i = 0; i < CpuCount(); ++i)
+					{
+						cpus.push_back(i);
+					}
+				}
+
+				return cpus;
+			}
+
+			static std::size_t CpuCount()
+			{
+				return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+			}
+
+			// 解析 "0-3,8,10-11" 形式的列表
+			static std::vector<std::size_t> ParseList(const std::string & value)
+			{
+				std::vector<std::size_t> list;
+
+				std::size_t position = 0;
+
+				while (position < value.size())
+				{
+					std::size_t end = value.find(',', position);
+
+					if (end == std::string::npos)
+					{
+						end = value.size();
+					}
+
+					std::string range = value.substr(position, end - position);
+
+					std::size_t dash = range.find('-');
+
+					try
+					{
+						std::size_t first = std::stoul(range.substr(0, dash));
+						std::size_t last  = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+
+						for (std::size_t i = first; i <= last; ++i)
+						{
+							list.push_back(i);
+						}
+					}
+					catch (...)
+					{
+
+					}
+
+					position = end + 1;
+				}
+
+				return list;
+			}
+
+		protected:
+			static std::string ReadLine(const std::string & path)
+			{
+				std::string line;
+
+				std::ifstream file(path);
+
+				if (file)
+				{
+					std::getline(file, line);
+				}
+
+				return line;
+			}
+		};
+	}
+}
+
+
+#endif // __TINY_CORE__THREAD__TOPOLOGY__H__
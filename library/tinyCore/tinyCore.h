@@ -19,8 +19,28 @@
 
 // container
 #include <tinyCore/container/queue.h>
+#include <tinyCore/container/cache.h>
 #include <tinyCore/container/message.h>
 #include <tinyCore/container/memcached.h>
+#include <tinyCore/container/spillQueue.h>
+#include <tinyCore/container/ringBuffer.h>
+#include <tinyCore/container/timerWheel.h>
+#include <tinyCore/container/bloomFilter.h>
+#include <tinyCore/container/chainBuffer.h>
+#include <tinyCore/container/cuckooFilter.h>
+#include <tinyCore/container/memcachedPool.h>
+#include <tinyCore/container/sharedMessage.h>
+#include <tinyCore/container/memcachedServer.h>
+#include <tinyCore/container/workStealingDeque.h>
+#include <tinyCore/container/concurrentHashMap.h>
+#include <tinyCore/container/concurrentSkipList.h>
+#include <tinyCore/container/memcachedNearCache.h>
+
+// coroutine
+#include <tinyCore/coroutine/task.h>
+#include <tinyCore/coroutine/timer.h>
+#include <tinyCore/coroutine/asyncEvent.h>
+#include <tinyCore/coroutine/asyncMutex.h>
 
 // crypto
 #include <tinyCore/crypto/url.h>
@@ -47,6 +67,7 @@
 
 // lock
 #include <tinyCore/lock/mutex.h>
+#include <tinyCore/lock/epoch.h>
 #include <tinyCore/lock/atomic.h>
 
 // log
@@ -59,8 +80,15 @@
 #include <tinyCore/log/formatter.h>
 
 // pool
+#include <tinyCore/pool/future.h>
+#include <tinyCore/pool/metrics.h>
 #include <tinyCore/pool/appPool.h>
+#include <tinyCore/pool/parallel.h>
+#include <tinyCore/pool/blockPool.h>
+#include <tinyCore/pool/taskGraph.h>
 #include <tinyCore/pool/threadPool.h>
+#include <tinyCore/pool/timerQueue.h>
+#include <tinyCore/pool/inlineTask.h>
 #include <tinyCore/pool/callBackPool.h>
 
 //sql
@@ -71,10 +99,13 @@
 #include <tinyCore/system/signal.h>
 #include <tinyCore/system/process.h>
 #include <tinyCore/system/fileSystem.h>
+#include <tinyCore/system/mappedFile.h>
 #include <tinyCore/system/networkCard.h>
 
 // thread
+#include <tinyCore/thread/topology.h>
 #include <tinyCore/thread/appThread.h>
+#include <tinyCore/thread/threadAttribute.h>
 
 // utilities
 #include <tinyCore/utilities/ip.h>
@@ -369,6 +369,12 @@ namespace tinyCore
 			{
 				return std::chrono::system_clock::from_time_t(time);
 			}
+
+			// 单调时钟, 用于计时与定时器, 不受系统时间调整影响
+			static SteadyClockTimesPoint SteadyTimePoint()
+			{
+				return SteadyClock::now();
+			}
 		};
 	}
 }
@@ -385,6 +391,7 @@ namespace tinyCore
 
 #define TINY_TIME_ZONE() tinyCore::utilities::Time::TimeZone()
 #define TINY_TIME_POINT() tinyCore::utilities::Time::TimePoint()
+#define TINY_TIME_STEADY_POINT() tinyCore::utilities::Time::SteadyTimePoint()
 #define TINY_TIME_NEXT_DAY_TIME() tinyCore::utilities::Time::NextDayTime()
 #define TINY_TIME_CURRENT_DAY_TIME() tinyCore::utilities::Time::CurrentDayTime()
 